@@ -0,0 +1,1124 @@
+/* Benchmarks do PSO (medição de desempenho, sem menus)
+
+   uso:
+     bench small [solves] [steps]   latência p50/p99 de problemas pequenos
+     bench batch [problemas] [passos]
+                                    muitos problemas pequenos: pso_batch_solve x
+                                    um pso_solve por problema
+     bench gbest [segundos] [dim]   estresse do melhor compartilhado (1..64 threads)
+     bench broker [solvers] [lote]  vazão do modelo: chamadas diretas x broker
+     bench async [latência_us]      objetivo de E/S: threads bloqueantes x laço assíncrono
+     bench dataset [linhas]         regressão em arquivo mmap: dados completos x mini-lote
+     bench portfolio [threads] [sementes]
+                                    tempo até o alvo: cada configuração x portfólio
+     bench perf [passos]            tempo, IPC e falhas de cache por fase do passo
+                                    em função de dim e do tamanho do enxame
+     bench latency [passos]         histograma de latência de um objetivo com
+                                    custo que depende da região
+     bench numa [passos] [threads]  escala com threads livres x fixadas por nó
+                                    NUMA com o enxame particionado
+     bench subproc [timeout_ms]     filhos de pso_subproc: timeout na primeira
+                                    avaliação e comando que sai sem responder
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+
+#include "pso.h"
+#include "pso_small.h"
+#include "pso_batch.h"
+#include "pso_shared.h"
+#include "pso_broker.h"
+#include "pso_async.h"
+#include "pso_dataset.h"
+#include "pso_portfolio.h"
+#include "pso_funcs.h"
+#include "pso_perf.h"
+#include "pso_latency.h"
+#include "pso_numa.h"
+#include "pso_subproc.h"
+#include "pso_rng.h"
+
+
+// ============================
+//        UTILITÁRIOS
+// ============================
+
+// relógio monotônico em nanossegundos
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// percentil q (0..1) de um vetor já ordenado
+static double percentile(const double *v, int n, double q) {
+    int k = (int)(q * (n - 1) + 0.5);
+    return v[k];
+}
+
+static double sphere(double *x, int dim, void *p) {
+    (void)p;
+    double s = 0.0;
+    for (int i=0; i<dim; i++) s += x[i]*x[i];
+    return s;
+}
+
+
+// ============================
+//   LATÊNCIA: PROBLEMAS PEQUENOS
+// ============================
+
+typedef int (*solve_fun_t)(pso_settings_t *settings, pso_result_t *res);
+
+static int solve_small(pso_settings_t *settings, pso_result_t *res) {
+    return pso_solve_small(sphere, NULL, res, settings);
+}
+
+static int solve_full(pso_settings_t *settings, pso_result_t *res) {
+    pso_solve(sphere, NULL, res, settings);
+    return 0;
+}
+
+static void latency_run(const char *name, solve_fun_t solve,
+                        int dim, int size, int steps, int solves) {
+    pso_settings_t *settings = pso_settings_new(dim, -5.12, 5.12);
+    double *lat = (double *)malloc(solves * sizeof(double));
+    double gbest[PSO_SMALL_MAX_DIM];
+    pso_result_t res;
+    res.gbest = gbest;
+
+    settings->size = size;
+    settings->steps = steps;
+    settings->print_every = 0;
+
+    for (int k=0; k<solves; k++) {
+        settings->seed = k + 1;
+        double t0 = now_ns();
+        solve(settings, &res);
+        lat[k] = (now_ns() - t0) / 1e3; // us
+    }
+
+    qsort(lat, solves, sizeof(double), cmp_double);
+    printf("%-12s dim=%d size=%-3d steps=%-4d p50=%9.2f us  p99=%9.2f us  max=%9.2f us\n",
+           name, dim, size, steps,
+           percentile(lat, solves, 0.50), percentile(lat, solves, 0.99),
+           lat[solves-1]);
+
+    free(lat);
+    pso_settings_free(settings);
+}
+
+static int bench_small(int argc, char **argv) {
+    int solves = argc > 0 ? atoi(argv[0]) : 10000;
+    int steps  = argc > 1 ? atoi(argv[1]) : 100;
+    const int dims[] = { 2, 4, 8 };
+
+    for (unsigned k=0; k<sizeof(dims)/sizeof(dims[0]); k++) {
+        int size = pso_calc_swarm_size(dims[k]);
+        latency_run("pso_solve_small", solve_small, dims[k], size, steps, solves);
+        latency_run("pso_solve", solve_full, dims[k], size, steps, solves);
+    }
+    return 0;
+}
+
+
+// ============================
+//   LOTE: MUITOS PROBLEMAS PEQUENOS
+// ============================
+
+// Esfera deslocada: o problema p tem o mínimo (erro 0) em shift[p*dim..]
+static double *batch_shift;
+
+static double shifted_sphere(double *x, int dim, void *p) {
+    const double *c = (const double *)p;
+    double s = 0.0;
+    for (int d=0; d<dim; d++) s += (x[d] - c[d]) * (x[d] - c[d]);
+    return s;
+}
+
+// mesma função no layout de pso_batch (lane mais interna)
+static void shifted_sphere_lanes(const double *x, int dim, int size, int nlanes,
+                                 int first, double *fit, void *p)
+{
+    (void)p;
+    for (int j=0; j<size; j++) {
+        double *f = fit + j * nlanes;
+        for (int l=0; l<nlanes; l++) f[l] = 0.0;
+        for (int d=0; d<dim; d++) {
+            const double *xd = x + (j * dim + d) * nlanes;
+            for (int l=0; l<nlanes; l++) {
+                double v = xd[l] - batch_shift[(first + l) * dim + d];
+                f[l] += v * v;
+            }
+        }
+    }
+}
+
+static pso_settings_t *batch_settings(int dim, int steps) {
+    pso_settings_t *settings = pso_settings_new(dim, -5.0, 5.0);
+    settings->size = 12;
+    settings->steps = steps;
+    settings->goal = 1e-12;
+    settings->seed = 1;
+    settings->print_every = 0;
+    settings->nhood_strategy = PSO_NHOOD_RING;
+    return settings;
+}
+
+// maior distância (norma do máximo) entre a posição achada e o mínimo
+static double batch_dist(const double *x, const double *c, int dim) {
+    double m = 0.0;
+    for (int d=0; d<dim; d++) if (fabs(x[d] - c[d]) > m) m = fabs(x[d] - c[d]);
+    return m;
+}
+
+static int bench_batch(int argc, char **argv) {
+    int nprob = argc > 0 ? atoi(argv[0]) : 100000;
+    int steps = argc > 1 ? atoi(argv[1]) : 200;
+    const int dim = 4;
+    const double tol = 1e-3; // distância máxima ao mínimo para "resolvido"
+    pso_settings_t *settings = batch_settings(dim, steps);
+    pso_batch_result_t br;
+    pso_result_t res;
+    double t_batch, t_loop, *e_loop;
+    int ok_batch = 0, ok_loop = 0, agree;
+    uint32_t h = 12345u;
+
+    if (nprob < 1) nprob = 1;
+    batch_shift = (double *)malloc((size_t)nprob * dim * sizeof(double));
+    br.error = (double *)malloc(nprob * sizeof(double));
+    br.gbest = (double *)malloc((size_t)nprob * dim * sizeof(double));
+    res.gbest = (double *)malloc(dim * sizeof(double));
+    e_loop = (double *)malloc(nprob * sizeof(double));
+    if (batch_shift == NULL || br.error == NULL || br.gbest == NULL ||
+        res.gbest == NULL || e_loop == NULL)
+        return 1;
+    for (long k=0; k<(long)nprob * dim; k++) {
+        h ^= h << 13; h ^= h >> 17; h ^= h << 5;
+        batch_shift[k] = -4.0 + 8.0 * (h >> 8) / 16777216.0;
+    }
+
+    printf("%d esferas deslocadas, dim %d, 12 partículas, anel, até %d passos\n",
+           nprob, dim, steps);
+
+    t_batch = now_ns();
+    pso_batch_solve(shifted_sphere_lanes, NULL, nprob, &br, settings);
+    t_batch = (now_ns() - t_batch) / 1e9;
+
+    t_loop = now_ns();
+    for (int p=0; p<nprob; p++) {
+        const double *c = batch_shift + (size_t)p * dim;
+
+        settings->seed = p + 1;
+        pso_solve(shifted_sphere, (void *)c, &res, settings);
+        e_loop[p] = res.error;
+        ok_loop += batch_dist(res.gbest, c, dim) <= tol;
+    }
+    t_loop = (now_ns() - t_loop) / 1e9;
+
+    for (int p=0; p<nprob; p++)
+        ok_batch += batch_dist(br.gbest + (size_t)p * dim, batch_shift + (size_t)p * dim,
+                               dim) <= tol;
+
+    // Os sorteios são outros (um gerador por lane), então os erros não
+    // são iguais bit a bit; o que deve bater é a qualidade: a mesma fração
+    // de problemas resolvidos (alguns enxames estagnam nos dois) e a
+    // mesma distribuição do erro final (pso_batch_solve segue até todo o
+    // bloco atingir o goal, então a mediana dele fica abaixo do goal).
+    qsort(br.error, nprob, sizeof(double), cmp_double);
+    qsort(e_loop, nprob, sizeof(double), cmp_double);
+    printf("%-15s %8.3f s  erro p50 %.1e p99 %.1e  resolvidos %d/%d\n",
+           "pso_batch_solve", t_batch, percentile(br.error, nprob, 0.50),
+           percentile(br.error, nprob, 0.99), ok_batch, nprob);
+    printf("%-15s %8.3f s  erro p50 %.1e p99 %.1e  resolvidos %d/%d\n",
+           "pso_solve", t_loop, percentile(e_loop, nprob, 0.50),
+           percentile(e_loop, nprob, 0.99), ok_loop, nprob);
+    agree = ok_batch >= nprob - nprob / 100 && ok_loop >= nprob - nprob / 100 &&
+            abs(ok_batch - ok_loop) <= 1 + nprob / 1000;
+    printf("ganho %.1fx; %s\n", t_loop / t_batch,
+           agree ? "resultados conferem" : "RESULTADOS DIFERENTES");
+
+    free(batch_shift);
+    free(br.error);
+    free(br.gbest);
+    free(res.gbest);
+    free(e_loop);
+    pso_settings_free(settings);
+    return agree ? 0 : 1;
+}
+
+
+// ============================
+//  ESTRESSE: MELHOR COMPARTILHADO
+// ============================
+
+// Implementação de referência com mutex (para comparação)
+typedef struct {
+    pthread_mutex_t lock;
+    double error;
+    double *pos;
+    int dim;
+} mutex_best_t;
+
+static int mutex_offer(void *cell, double error, const double *pos) {
+    mutex_best_t *m = (mutex_best_t *)cell;
+    int ok = 0;
+    pthread_mutex_lock(&m->lock);
+    if (error < m->error) {
+        m->error = error;
+        memcpy(m->pos, pos, sizeof(double) * m->dim);
+        ok = 1;
+    }
+    pthread_mutex_unlock(&m->lock);
+    return ok;
+}
+
+static double mutex_snapshot(void *cell, double *pos) {
+    mutex_best_t *m = (mutex_best_t *)cell;
+    pthread_mutex_lock(&m->lock);
+    double e = m->error;
+    memcpy(pos, m->pos, sizeof(double) * m->dim);
+    pthread_mutex_unlock(&m->lock);
+    return e;
+}
+
+static int lockfree_offer(void *cell, double error, const double *pos) {
+    return pso_shared_best_offer((pso_shared_best_t *)cell, error, pos);
+}
+
+static double lockfree_snapshot(void *cell, double *pos) {
+    return pso_shared_best_snapshot((pso_shared_best_t *)cell, pos);
+}
+
+typedef struct {
+    int (*offer)(void *, double, const double *);
+    double (*snapshot)(void *, double *);
+    void *cell;
+    int dim;
+    int tid, nthreads;
+    int write_heavy;         // 1 = toda operação tenta melhorar
+    atomic_int *stop;
+    long ops;
+    long inconsistent;       // snapshots com vetor != erro
+} stress_arg_t;
+
+static void *stress_thread(void *p) {
+    stress_arg_t *a = (stress_arg_t *)p;
+    double *x = (double *)malloc(sizeof(double) * a->dim);
+    uint64_t r = 0x9E3779B97F4A7C15ULL * (a->tid + 1);
+    long k = 0;
+
+    while (!atomic_load_explicit(a->stop, memory_order_relaxed)) {
+        r ^= r << 13; r ^= r >> 7; r ^= r << 17;
+        int do_offer = a->write_heavy || (r % 100 == 0);
+
+        if (do_offer) {
+            // erros decrescentes (quase toda oferta é uma melhora) e
+            // vetor = erro repetido em todas as coordenadas (verificável)
+            double e = 1e15 - (double)(k * a->nthreads + a->tid);
+            for (int d=0; d<a->dim; d++) x[d] = e;
+            a->offer(a->cell, e, x);
+        } else {
+            double e = a->snapshot(a->cell, x);
+            for (int d=0; d<a->dim; d++) {
+                if (x[d] != e && e < 1e300) { a->inconsistent++; break; }
+            }
+        }
+        k++;
+    }
+    a->ops = k;
+    free(x);
+    return NULL;
+}
+
+// Roda nthreads por "secs" segundos; retorna Mops/s
+static double stress_run(int lockfree, int write_heavy, int nthreads,
+                         int dim, double secs, long *inconsistent) {
+    pthread_t th[64];
+    stress_arg_t args[64];
+    atomic_int stop;
+    mutex_best_t mb;
+    pso_shared_best_t *sb = NULL;
+
+    atomic_init(&stop, 0);
+    if (lockfree) {
+        sb = pso_shared_best_new(dim);
+    } else {
+        pthread_mutex_init(&mb.lock, NULL);
+        mb.error = 1e300;
+        mb.dim = dim;
+        mb.pos = (double *)calloc(dim, sizeof(double));
+    }
+
+    for (int t=0; t<nthreads; t++) {
+        args[t].offer = lockfree ? lockfree_offer : mutex_offer;
+        args[t].snapshot = lockfree ? lockfree_snapshot : mutex_snapshot;
+        args[t].cell = lockfree ? (void *)sb : (void *)&mb;
+        args[t].dim = dim;
+        args[t].tid = t;
+        args[t].nthreads = nthreads;
+        args[t].write_heavy = write_heavy;
+        args[t].stop = &stop;
+        args[t].ops = 0;
+        args[t].inconsistent = 0;
+        pthread_create(&th[t], NULL, stress_thread, &args[t]);
+    }
+
+    struct timespec ts = { (time_t)secs, (long)((secs - (time_t)secs) * 1e9) };
+    double t0 = now_ns();
+    nanosleep(&ts, NULL);
+    atomic_store(&stop, 1);
+
+    long ops = 0;
+    for (int t=0; t<nthreads; t++) {
+        pthread_join(th[t], NULL);
+        ops += args[t].ops;
+        *inconsistent += args[t].inconsistent;
+    }
+    double elapsed = (now_ns() - t0) / 1e9;
+
+    if (lockfree) {
+        pso_shared_best_free(sb);
+    } else {
+        pthread_mutex_destroy(&mb.lock);
+        free(mb.pos);
+    }
+    return ops / elapsed / 1e6;
+}
+
+static int bench_gbest(int argc, char **argv) {
+    double secs = argc > 0 ? atof(argv[0]) : 0.2;
+    int dim     = argc > 1 ? atoi(argv[1]) : 32;
+    long inconsistent = 0;
+
+    printf("dim=%d, %.2fs por ponto (Mops/s; leitura = 99%% snapshot, escrita = 100%% offer)\n",
+           dim, secs);
+    printf("threads | leitura lock-free  mutex | escrita lock-free  mutex\n");
+    for (int n=1; n<=64; n*=2) {
+        double lr = stress_run(1, 0, n, dim, secs, &inconsistent);
+        double mr = stress_run(0, 0, n, dim, secs, &inconsistent);
+        double lw = stress_run(1, 1, n, dim, secs, &inconsistent);
+        double mw = stress_run(0, 1, n, dim, secs, &inconsistent);
+        printf("%7d | %17.2f %6.2f | %17.2f %6.2f\n", n, lr, mr, lw, mw);
+    }
+    printf("snapshots inconsistentes: %ld\n", inconsistent);
+    return inconsistent != 0;
+}
+
+
+// ============================
+//  BROKER: AGRUPAMENTO DE AVALIAÇÕES
+// ============================
+
+// Modelo simulado: instância única (serializada por mutex) com custo fixo
+// alto por chamada e custo baixo por posição, como um modelo em GPU
+#define MODEL_CALL_NS 20000.0
+#define MODEL_POS_NS    200.0
+
+static pthread_mutex_t model_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void busy_ns(double ns) {
+    double t0 = now_ns();
+    while (now_ns() - t0 < ns) ;
+}
+
+static void model_batch(double **x, int dim, int n, double *fit, void *p) {
+    (void)p;
+    pthread_mutex_lock(&model_lock);
+    busy_ns(MODEL_CALL_NS + n * MODEL_POS_NS);
+    for (int i=0; i<n; i++) fit[i] = sphere(x[i], dim, NULL);
+    pthread_mutex_unlock(&model_lock);
+}
+
+static double model_one(double *x, int dim, void *p) {
+    double fit;
+    model_batch(&x, dim, 1, &fit, p);
+    return fit;
+}
+
+typedef struct {
+    pso_broker_t *broker;    // NULL = chama o modelo direto
+    int dim, steps, seed;
+} broker_arg_t;
+
+static void *broker_solver(void *p) {
+    broker_arg_t *a = (broker_arg_t *)p;
+    pso_settings_t *settings = pso_settings_new(a->dim, -5.12, 5.12);
+    pso_result_t res;
+    res.gbest = (double *)malloc(a->dim * sizeof(double));
+
+    settings->steps = a->steps;
+    settings->print_every = 0;
+    settings->seed = a->seed;
+    if (a->broker != NULL)
+        pso_solve_batch(pso_broker_batch, a->broker, &res, settings);
+    else
+        pso_solve(model_one, NULL, &res, settings);
+
+    free(res.gbest);
+    pso_settings_free(settings);
+    return NULL;
+}
+
+// Roda "solvers" solvers concorrentes; retorna avaliações/s
+static double broker_run(pso_broker_t *broker, int solvers, int dim, int steps) {
+    pthread_t th[64];
+    broker_arg_t args[64];
+    double t0 = now_ns();
+
+    for (int t=0; t<solvers; t++) {
+        args[t].broker = broker;
+        args[t].dim = dim;
+        args[t].steps = steps;
+        args[t].seed = t + 1;
+        pthread_create(&th[t], NULL, broker_solver, &args[t]);
+    }
+    for (int t=0; t<solvers; t++)
+        pthread_join(th[t], NULL);
+
+    double secs = (now_ns() - t0) / 1e9;
+    long evals = (long)solvers * pso_calc_swarm_size(dim) * (steps + 1);
+    return evals / secs;
+}
+
+static int bench_broker(int argc, char **argv) {
+    int solvers = argc > 0 ? atoi(argv[0]) : 8;
+    int batch   = argc > 1 ? atoi(argv[1]) : 256;
+    const int dim = 10, steps = 50;
+    pso_broker_stats_t st;
+
+    if (solvers < 1) solvers = 1;
+    if (solvers > 64) solvers = 64;
+    printf("modelo: %.0f us por chamada + %.2f us por posição; %d solvers, dim=%d\n",
+           MODEL_CALL_NS / 1e3, MODEL_POS_NS / 1e3, solvers, dim);
+
+    double direct = broker_run(NULL, solvers, dim, steps);
+    printf("%-26s %12.0f aval/s\n", "direto (uma por chamada)", direct);
+
+    const int waits[] = { 0, 100, 1000 };
+    for (unsigned k=0; k<sizeof(waits)/sizeof(waits[0]); k++) {
+        pso_broker_t *broker = pso_broker_new(model_batch, NULL, dim, batch, waits[k]);
+        double rate = broker_run(broker, solvers, dim, steps);
+        pso_broker_stats(broker, &st);
+        pso_broker_free(broker);
+        printf("broker lote<=%-4d espera=%-4dus %9.0f aval/s (%.1fx)  lote médio=%.1f\n",
+               batch, waits[k], rate, rate / direct,
+               (double)st.positions / st.batches);
+    }
+    return 0;
+}
+
+
+// ============================
+//   OBJETIVO ASSÍNCRONO (E/S)
+// ============================
+
+// Objetivo de E/S simulado: cada avaliação espera io_latency_us (como uma
+// consulta a um banco ou simulador) e custa quase nada de CPU
+static int io_latency_us = 1000;
+
+static double io_blocking(double *x, int dim, void *p) {
+    struct timespec ts = { io_latency_us / 1000000, (io_latency_us % 1000000) * 1000L };
+    nanosleep(&ts, NULL);
+    return sphere(x, dim, p);
+}
+
+// versão assíncrona: um timerfd por avaliação, fitness guardado em ctx
+static int io_start(const double *x, int dim, pso_async_op_t *op, double *fit, void *p) {
+    struct itimerspec its;
+    double *f = (double *)malloc(sizeof(double));
+    (void)fit;
+
+    *f = sphere((double *)x, dim, p);
+    memset(&its, 0, sizeof(its));
+    its.it_value.tv_sec = io_latency_us / 1000000;
+    its.it_value.tv_nsec = (io_latency_us % 1000000) * 1000L;
+    op->fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (op->fd < 0 || timerfd_settime(op->fd, 0, &its, NULL) != 0) {
+        if (op->fd >= 0) close(op->fd);
+        free(f);
+        return PSO_ASYNC_FAILED;
+    }
+    op->events = POLLIN;
+    op->ctx = f;
+    return PSO_ASYNC_PENDING;
+}
+
+static int io_resume(pso_async_op_t *op, int revents, double *fit, void *p) {
+    uint64_t ticks;
+    (void)revents; (void)p;
+    if (read(op->fd, &ticks, sizeof(ticks)) != sizeof(ticks))
+        return PSO_ASYNC_PENDING;
+    *fit = *(double *)op->ctx;
+    close(op->fd);
+    free(op->ctx);
+    return PSO_ASYNC_DONE;
+}
+
+static void io_cancel(pso_async_op_t *op, void *p) {
+    (void)p;
+    close(op->fd);
+    free(op->ctx);
+}
+
+// Um solve com enxame de 256; retorna avaliações/s
+static double io_run(pso_async_t *async, int threads) {
+    const int dim = 10, steps = 10;
+    pso_settings_t *settings = pso_settings_new(dim, -5.12, 5.12);
+    pso_result_t res;
+    res.gbest = (double *)malloc(dim * sizeof(double));
+
+    settings->size = 256;
+    settings->steps = steps;
+    settings->print_every = 0;
+    settings->threads = threads;
+    double t0 = now_ns();
+    if (async != NULL)
+        pso_solve_batch(pso_async_batch, async, &res, settings);
+    else
+        pso_solve(io_blocking, NULL, &res, settings);
+    double secs = (now_ns() - t0) / 1e9;
+
+    free(res.gbest);
+    pso_settings_free(settings);
+    return 256.0 * (steps + 1) / secs;
+}
+
+static int bench_async(int argc, char **argv) {
+    const pso_async_fun_t funs = { io_start, io_resume, io_cancel };
+
+    if (argc > 0) io_latency_us = atoi(argv[0]);
+    printf("objetivo: %d us de espera por avaliação, enxame de 256\n", io_latency_us);
+
+    const int threads[] = { 1, 4, 16 };
+    for (unsigned k=0; k<sizeof(threads)/sizeof(threads[0]); k++)
+        printf("bloqueante threads=%-4d    %10.0f aval/s\n",
+               threads[k], io_run(NULL, threads[k]));
+
+    const int depths[] = { 1, 4, 16, 64, 256 };
+    for (unsigned k=0; k<sizeof(depths)/sizeof(depths[0]); k++) {
+        pso_async_t *async = pso_async_new(&funs, NULL, 10, depths[k]);
+        double rate = io_run(async, 1);
+        pso_async_free(async);
+        printf("assíncrono em voo=%-4d     %10.0f aval/s\n", depths[k], rate);
+    }
+    return 0;
+}
+
+
+// ============================
+//   CONJUNTO DE DADOS (MMAP)
+// ============================
+
+#define DS_DIM 8
+
+// Regressão linear: colunas 0..DS_DIM-1 = atributos, coluna DS_DIM = alvo
+static double ds_loss(const double *x, int dim, const pso_dataset_t *ds,
+                      long first, long count, void *p) {
+    const double *y = pso_dataset_col(ds, dim) + first;
+    double *r = (double *)malloc(count * sizeof(double));
+    double sum = 0.0;
+    (void)p;
+
+    for (long i=0; i<count; i++) r[i] = -y[i];
+    for (int j=0; j<dim; j++) {
+        const double *c = pso_dataset_col(ds, j) + first;
+        for (long i=0; i<count; i++) r[i] += x[j] * c[i];
+    }
+    for (long i=0; i<count; i++) sum += r[i] * r[i];
+    free(r);
+    return sum;
+}
+
+static void dataset_run(const char *name, pso_dataset_obj_t *o) {
+    pso_settings_t *settings = pso_settings_new(DS_DIM, -5.0, 5.0);
+    pso_result_t res;
+    pso_dataset_stats_t st;
+    res.gbest = (double *)malloc(DS_DIM * sizeof(double));
+
+    settings->steps = 150;
+    settings->print_every = 0;
+    settings->threads = 1;
+    double t0 = now_ns();
+    pso_solve_batch(pso_dataset_batch, o, &res, settings);
+    double secs = (now_ns() - t0) / 1e9;
+    pso_dataset_obj_stats(o, &st);
+    double loss = pso_dataset_full(o, res.gbest, DS_DIM);
+
+    printf("%-12s %7.2f s  %12ld linhas lidas  perda=%.6f  mini-lote final=%ld\n",
+           name, secs, st.rows_read, loss, st.batch_rows);
+    free(res.gbest);
+    pso_settings_free(settings);
+}
+
+static int bench_dataset(int argc, char **argv) {
+    long rows = argc > 0 ? atol(argv[0]) : 200000;
+    const char *path = "/tmp/pso_bench.psod";
+    double *cols[DS_DIM + 1];
+    char err[256];
+
+    // y = sum (j+1)/DS_DIM * a_j + ruído (sem ordem: blocos são representativos)
+    pso_rng_t rng = pso_rng_new(1);
+    for (int j=0; j<=DS_DIM; j++) cols[j] = (double *)malloc(rows * sizeof(double));
+    for (long i=0; i<rows; i++) {
+        double u1, u2;
+        cols[DS_DIM][i] = 0.0;
+        for (int j=0; j<DS_DIM; j++) {
+            pso_rng_draw2(&rng, (int)i, j, 0, PSO_RNG_DATA, &u1, &u2);
+            cols[j][i] = 2.0 * u1 - 1.0;
+            cols[DS_DIM][i] += (j + 1.0) / DS_DIM * cols[j][i];
+        }
+        cols[DS_DIM][i] += 0.1 * (u2 - 0.5);
+    }
+    if (pso_dataset_write(path, (const double *const *)cols, DS_DIM + 1, rows) != 0) {
+        perror(path);
+        return 1;
+    }
+    for (int j=0; j<=DS_DIM; j++) free(cols[j]);
+
+    pso_dataset_t *ds = pso_dataset_open(path, err, sizeof(err));
+    if (ds == NULL) {
+        fprintf(stderr, "%s\n", err);
+        return 1;
+    }
+    printf("%ld linhas x %d colunas (%.1f MB), regressão linear dim=%d\n", rows,
+           DS_DIM + 1, rows * (DS_DIM + 1) * 8.0 / 1e6, DS_DIM);
+
+    pso_dataset_obj_t *o = pso_dataset_obj_new(ds, ds_loss, NULL, 0, 2.0, 1);
+    dataset_run("completo", o);
+    pso_dataset_obj_free(o);
+
+    o = pso_dataset_obj_new(ds, ds_loss, NULL, 4096, 2.0, 1);
+    dataset_run("mini-lote", o);
+    pso_dataset_obj_free(o);
+
+    pso_dataset_close(ds);
+    unlink(path);
+    return 0;
+}
+
+
+// ============================
+//   PORTFÓLIO: TEMPO ATÉ O ALVO
+// ============================
+
+#define PF_DIM 30
+
+typedef struct {
+    const char *name;
+    pso_obj_fun_t fun;
+    double range;
+} pf_problem_t;
+
+static const pf_problem_t pf_problems[] = {
+    { "sphere",    pso_sphere,    100.0 },
+    { "rastrigin", pso_rastrigin, 5.12 },
+    { "griewank",  pso_griewank,  600.0 },
+    { "ackley",    pso_ackley,    32.0 },
+};
+
+static pso_settings_t *pf_settings(const pf_problem_t *p, unsigned int seed) {
+    pso_settings_t *settings = pso_settings_new(PF_DIM, -p->range, p->range);
+    settings->size = 20;
+    settings->steps = 10000;
+    settings->goal = 1e-6;
+    settings->seed = seed;
+    settings->print_every = 0;
+    return settings;
+}
+
+// Média de avaliações e tempo (s) até o alvo; alvos atingidos em *hits
+static double pf_single(const pf_problem_t *p, pso_portfolio_arm_t arm,
+                        int threads, int seeds, long *evals, int *hits) {
+    pso_result_t res;
+    double t0 = now_ns();
+
+    res.gbest = (double *)malloc(PF_DIM * sizeof(double));
+    *evals = 0;
+    *hits = 0;
+    for (int k=1; k<=seeds; k++) {
+        pso_settings_t *settings = pf_settings(p, 10 * k);
+        settings->nhood_strategy = arm.nhood_strategy;
+        settings->w_strategy = arm.w_strategy;
+        settings->threads = threads;
+        pso_solve(p->fun, NULL, &res, settings);
+        *evals += res.evals;
+        *hits += res.error <= settings->goal;
+        pso_settings_free(settings);
+    }
+    free(res.gbest);
+    *evals /= seeds;
+    return (now_ns() - t0) / 1e9 / seeds;
+}
+
+static double pf_portfolio(const pf_problem_t *p, int threads, int seeds,
+                           long *evals, int *hits) {
+    pso_result_t res;
+    double t0 = now_ns();
+
+    res.gbest = (double *)malloc(PF_DIM * sizeof(double));
+    *evals = 0;
+    *hits = 0;
+    for (int k=1; k<=seeds; k++) {
+        pso_settings_t *settings = pf_settings(p, 10 * k);
+        pso_portfolio_solve(p->fun, NULL, settings, NULL, 0, threads, 0, &res, NULL);
+        *evals += res.evals;
+        *hits += res.error <= settings->goal;
+        pso_settings_free(settings);
+    }
+    free(res.gbest);
+    *evals /= seeds;
+    return (now_ns() - t0) / 1e9 / seeds;
+}
+
+static int bench_portfolio(int argc, char **argv) {
+    static const char *nhood[] = { "global", "ring", "random" };
+    static const char *inertia[] = { "const", "lindec", "apso" };
+    const pso_portfolio_arm_t arms[PSO_PORTFOLIO_DEFAULT_ARMS] = {
+        { PSO_NHOOD_GLOBAL, PSO_W_LIN_DEC }, { PSO_NHOOD_RING, PSO_W_LIN_DEC },
+        { PSO_NHOOD_RANDOM, PSO_W_LIN_DEC }, { PSO_NHOOD_GLOBAL, PSO_W_APSO },
+        { PSO_NHOOD_RING, PSO_W_APSO },      { PSO_NHOOD_RANDOM, PSO_W_APSO },
+    };
+    int threads = argc > 0 ? atoi(argv[0]) : 4;
+    int seeds = argc > 1 ? atoi(argv[1]) : 5;
+    long evals;
+    int hits;
+
+    printf("dim=%d, 20 partículas, goal=1e-6, até 10000 passos, %d threads, "
+           "média de %d sementes\n", PF_DIM, threads, seeds);
+    for (size_t i=0; i<sizeof(pf_problems) / sizeof(pf_problems[0]); i++) {
+        const pf_problem_t *p = &pf_problems[i];
+        printf("%s\n", p->name);
+        for (int k=0; k<PSO_PORTFOLIO_DEFAULT_ARMS; k++) {
+            double secs = pf_single(p, arms[k], threads, seeds, &evals, &hits);
+            printf("  %-6s %-6s   %8.3f s  %8ld aval.  alvo %d/%d\n",
+                   nhood[arms[k].nhood_strategy], inertia[arms[k].w_strategy],
+                   secs, evals, hits, seeds);
+        }
+        double secs = pf_portfolio(p, threads, seeds, &evals, &hits);
+        printf("  portfólio       %8.3f s  %8ld aval.  alvo %d/%d\n",
+               secs, evals, hits, seeds);
+    }
+    return 0;
+}
+
+
+// ============================
+//   CONTADORES POR FASE (dim x enxame)
+// ============================
+
+// contador por mil instruções da fase (-1 = indisponível)
+static double perf_per_ki(const pso_perf_stats_t *st, int ph, int c) {
+    uint64_t ins = st->count[ph][PSO_PERF_INSTRUCTIONS];
+    if (!st->available[c] || !st->available[PSO_PERF_INSTRUCTIONS] || ins == 0) return -1;
+    return 1000.0 * st->count[ph][c] / ins;
+}
+
+static double perf_ipc(const pso_perf_stats_t *st, int ph) {
+    uint64_t cyc = st->count[ph][PSO_PERF_CYCLES];
+    if (!st->available[PSO_PERF_CYCLES] || !st->available[PSO_PERF_INSTRUCTIONS] || cyc == 0)
+        return -1;
+    return (double)st->count[ph][PSO_PERF_INSTRUCTIONS] / cyc;
+}
+
+static int bench_perf(int argc, char **argv) {
+    static const int dims[] = { 10, 100, 1000 };
+    static const int sizes[] = { 20, 200 };
+    int steps = argc > 0 ? atoi(argv[0]) : 200;
+    pso_perf_t *perf = pso_perf_new();
+    pso_perf_stats_t st;
+    pso_result_t res;
+
+    if (perf == NULL) return 1;
+    printf("rastrigin, anel, %d passos; update em ns por (partícula, dimensão);\n"
+           "IPC e falhas de cache (último nível) por mil instruções, -1 = indisponível\n",
+           steps);
+    printf("%5s %5s %8s %7s %7s %7s %7s %7s %7s %8s %8s\n", "dim", "size",
+           "ns/upd", "upd%", "inf%", "eval%", "book%",
+           "IPCupd", "IPCeval", "cacheupd", "cacheval");
+
+    for (size_t i=0; i<sizeof(dims) / sizeof(dims[0]); i++) {
+        for (size_t j=0; j<sizeof(sizes) / sizeof(sizes[0]); j++) {
+            pso_settings_t *settings = pso_settings_new(dims[i], -5.12, 5.12);
+            double total = 0.0;
+
+            settings->size = sizes[j];
+            settings->steps = steps;
+            settings->goal = -1; // nunca para antes
+            settings->seed = 1;
+            settings->print_every = 0;
+            settings->perf = perf;
+            res.gbest = (double *)malloc(dims[i] * sizeof(double));
+
+            pso_perf_reset(perf);
+            pso_solve(pso_rastrigin, NULL, &res, settings);
+            pso_perf_stats(perf, &st);
+            for (int ph=0; ph<PSO_PHASES; ph++) total += st.ns[ph];
+
+            printf("%5d %5d %8.2f %7.1f %7.1f %7.1f %7.1f %7.2f %7.2f %8.2f %8.2f\n",
+                   dims[i], sizes[j],
+                   st.ns[PSO_PHASE_UPDATE] / ((double)steps * sizes[j] * dims[i]),
+                   100.0 * st.ns[PSO_PHASE_UPDATE] / total,
+                   100.0 * st.ns[PSO_PHASE_INFORM] / total,
+                   100.0 * st.ns[PSO_PHASE_EVAL] / total,
+                   100.0 * st.ns[PSO_PHASE_BOOK] / total,
+                   perf_ipc(&st, PSO_PHASE_UPDATE), perf_ipc(&st, PSO_PHASE_EVAL),
+                   perf_per_ki(&st, PSO_PHASE_UPDATE, PSO_PERF_CACHE_MISSES),
+                   perf_per_ki(&st, PSO_PHASE_EVAL, PSO_PERF_CACHE_MISSES));
+
+            free(res.gbest);
+            pso_settings_free(settings);
+        }
+    }
+    if (pso_perf_status(perf) != NULL)
+        printf("contadores: %s\n", pso_perf_status(perf));
+    pso_perf_free(perf);
+    return 0;
+}
+
+
+// ============================
+//   LATÊNCIA DO OBJETIVO (custo por região)
+// ============================
+
+// sphere que custa 2 us, ou 200 us com x[0] > 3 (ex.: simulação que
+// demora mais a convergir numa parte do domínio)
+static double costly_sphere(double *x, int dim, void *p) {
+    busy_ns(x[0] > 3.0 ? 200e3 : 2e3);
+    return sphere(x, dim, p);
+}
+
+static int bench_latency(int argc, char **argv) {
+    int steps = argc > 0 ? atoi(argv[0]) : 100;
+    pso_settings_t *settings = pso_settings_new(10, -5.0, 5.0);
+    pso_latency_t *lat = pso_latency_new(10);
+    pso_latency_stats_t st;
+    pso_result_t res;
+    int far = 0;
+
+    if (settings == NULL || lat == NULL) return 1;
+    settings->size = 40;
+    settings->steps = steps;
+    settings->seed = 1;
+    settings->print_every = 0;
+    settings->latency = lat;
+    res.gbest = (double *)malloc(10 * sizeof(double));
+
+    printf("sphere dim 10, 40 partículas, %d passos: 2 us, ou 200 us com x[0] > 3\n",
+           steps);
+    pso_solve(costly_sphere, NULL, &res, settings);
+    pso_latency_print(stdout, lat);
+
+    pso_latency_stats(lat, &st);
+    for (int k=0; k<st.nslow; k++) far += st.slow_pos[k][0] > 3.0;
+    printf("mais lentas com x[0] > 3: %d/%d\n", far, st.nslow);
+
+    free(res.gbest);
+    pso_latency_free(lat);
+    pso_settings_free(settings);
+    return 0;
+}
+
+
+// ============================
+//   NUMA: ESCALA COM THREADS FIXADAS
+// ============================
+
+// Um solve de sphere com enxame grande (posições bem maiores que o
+// cache); menor tempo (ms) de 3 execuções, erro final em *err
+static double numa_solve(int threads, int numa, int dim, int size, int steps,
+                         double *err)
+{
+    double best = -1;
+
+    for (int rep=0; rep<3; rep++) {
+        pso_settings_t *settings = pso_settings_new(dim, -5.0, 5.0);
+        pso_result_t res;
+        double t0;
+
+        settings->size = size;
+        settings->steps = steps;
+        settings->goal = -1; // nunca para antes
+        settings->seed = 1;
+        settings->print_every = 0;
+        settings->threads = threads;
+        settings->numa = numa;
+        res.gbest = (double *)malloc(dim * sizeof(double));
+
+        t0 = now_ns();
+        pso_solve(sphere, NULL, &res, settings);
+        t0 = (now_ns() - t0) / 1e6;
+        if (best < 0 || t0 < best) best = t0;
+        *err = res.error;
+
+        free(res.gbest);
+        pso_settings_free(settings);
+    }
+    return best;
+}
+
+static int bench_numa(int argc, char **argv) {
+    int steps = argc > 0 ? atoi(argv[0]) : 100;
+    int maxth = argc > 1 ? atoi(argv[1]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int dim = 1000, size = 512;
+    double base = 0.0, e_free, e_numa;
+    int *cpus, *nodes;
+
+    if (maxth < 1) maxth = 1;
+    cpus = (int *)malloc(maxth * sizeof(int));
+    nodes = (int *)malloc(maxth * sizeof(int));
+    if (cpus == NULL || nodes == NULL) return 1;
+
+    printf("sphere dim %d, %d partículas (%.0f MB em pos/vel/pos_b/pos_nb), %d passos\n",
+           dim, size, 4.0 * size * dim * sizeof(double) / 1e6, steps);
+    printf("%d nó(s) NUMA; com %d threads, CPU(nó):", pso_numa_nodes(), maxth);
+    pso_numa_layout(maxth, cpus, nodes);
+    for (int k=0; k<maxth; k++) printf(" %d(%d)", cpus[k], nodes[k]);
+    printf("\n");
+    printf("livre: threads soltas, só a avaliação no pool (roubo de tarefas)\n"
+           "numa:  threads fixadas, um bloco de partículas por thread (atualização\n"
+           "       e avaliação na dona, memória tocada primeiro por ela)\n");
+    printf("%7s %10s %10s %8s %8s\n", "threads", "livre ms", "numa ms", "x livre", "x numa");
+
+    for (int t=1; t<=maxth; t = (t < maxth && 2 * t > maxth) ? maxth : 2 * t) {
+        double t_free = numa_solve(t, 0, dim, size, steps, &e_free);
+        double t_numa = numa_solve(t, 1, dim, size, steps, &e_numa);
+
+        if (t == 1) base = t_free;
+        printf("%7d %10.1f %10.1f %8.2f %8.2f%s\n", t, t_free, t_numa,
+               base / t_free, base / t_numa,
+               e_free == e_numa ? "" : "  (resultados diferentes!)");
+    }
+    free(cpus);
+    free(nodes);
+    return 0;
+}
+
+
+// ============================
+//   SUBPROCESSOS: TIMEOUT E QUEDA
+// ============================
+
+#define SP_N 6
+
+// Modelo em sh: fitness = x[0], mas trava quando x[0] = 9
+#define SP_HANG "while read x r; do [ \"$x\" = 9 ] && sleep 60; echo \"$x\"; done"
+
+// Avalia SP_N posições (x[0] = 9, 2, 3, ...) com um filho; confere quais
+// voltaram HUGE_VAL (bit i de hang_mask) e os contadores
+static int subproc_case(const char *name, const char *cmd, int timeout_ms, int calls,
+                        int hang_mask, long timeouts, long restarts, long failed)
+{
+    double xs[SP_N][2], *x[SP_N], fit[SP_N];
+    pso_subproc_stats_t st;
+    char err[256];
+    int ok = 1;
+
+    pso_subproc_t *sp = pso_subproc_new(cmd, 1, PSO_SUBPROC_LINE, 2, err, sizeof(err));
+    if (sp == NULL) {
+        fprintf(stderr, "%s\n", err);
+        return 1;
+    }
+    pso_subproc_config(sp, 4, timeout_ms);
+    for (int i=0; i<SP_N; i++) {
+        xs[i][0] = i == 0 ? 9 : i + 1;
+        xs[i][1] = 0.0;
+        x[i] = xs[i];
+    }
+
+    double t0 = now_ns();
+    for (int c=0; c<calls; c++) {
+        pso_subproc_batch(x, 2, SP_N, fit, sp);
+        for (int i=0; i<SP_N; i++) {
+            double want = (hang_mask >> i) & 1 ? HUGE_VAL : xs[i][0];
+            if (fit[i] != want) ok = 0;
+        }
+    }
+    pso_subproc_stats(sp, &st);
+    pso_subproc_free(sp);
+
+    if (st.timeouts != timeouts || st.restarts != restarts || st.failed != failed) ok = 0;
+    printf("%-22s %7.0f ms  evals=%ld timeouts=%ld restarts=%ld failed=%ld  %s\n",
+           name, (now_ns() - t0) / 1e6, st.evals, st.timeouts, st.restarts, st.failed,
+           ok ? "ok" : "ERRADO");
+    return ok ? 0 : 1;
+}
+
+static int bench_subproc(int argc, char **argv) {
+    int timeout_ms = argc > 0 ? atoi(argv[0]) : 300;
+    int bad = 0;
+
+    if (timeout_ms < 1) timeout_ms = 1;
+    printf("%d posições, 1 filho, 4 em voo, timeout de %d ms\n", SP_N, timeout_ms);
+
+    // trava na primeira avaliação: o filho é recriado a cada timeout e só
+    // a posição que trava é desistida (as outras são respondidas)
+    bad |= subproc_case("timeout na primeira", SP_HANG, timeout_ms, 1, 1,
+                        PSO_SUBPROC_ATTEMPTS, PSO_SUBPROC_ATTEMPTS, 1);
+
+    // sai sem responder: não é recriado na mesma chamada (sem ciclo de
+    // fork), só no início da seguinte
+    bad |= subproc_case("sai sem responder", "exit 3", timeout_ms, 2, (1 << SP_N) - 1,
+                        0, 1, 2 * SP_N);
+    return bad;
+}
+
+
+// ============================
+//            MAIN
+// ============================
+int main(int argc, char **argv) {
+    if (argc >= 2 && strcmp(argv[1], "small") == 0)
+        return bench_small(argc - 2, argv + 2);
+    if (argc >= 2 && strcmp(argv[1], "batch") == 0)
+        return bench_batch(argc - 2, argv + 2);
+    if (argc >= 2 && strcmp(argv[1], "gbest") == 0)
+        return bench_gbest(argc - 2, argv + 2);
+    if (argc >= 2 && strcmp(argv[1], "broker") == 0)
+        return bench_broker(argc - 2, argv + 2);
+    if (argc >= 2 && strcmp(argv[1], "async") == 0)
+        return bench_async(argc - 2, argv + 2);
+    if (argc >= 2 && strcmp(argv[1], "dataset") == 0)
+        return bench_dataset(argc - 2, argv + 2);
+    if (argc >= 2 && strcmp(argv[1], "portfolio") == 0)
+        return bench_portfolio(argc - 2, argv + 2);
+    if (argc >= 2 && strcmp(argv[1], "perf") == 0)
+        return bench_perf(argc - 2, argv + 2);
+    if (argc >= 2 && strcmp(argv[1], "latency") == 0)
+        return bench_latency(argc - 2, argv + 2);
+    if (argc >= 2 && strcmp(argv[1], "numa") == 0)
+        return bench_numa(argc - 2, argv + 2);
+    if (argc >= 2 && strcmp(argv[1], "subproc") == 0)
+        return bench_subproc(argc - 2, argv + 2);
+
+    fprintf(stderr,
+            "uso: %s small [solves] [steps]\n"
+            "     %s batch [problemas] [passos]\n"
+            "     %s gbest [segundos] [dim]\n"
+            "     %s broker [solvers] [lote]\n"
+            "     %s async [latencia_us]\n"
+            "     %s dataset [linhas]\n"
+            "     %s portfolio [threads] [sementes]\n"
+            "     %s perf [passos]\n"
+            "     %s latency [passos]\n"
+            "     %s numa [passos] [threads]\n"
+            "     %s subproc [timeout_ms]\n",
+            argv[0], argv[0], argv[0], argv[0], argv[0], argv[0], argv[0], argv[0], argv[0], argv[0],
+            argv[0]);
+    return 1;
+}
@@ -1,7 +1,7 @@
 /* Implementao do algoritmo Particle Swarm Optimization (PSO)
 */
 
-#include <stdlib.h>   // rand(), malloc(), free()
+#include <stdlib.h>   // malloc(), free()
 #include <stdio.h>    // printf()
 #include <time.h>     // time()
 #include <math.h>     // cos(), pow(), sqrt(), fmod()
@@ -9,6 +9,18 @@
 #include <string.h>   // memmove(), memset()
 
 #include "pso.h"
+#include "pso_rng.h"
+#include "pso_shared.h"
+#include "pso_pool.h"
+#include "pso_numa.h"
+#include "pso_perf.h"
+#include "pso_trace.h"
+#include "pso_latency.h"
+#include "pso_metrics.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
 
 
 //  Sada "grfica" no terminal (barra de progresso)
@@ -34,19 +46,16 @@ static void pso_print_progress_bar(int step, int steps, double w, double best_er
 }
 
 
-// Macros de nmeros aleatrios
-
-
-// gera um double no intervalo (0, 1)
-#define RNG_UNIFORM() (rand()/(double)RAND_MAX)
-
-// gera um inteiro no intervalo [0, s)
-#define RNG_UNIFORM_INT(s) (rand()%s)
+// Nmeros aleatrios: gerador baseado em contador (pso_rng.h).
+// Cada sorteio depende s de (semente, passo, partcula, dimenso), ento
+// o resultado no depende da ordem em que as partculas so processadas.
 
 // tipo de funo para as diferentes estratatgias de vizinhana
+// (size = partculas ativas, ver settings->size_strategy)
 typedef void (*inform_fun_t)(int *comm, double **pos_nb,
                              double **pos_b, double *fit_b,
                              double *gbest, int improved,
+                             const pso_rng_t *rng, int size,
                              pso_settings_t *settings);
 
 // tipo de funo para as diferentes estratgias de inrcia
@@ -87,11 +96,12 @@ double calc_inertia_lin_dec(int step, pso_settings_t *settings) {
 void inform_global(int *comm, double **pos_nb,
                    double **pos_b, double *fit_b,
                    double *gbest, int improved,
+                   const pso_rng_t *rng, int size,
                    pso_settings_t *settings)
 {
-    (void)comm; (void)pos_b; (void)fit_b; (void)improved;
+    (void)comm; (void)pos_b; (void)fit_b; (void)improved; (void)rng;
     // todas recebem o mesmo "atrator": gbest
-    for (int i=0; i<settings->size; i++)
+    for (int i=0; i<size; i++)
         memmove((void *)pos_nb[i], (void *)gbest,
                 sizeof(double) * settings->dim);
 }
@@ -103,19 +113,19 @@ void inform_global(int *comm, double **pos_nb,
 // pos_nb[j] = melhor posio encontrada entre os vizinhos de j
 
 void inform(int *comm, double **pos_nb, double **pos_b, double *fit_b,
-            int improved, pso_settings_t * settings)
+            int improved, int size, pso_settings_t * settings)
 {
     (void)improved;
     int i, j;
     int b_n; 
 
     // para cada partcula j
-    for (j=0; j<settings->size; j++) {
+    for (j=0; j<size; j++) {
         b_n = j; // inicialmente, considera ela mesma como melhor
         // procura qual vizinho (informante) tem menor erro
-        for (i=0; i<settings->size; i++)
+        for (i=0; i<size; i++)
             // se i informa j e i tem fitness melhor que o melhor atual
-            if (comm[i*settings->size + j] && fit_b[i] < fit_b[b_n])
+            if (comm[i*size + j] && fit_b[i] < fit_b[b_n])
                 b_n = i;
 
         // copia o pbest do melhor vizinho para pos_nb[j]
@@ -131,29 +141,29 @@ void inform(int *comm, double **pos_nb, double **pos_b, double *fit_b,
 
 // Inicializa a matriz COMM para topologia em anel (fixa):
 // cada partcula se conecta com ela mesma + vizinho da esquerda + vizinho da direita
-void init_comm_ring(int *comm, pso_settings_t * settings) {
+void init_comm_ring(int *comm, int size) {
     // zera a matriz de conectividade
-    memset((void *)comm, 0, sizeof(int)*settings->size*settings->size);
+    memset((void *)comm, 0, sizeof(int)*size*size);
 
-    for (int i=0; i<settings->size; i++) {
+    for (int i=0; i<size; i++) {
         // cada partcula informa a si mesma
-        comm[i*settings->size+i] = 1;
+        comm[i*size+i] = 1;
 
         if (i==0) {
             // vizinho  direita
-            comm[i*settings->size+i+1] = 1;
+            comm[i*size+i+1] = 1;
             // vizinho  esquerda (ltimo da lista)
-            comm[(i+1)*settings->size-1] = 1;
-        } else if (i==settings->size-1) {
+            comm[(i+1)*size-1] = 1;
+        } else if (i==size-1) {
             // vizinho  direita (primeiro da lista)
-            comm[i*settings->size] = 1;
+            comm[i*size] = 1;
             // vizinho  esquerda
-            comm[i*settings->size+i-1] = 1;
+            comm[i*size+i-1] = 1;
         } else {
             // vizinho  direita
-            comm[i*settings->size+i+1] = 1;
+            comm[i*size+i+1] = 1;
             // vizinho  esquerda
-            comm[i*settings->size+i-1] = 1;
+            comm[i*size+i-1] = 1;
         }
     }
 }
@@ -161,11 +171,12 @@ void init_comm_ring(int *comm, pso_settings_t * settings) {
 void inform_ring(int *comm, double **pos_nb,
                  double **pos_b, double *fit_b,
                  double *gbest, int improved,
+                 const pso_rng_t *rng, int size,
                  pso_settings_t * settings)
 {
-    (void)gbest;
+    (void)gbest; (void)rng;
     // atualiza pos_nb usando a matriz COMM do anel
-    inform(comm, pos_nb, pos_b, fit_b, improved, settings);
+    inform(comm, pos_nb, pos_b, fit_b, improved, size, settings);
 }
 
 
@@ -174,19 +185,24 @@ void inform_ring(int *comm, double **pos_nb,
 
 // Inicializa COMM de forma aleatria:
 // em mdia, cada partcula escolhe nhood_size informantes
-void init_comm_random(int *comm, pso_settings_t * settings) {
+// (sorteio chaveado pelo passo: step = -1 antes do primeiro passo)
+void init_comm_random(int *comm, const pso_rng_t *rng, int step, int size,
+                      pso_settings_t * settings) {
+    double u, unused;
+
     // zera a matriz
-    memset((void *)comm, 0, sizeof(int)*settings->size*settings->size);
+    memset((void *)comm, 0, sizeof(int)*size*size);
 
-    for (int i=0; i<settings->size; i++) {
+    for (int i=0; i<size; i++) {
         // cada partcula informa a si mesma
-        comm[i*settings->size + i] = 1;
+        comm[i*size + i] = 1;
 
         // escolhe informantes aleatrios
         for (int k=0; k<settings->nhood_size; k++) {
-            int j = RNG_UNIFORM_INT(settings->size);
+            pso_rng_draw2(rng, step, i, k, PSO_RNG_TOPO, &u, &unused);
+            int j = (int)(u * size);
             // partcula i informa partcula j
-            comm[i*settings->size + j] = 1;
+            comm[i*size + j] = 1;
         }
     }
 }
@@ -194,15 +210,16 @@ void init_comm_random(int *comm, pso_settings_t * settings) {
 void inform_random(int *comm, double **pos_nb,
                    double **pos_b, double *fit_b,
                    double *gbest, int improved,
+                   const pso_rng_t *rng, int size,
                    pso_settings_t * settings)
 {
     (void)gbest;
 
     // Se no houve melhora, muda a vizinhana aleatria
     if (!improved)
-        init_comm_random(comm, settings);
+        init_comm_random(comm, rng, settings->step, size, settings);
 
-    inform(comm, pos_nb, pos_b, fit_b, improved, settings);
+    inform(comm, pos_nb, pos_b, fit_b, improved, size, settings);
 }
 
 
@@ -229,6 +246,8 @@ pso_settings_t *pso_settings_new(int dim, double range_lo, double range_hi) {
 
     // defaults clssicos
     settings->size = pso_calc_swarm_size(settings->dim);
+    settings->size_strategy = PSO_SIZE_CONST;
+    settings->size_min = 4;
     settings->print_every = 1000;
     settings->steps = 100000;
     settings->c1 = 1.496;
@@ -240,6 +259,16 @@ pso_settings_t *pso_settings_new(int dim, double range_lo, double range_hi) {
     settings->nhood_strategy = PSO_NHOOD_RING;
     settings->nhood_size = 5;
     settings->w_strategy = PSO_W_LIN_DEC;
+    settings->seed = 0;
+    settings->shared_best = NULL;
+    settings->threads = 1;
+    settings->cpu_affinity = NULL;
+    settings->pool = NULL;
+    settings->numa = 0;
+    settings->noise_samples = 0;
+    settings->perf = NULL;
+    settings->latency = NULL;
+    settings->metrics = NULL;
 
     return settings;
 }
@@ -269,63 +298,1119 @@ void pso_matrix_free(double **m, int size) {
 }
 
 
-//                 ALGORITMO PRINCIPAL
+// Troca com a melhor soluo compartilhada (se configurada):
+// publica o gbest local e adota o compartilhado se ele for melhor.
+// No caso comum so s duas cargas atmicas (sem syscalls nem travas).
+// O erro da clula pode estar  frente do vetor (quem ganhou a troca
+// ainda est copiando): a cpia vai para tmp e s  adotada se o par
+// (erro, vetor) devolvido for mesmo melhor que o local.
+static void share_best(pso_result_t *solution, pso_settings_t *settings,
+                       double *tmp) {
+    pso_shared_best_t *shared = settings->shared_best;
+    double err;
+
+    if (shared == NULL) return;
+
+    pso_shared_best_offer(shared, solution->error, solution->gbest);
+    if (pso_shared_best_error(shared) < solution->error) {
+        err = pso_shared_best_snapshot(shared, tmp);
+        if (err < solution->error) {
+            solution->error = err;
+            memcpy(solution->gbest, tmp, settings->dim * sizeof(double));
+        }
+    }
+}
 
-void pso_solve(pso_obj_fun_t obj_fun, void *obj_fun_params,
-               pso_result_t *solution, pso_settings_t *settings)
+
+//        AVALIAO DAS PARTCULAS (SERIAL OU NO POOL)
+
+// Funo objetivo vista pelo solver: uma posio por chamada (com
+// cutoff) ou vrias posies por chamada (lote)
+typedef struct {
+    pso_obj_fun_cut_t fun;
+    pso_obj_batch_fun_t fun_batch;
+    void *params;
+} objective_t;
+
+// Bloco de partculas [lo, hi) avaliado por uma tarefa
+typedef struct {
+    const objective_t *obj;
+    double **x;            // posies a avaliar
+    const double *cutoff;  // pbest de cada partcula (NULL = sem corte)
+    double *fit;           // sada
+    int dim, lo, hi;
+    int slot;              // thread que avalia (-1 = qualquer; ver numa_part_t)
+    struct pso_latency *latency; // settings->latency (NULL = no mede)
+} eval_chunk_t;
+
+static void eval_chunk(void *arg) {
+    eval_chunk_t *c = (eval_chunk_t *)arg;
+    const objective_t *obj = c->obj;
+    uint64_t t0 = pso_trace_begin();
+
+    if (obj->fun_batch != NULL) {
+        uint64_t l0 = c->latency ? pso_latency_begin() : 0;
+        obj->fun_batch(c->x + c->lo, c->dim, c->hi - c->lo, c->fit + c->lo,
+                       obj->params);
+        if (c->latency) pso_latency_end(c->latency, l0, c->hi - c->lo, NULL);
+    } else if (c->latency != NULL) {
+        // cada chamada cronometrada (com a posio, para as mais lentas)
+        for (int i=c->lo; i<c->hi; i++) {
+            uint64_t l0 = pso_latency_begin();
+            c->fit[i] = obj->fun(c->x[i], c->dim, obj->params,
+                                 c->cutoff ? c->cutoff[i] : DBL_MAX);
+            pso_latency_end(c->latency, l0, 1, c->x[i]);
+        }
+    } else {
+        for (int i=c->lo; i<c->hi; i++)
+            c->fit[i] = obj->fun(c->x[i], c->dim, obj->params,
+                                 c->cutoff ? c->cutoff[i] : DBL_MAX);
+    }
+    pso_trace_end("eval", t0, c->hi - c->lo);
+}
+
+// Avalia todas as partculas (sem pool: um nico bloco, na thread atual).
+// Cada fit[i] depende s de x[i], ento o resultado  o mesmo para
+// qualquer nmero de threads.
+static void evaluate(pso_pool_t *pool, eval_chunk_t *chunks, int nchunks,
+                     double **x, const double *cutoff)
 {
+    pso_task_group_t group;
+    uint64_t t0;
+    int k;
 
-    // Estruturas das partcula
+    for (k=0; k<nchunks; k++) {
+        chunks[k].x = x;
+        chunks[k].cutoff = cutoff;
+    }
+    if (pool == NULL) {
+        eval_chunk(&chunks[0]);
+        return;
+    }
+
+    t0 = pso_trace_begin();
+    pso_task_group_init(&group);
+    for (k=0; k<nchunks; k++) {
+        if (chunks[k].lo >= chunks[k].hi) continue;
+        if (chunks[k].slot >= 0)
+            pso_pool_spawn_to(pool, &group, chunks[k].slot, eval_chunk, &chunks[k]);
+        else
+            pso_pool_spawn(pool, &group, eval_chunk, &chunks[k]);
+    }
+    pso_pool_sync(pool, &group);
+    pso_trace_end("barrier", t0, nchunks);
+}
 
+
+//                 ALGORITMO PRINCIPAL
+
+// Adaptador: funo objetivo comum (sem cutoff) vista como pso_obj_fun_cut_t
+typedef struct {
+    pso_obj_fun_t fun;
+    void *params;
+} obj_plain_t;
+
+static double obj_plain_cut(double *x, int dim, void *params, double cutoff) {
+    (void)cutoff;
+    obj_plain_t *o = (obj_plain_t *)params;
+    return o->fun(x, dim, o->params);
+}
+
+// Amostras de um ponto do objetivo ruidoso (mdia/varincia de Welford)
+typedef struct {
+    int n;
+    double mean, m2;
+} noise_stat_t;
+
+// Corrida entre dois pontos: a (desafiante) contra b (atual)
+typedef struct {
+    noise_stat_t *a, *b;
+    double *xa, *xb;
+    int result;        // 0 = em aberto, 1 = a  melhor, -1 = b  melhor (ou empate)
+} noise_race_t;
+
+// Diferena significativa: mdias separadas por PSO_NOISE_Z erros-padro
+#define PSO_NOISE_Z 2.0
+
+// Diferena topo - degrau (mdia e varincia mveis, ver fidelity_add)
+typedef struct {
+    int n;
+    double mean, var;
+} fidelity_delta_t;
+
+// Bloco de partculas [lo, hi) de uma thread no modo NUMA
+// (settings->numa): as linhas de pos, vel, pos_b e pos_nb ficam em slab,
+// alocado e inicializado pela prpria thread slot
+typedef struct {
+    struct pso_state *s;
+    int slot, lo, hi;
+    double *slab;
+    double *u1, *u2;           // sorteios (rea prpria da thread)
+} numa_part_t;
+
+// Estado de uma otimizao em andamento (ver pso_state_new)
+struct pso_state {
+    objective_t obj;
+    obj_plain_t plain;         // adaptador usado por pso_state_new
+
+    pso_result_t *solution;
+    pso_settings_t *settings;
+
+    // Estruturas das partcula
+    //
     // pos   : posies atuais
     // vel   : velocidades atuais
     // pos_b : melhor posio (pbest) de cada partcula
-    double **pos   = pso_matrix_new(settings->size, settings->dim);
-    double **vel   = pso_matrix_new(settings->size, settings->dim);
-    double **pos_b = pso_matrix_new(settings->size, settings->dim);
+    //
+    // pos[i] e pos_b[i] funcionam como buffer duplo: quando a partcula
+    // melhora, os ponteiros so trocados (sem copiar o vetor) e at_b[i]
+    // indica que a posio atual est em pos_b[i]; a prxima atualizao
+    // l de pos_b[i] e escreve em pos[i] (o buffer livre).
+    double **pos;
+    double **vel;
+    double **pos_b;
+    char *at_b;
 
     // fit   : fitness (erro) atual de cada partcula
     // fit_b : melhor fitness (erro) de cada partcula (pbest)
-    double *fit   = (double *)malloc(settings->size * sizeof(double));
-    double *fit_b = (double *)malloc(settings->size * sizeof(double));
+    double *fit;
+    double *fit_b;
 
     // pos_nb : melhor posio informada (melhor dos vizinhos) para cada partcula
-    double **pos_nb = pso_matrix_new(settings->size, settings->dim);
+    double **pos_nb;
 
     // comm : matriz de conectividade (quem informa quem)
-    int *comm = (int *)malloc(settings->size * settings->size * sizeof(int));
+    int *comm;
 
     // improved indica se o gbest melhorou na lltima iterao
-    int improved = 0;
+    int improved;
+
+    // partculas ativas: as size primeiras (settings->size_strategy pode
+    // reduzir; as linhas das que saram ficam no fim das matrizes)
+    int size;
+    int stall;                 // passos seguidos sem melhorar o gbest
+    int apso_improved;         // gbest melhorado pelo APSO antes do inform
+    char *drop;                // marcao das que saem (swarm_shrink)
+    double **rows;             // rea da compactao (swarm_shrink)
+
+    int step;                  // prximo passo a executar
+    int done;                  // 1 = terminou (goal ou steps)
+    int progress_used;         // barra de progresso j impressa
+    double w;                  // inrcia atual
+    double c1, c2;             // coeficientes atuais (settings, ou APSO)
+
+    // APSO (settings->w_strategy = PSO_W_APSO; seno xt = NULL)
+    double *xt;                // posies atuais transpostas (dim x size)
+    double *dist;              // distncia mdia de cada partcula s outras
+    double *acc;               // distncias ao quadrado de uma linha
+    double *els;               // candidata da perturbao elitista
+    int ese;                   // estado evolutivo do passo anterior
+
+    // pgina de mtricas (settings->metrics; seno centroid = NULL)
+    double *centroid;
+    double diversity;          // ltimo valor calculado
+
+    // cpia da melhor compartilhada (settings->shared_best; seno NULL)
+    double *shared_pos;
+
+    inform_fun_t  inform_fun;        // funo de vizinhana
+    inertia_fun_t calc_inertia_fun;  // funo de inrcia
+
+    // gerador aleatrio chaveado pela semente
+    pso_rng_t rng;
+
+    // u1/u2 : uniformes de uma partcula inteira (gerados em bloco)
+    double *u1;
+    double *u2;
+
+    // pool de threads para a avaliao (prprio ou do usurio)
+    pso_pool_t *pool;
+    int own_pool;
+
+    // blocos de avaliao
+    eval_chunk_t *chunks;
+    int nchunks;
+
+    // partio NUMA (settings->numa; seno nparts = 0)
+    numa_part_t *parts;
+    int nparts;
+
+    // objetivo ruidoso (settings->noise_samples > 1; seno NULL)
+    noise_stat_t *nb;          // amostras do pbest de cada partcula
+    noise_stat_t *nc;          // amostras da posio nova (desafiante)
+    noise_race_t *races;
+    int *race_idx;             // partcula de cada corrida
+    double **sx;               // reamostragem de uma rodada: posies,
+    noise_stat_t **sst;        // estatstica a atualizar
+    double *sf;                // e resultados
+    int g_best;                // partcula que detm o gbest
+
+    // multi-fidelidade (pso_state_new_multi; seno nlevels = 0)
+    pso_fidelity_t ladder[PSO_MAX_FIDELITY];
+    int nlevels;
+    fidelity_delta_t delta[PSO_MAX_FIDELITY];  // topo - degrau k (mesma posio)
+    double *flev[PSO_MAX_FIDELITY];        // valor no degrau k neste passo
+    int *fidx;                             // partcula de cada posio em sx
+};
+
+
+//        OBJETIVO RUIDOSO (REAMOSTRAGEM ADAPTATIVA)
+
+// Com rudo, a comparao direta "fit < fit_b" aceita avaliaes com
+// sorte e o enxame passa a perseguir o rudo. Com noise_samples > 1 cada
+// comparao vira uma corrida: s se reamostra enquanto a diferena no 
+// significativa, e as amostras de cada pbest ficam guardadas para as
+// corridas seguintes (em vez de tirar a mdia de k avaliaes de tudo).
+
+// Avalia m posies quaisquer (m <= size) nos blocos j montados, sem
+// cutoff: um valor abortado no serve como amostra
+static void evaluate_list(pso_state_t *s, double **x, int m, double *out) {
+    int k, n;
+
+    for (n=0; n<s->nchunks && s->chunks[n].lo < m; n++) {
+        s->chunks[n].fit = out;
+        if (s->chunks[n].hi > m) s->chunks[n].hi = m;
+    }
+    evaluate(s->pool, s->chunks, n, x, NULL);
+
+    // restaura os blocos do enxame
+    for (k=0; k<n; k++) {
+        s->chunks[k].fit = s->fit;
+        s->chunks[k].hi = k + 1 < s->nchunks ? s->chunks[k+1].lo : s->size;
+    }
+}
+
+static void noise_add(noise_stat_t *st, double f) {
+    double delta = f - st->mean;
+    st->n++;
+    st->mean += delta / st->n;
+    st->m2 += delta * (f - st->mean);
+}
+
+// Roda as corridas at todas decidirem: a cada rodada, cada corrida em
+// aberto reavalia o ponto com menos amostras (as rodadas so avaliadas em
+// lote). Retorna o nmero de avaliaes feitas.
+static int noise_run(pso_state_t *s, noise_race_t *r, int nr) {
+    const int budget = s->settings->noise_samples;
+    int evals = 0;
+
+    for (;;) {
+        // varincia combinada do enxame (para pontos com uma s amostra)
+        double m2 = 0.0, pooled = -1.0;
+        long df = 0;
+        for (int i=0; i<s->size; i++)
+            if (s->nb[i].n >= 2) { m2 += s->nb[i].m2; df += s->nb[i].n - 1; }
+        for (int k=0; k<nr; k++)
+            if (r[k].a->n >= 2) { m2 += r[k].a->m2; df += r[k].a->n - 1; }
+        if (df > 0) pooled = m2 / df;
+
+        int m = 0;
+        for (int k=0; k<nr; k++) {
+            noise_stat_t *a = r[k].a, *b = r[k].b;
+            double diff = a->mean - b->mean;
+            double va = a->n >= 2 ? a->m2 / (a->n - 1) : pooled;
+            double vb = b->n >= 2 ? b->m2 / (b->n - 1) : pooled;
+
+            if (r[k].result != 0) continue;
+            if (va >= 0 && vb >= 0) {
+                double se = sqrt(va / a->n + vb / b->n);
+                if (diff + PSO_NOISE_Z * se < 0) { r[k].result = 1; continue; }
+                if (diff - PSO_NOISE_Z * se > 0) { r[k].result = -1; continue; }
+            }
+            if (a->n >= budget && b->n >= budget) {
+                r[k].result = diff < 0 ? 1 : -1;
+                continue;
+            }
+            if (a->n <= b->n && a->n < budget) {
+                s->sx[m] = r[k].xa; s->sst[m] = a;
+            } else {
+                s->sx[m] = r[k].xb; s->sst[m] = b;
+            }
+            m++;
+        }
+        if (m == 0) return evals;
+
+        evaluate_list(s, s->sx, m, s->sf);
+        for (int j=0; j<m; j++) noise_add(s->sst[j], s->sf[j]);
+        evals += m;
+    }
+}
+
+// Atualiza pbest/gbest no modo ruidoso. Uma posio cuja primeira
+// amostra fica abaixo da mdia do pbest desafia o pbest numa corrida; o
+// gbest  o pbest de menor mdia e, quando muda de partcula, o novo
+// tambm precisa ganhar uma corrida do anterior.
+// Retorna a partcula do gbest.
+static int noise_update(pso_state_t *s) {
+    pso_settings_t *settings = s->settings;
+    pso_result_t *solution = s->solution;
+    double *tmp;
+    int i, k, nr = 0, g;
+
+    for (i=0; i<s->size; i++) {
+        if (s->fit[i] >= s->fit_b[i]) continue;
+        s->nc[i].n = 1;
+        s->nc[i].mean = s->fit[i];
+        s->nc[i].m2 = 0.0;
+        s->races[nr].a = &s->nc[i];
+        s->races[nr].b = &s->nb[i];
+        s->races[nr].xa = s->pos[i];
+        s->races[nr].xb = s->pos_b[i];
+        s->races[nr].result = 0;
+        s->race_idx[nr++] = i;
+    }
+    solution->evals += noise_run(s, s->races, nr);
+
+    for (k=0; k<nr; k++) {
+        if (s->races[k].result != 1) continue;
+        i = s->race_idx[k];
+        s->nb[i] = s->nc[i];
+        tmp = s->pos_b[i]; s->pos_b[i] = s->pos[i]; s->pos[i] = tmp;
+        s->at_b[i] = 1;
+    }
+
+    // mdias dos pbest (os atuais tambm foram reamostrados)
+    g = 0;
+    for (i=0; i<s->size; i++) {
+        s->fit_b[i] = s->nb[i].mean;
+        if (s->fit_b[i] < s->fit_b[g]) g = i;
+    }
+
+    if (g != s->g_best) {
+        int old = s->g_best;
+        noise_race_t r = { &s->nb[g], &s->nb[old], s->pos_b[g], s->pos_b[old], 0 };
+        solution->evals += noise_run(s, &r, 1);
+        s->fit_b[g] = s->nb[g].mean;
+        s->fit_b[old] = s->nb[old].mean;
+        if (r.result != 1) g = old;
+    }
+
+    // o gbest  o valor reportado: completa as amostras dele (a mdia de
+    // quem venceu corridas tende a ser otimista)
+    while (s->nb[g].n < settings->noise_samples) {
+        int m = settings->noise_samples - s->nb[g].n;
+        if (m > s->size) m = s->size;
+        for (k=0; k<m; k++) s->sx[k] = s->pos_b[g];
+        evaluate_list(s, s->sx, m, s->sf);
+        for (k=0; k<m; k++) noise_add(&s->nb[g], s->sf[k]);
+        solution->evals += m;
+    }
+    s->fit_b[g] = s->nb[g].mean;
+
+    if (s->fit_b[g] < solution->error) s->improved = 1;
+    solution->error = s->fit_b[g];
+    s->g_best = g;
+    return g;
+}
+
+
+//              MULTI-FIDELIDADE
+
+// Peso de cada diferena nova na mdia mvel (a diferena entre degraus
+// muda conforme o enxame converge: o que vale  a recente)
+#define PSO_FIDELITY_ALPHA 0.05
+
+static void fidelity_add(fidelity_delta_t *d, double x) {
+    if (d->n++ == 0) {
+        d->mean = x;
+        d->var = 0.0;
+        return;
+    }
+    double diff = x - d->mean;
+    d->mean += PSO_FIDELITY_ALPHA * diff;
+    d->var = (1.0 - PSO_FIDELITY_ALPHA) * (d->var + PSO_FIDELITY_ALPHA * diff * diff);
+}
+
+// A posio avaliada com valor f no degrau k ainda pode bater fit_b?
+// (at haver algumas diferenas medidas, sobe sempre). Uma previso que
+// empata com o pbest (partcula parada sobre ele) no sobe.
+static int fidelity_promising(const fidelity_delta_t *d, double z,
+                              double f, double fit_b) {
+    if (d->n < 8) return 1;
+    double bound = f + d->mean - z * sqrt(d->var);
+    return bound < fit_b - 1e-9 * (1.0 + fabs(fit_b));
+}
 
-    int i, d, step;
-    double a, b;       // usados na inicializao (posio/velocidade)
+// Avalia as posies novas subindo a escada: todas no degrau 0, e a cada
+// degrau s as que ainda prometem. fit[i] recebe o valor do topo, ou
+// DBL_MAX se a posio parou antes (no vira pbest).
+static void fidelity_evaluate(pso_state_t *s) {
+    pso_result_t *solution = s->solution;
+    int top = s->nlevels - 1, i, k, m = 0;
+
+    for (i=0; i<s->size; i++) {
+        s->fit[i] = DBL_MAX;
+        s->sx[m] = s->pos[i];
+        s->fidx[m++] = i;
+    }
+
+    for (int lv=0; m > 0; lv++) {
+        s->plain.fun = s->ladder[lv].fun;
+        s->plain.params = s->ladder[lv].params;
+        evaluate_list(s, s->sx, m, s->sf);
+        solution->evals += m;
+        solution->evals_level[lv] += m;
+        solution->cost += m * s->ladder[lv].cost;
+
+        if (lv == top) {
+            // chegaram ao topo: mede a diferena para cada degrau abaixo
+            for (k=0; k<m; k++) {
+                i = s->fidx[k];
+                s->fit[i] = s->sf[k];
+                for (int l=0; l<top; l++)
+                    fidelity_add(&s->delta[l], s->sf[k] - s->flev[l][i]);
+            }
+            break;
+        }
+
+        int next = 0;
+        for (k=0; k<m; k++) {
+            i = s->fidx[k];
+            s->flev[lv][i] = s->sf[k];
+            if (fidelity_promising(&s->delta[lv], s->ladder[lv].z, s->sf[k], s->fit_b[i])) {
+                s->sx[next] = s->pos[i];
+                s->fidx[next++] = i;
+            }
+        }
+        m = next;
+    }
+
+    // reamostragens (noise_samples) usam sempre o topo
+    s->plain.fun = s->ladder[top].fun;
+    s->plain.params = s->ladder[top].params;
+}
+
+
+//              REDUO DO ENXAME
+
+// PSO_SIZE_ADAPTIVE: passos seguidos sem melhorar o gbest antes de tirar
+// mais uma partcula
+#define PSO_SIZE_STALL 10
+
+// Divide as s->size partculas ativas em blocos de avaliao: ~4 por
+// thread para equilibrar a carga (refeito quando o enxame diminui)
+static void state_chunks(pso_state_t *s) {
+    int chunk = s->size;
+
+    if (s->nparts > 0) {
+        // modo NUMA: um bloco por thread, sempre na mesma (depois de uma
+        // reduo, parte das linhas de um bloco pode vir de outro n)
+        s->nchunks = s->nparts;
+        for (int k=0; k<s->nparts; k++) {
+            s->parts[k].lo = s->chunks[k].lo = (int)((long)k * s->size / s->nparts);
+            s->parts[k].hi = s->chunks[k].hi = (int)((long)(k+1) * s->size / s->nparts);
+            s->chunks[k].slot = s->parts[k].slot;
+        }
+        return;
+    }
+    if (s->pool != NULL) {
+        chunk = s->size / (4 * pso_pool_threads(s->pool));
+        if (chunk < 1) chunk = 1;
+    }
+    s->nchunks = (s->size + chunk - 1) / chunk;
+    for (int k=0; k<s->nchunks; k++) {
+        s->chunks[k].lo = k * chunk;
+        s->chunks[k].hi = (k+1) * chunk < s->size ? (k+1) * chunk : s->size;
+        s->chunks[k].slot = -1;
+    }
+}
+
+// Move as linhas marcadas em drop para o fim de m[0..size), mantendo a
+// ordem das demais
+static void compact_rows(double **m, const char *drop, int size, double **tmp) {
+    int j = 0, t = 0;
+
+    for (int i=0; i<size; i++) {
+        if (drop[i]) tmp[t++] = m[i];
+        else m[j++] = m[i];
+    }
+    memcpy(m + j, tmp, t * sizeof(double *));
+}
+
+// Deixa s n partculas: saem as de pior pbest (nunca a do gbest, g).
+// As que ficam mantm a ordem, ento no anel cada uma s troca os
+// vizinhos que saram. Retorna o novo ndice de g.
+static int swarm_shrink(pso_state_t *s, int n, int g) {
+    pso_settings_t *settings = s->settings;
+    int i, j, r;
+
+    memset(s->drop, 0, s->size);
+    for (r=s->size-n; r>0; r--) {
+        int worst = -1;
+        for (i=0; i<s->size; i++)
+            if (!s->drop[i] && i != g && (worst < 0 || s->fit_b[i] >= s->fit_b[worst]))
+                worst = i;
+        s->drop[worst] = 1;
+    }
+
+    // pos_nb  refeito a cada passo (inform) e fit s vale no passo
+    compact_rows(s->pos, s->drop, s->size, s->rows);
+    compact_rows(s->vel, s->drop, s->size, s->rows);
+    compact_rows(s->pos_b, s->drop, s->size, s->rows);
+    for (i=0, j=0; i<s->size; i++) {
+        if (s->drop[i]) continue;
+        if (i == g) g = j;
+        s->fit_b[j] = s->fit_b[i];
+        s->at_b[j] = s->at_b[i];
+        if (s->nb != NULL) s->nb[j] = s->nb[i];
+        j++;
+    }
+    s->size = n;
+    state_chunks(s);
+
+    switch (settings->nhood_strategy) {
+        case PSO_NHOOD_RING:
+            init_comm_ring(s->comm, n);
+            break;
+        case PSO_NHOOD_RANDOM:
+            init_comm_random(s->comm, &s->rng, s->step, n, settings);
+            break;
+    }
+    return g;
+}
+
+// Aplica settings->size_strategy depois do passo atual:
+// - linear: o tamanho cai de settings->size at size_min no ltimo passo;
+// - adaptativa: o enxame perde uma partcula a cada PSO_SIZE_STALL passos
+//   sem melhora do gbest (enquanto h progresso, o tamanho se mantm).
+static void swarm_resize(pso_state_t *s) {
+    pso_settings_t *settings = s->settings;
+    int lo = settings->size_min > 2 ? settings->size_min : 2;
+    int g = 0, n = s->size;
+    int improved = s->improved || s->apso_improved;
+
+    s->apso_improved = 0;
+    if (lo >= s->size) return;
+
+    if (settings->size_strategy == PSO_SIZE_LIN_DEC) {
+        double frac = 1.0 - (double)(s->step + 1) / settings->steps;
+        if (frac < 0.0) frac = 0.0;
+        n = lo + (int)((settings->size - lo) * frac + 0.5);
+    } else if (settings->size_strategy == PSO_SIZE_ADAPTIVE) {
+        s->stall = improved ? 0 : s->stall + 1;
+        if (s->stall >= PSO_SIZE_STALL) {
+            s->stall = 0;
+            n--;
+        }
+    }
+    if (n >= s->size) return;
+
+    // partcula do gbest (no modo ruidoso, a que venceu as corridas)
+    if (s->nb != NULL) g = s->g_best;
+    else for (int i=1; i<s->size; i++) if (s->fit_b[i] < s->fit_b[g]) g = i;
+
+    s->g_best = swarm_shrink(s, n, g);
+}
+
+
+//        APSO (ESTIMAO DO ESTADO EVOLUTIVO)
+
+// Estados evolutivos, na ordem em que o enxame costuma passar por eles
+#define APSO_EXPLORE  0
+#define APSO_EXPLOIT  1
+#define APSO_CONVERGE 2
+#define APSO_JUMP     3
+
+// acc[j] += (row[j] - xi)^2 para j < m (iteraes independentes: com
+// -O3 o compilador vetoriza)
+static void apso_sqdist(double *restrict acc, const double *restrict row,
+                        double xi, int m) {
+    for (int j=0; j<m; j++) {
+        double t = row[j] - xi;
+        acc[j] += t * t;
+    }
+}
+
+// Fator evolutivo f = (d_g - d_min) / (d_max - d_min), onde d_i  a
+// distncia mdia da partcula i s demais e g  a partcula do gbest.
+// As distncias saem de uma nica passada sobre as posies transpostas:
+// para cada i, as distncias a todas as j > i so acumuladas juntas,
+// dimenso por dimenso (apso_sqdist), e cada raiz conta para d_i e d_j
+// (a matriz  simtrica: metade do trabalho).
+static double apso_factor(pso_state_t *s, int g) {
+    const int n = s->size, dim = s->settings->dim;
+    double *xt = s->xt, *acc = s->acc, *dist = s->dist;
+    double dmin, dmax;
+    int i, j, d;
+
+    for (i=0; i<n; i++) {
+        const double *x = s->at_b[i] ? s->pos_b[i] : s->pos[i];
+        for (d=0; d<dim; d++) xt[d*n + i] = x[d];
+        dist[i] = 0.0;
+    }
+
+    for (i=0; i<n-1; i++) {
+        const int m = n - i - 1;
+        for (j=0; j<m; j++) acc[j] = 0.0;
+        for (d=0; d<dim; d++)
+            apso_sqdist(acc, xt + d*n + i + 1, xt[d*n + i], m);
+        double sum = 0.0;
+        for (j=0; j<m; j++) {
+            double r = sqrt(acc[j]);
+            sum += r;
+            dist[i + 1 + j] += r;
+        }
+        dist[i] += sum;
+    }
+
+    dmin = dmax = dist[0];
+    for (i=1; i<n; i++) {
+        if (dist[i] < dmin) dmin = dist[i];
+        if (dist[i] > dmax) dmax = dist[i];
+    }
+    // (o fator 1/(n-1) da mdia se cancela na razo)
+    return dmax > dmin ? (dist[g] - dmin) / (dmax - dmin) : 0.0;
+}
+
+// Classificao difusa de f (funes de pertinncia do artigo). Nas
+// faixas de transio vale a sequncia explorao -> aproveitamento ->
+// convergncia -> fuga -> explorao: fica no estado anterior enquanto
+// ele ainda  possvel, seno passa ao seguinte.
+static int apso_classify(double f, int prev) {
+    double mu[4];
+    int k, best = 0;
+
+    mu[APSO_EXPLORE]  = f <= 0.4 ? 0.0 : f <= 0.6 ? 5*f - 2 : f <= 0.7 ? 1.0
+                      : f <= 0.8 ? -10*f + 8 : 0.0;
+    mu[APSO_EXPLOIT]  = f <= 0.2 ? 0.0 : f <= 0.3 ? 10*f - 2 : f <= 0.4 ? 1.0
+                      : f <= 0.6 ? -5*f + 3 : 0.0;
+    mu[APSO_CONVERGE] = f <= 0.1 ? 1.0 : f <= 0.3 ? -5*f + 1.5 : 0.0;
+    mu[APSO_JUMP]     = f <= 0.7 ? 0.0 : f <= 0.9 ? 5*f - 3.5 : 1.0;
+
+    if (mu[prev] > 0) return prev;
+    if (mu[(prev + 1) % 4] > 0) return (prev + 1) % 4;
+    for (k=1; k<4; k++) if (mu[k] > mu[best]) best = k;
+    return best;
+}
+
+// Perturbao elitista (estado de convergncia): uma dimenso do gbest
+// recebe um passo gaussiano, com desvio que cai de 1 a 0,1 da largura do
+// domnio ao longo dos steps. Se a candidata for melhor vira o gbest;
+// seno toma o lugar da pior partcula (que passa a explorar em volta do
+// gbest).
+static void apso_elitist(pso_state_t *s, int g) {
+    pso_settings_t *settings = s->settings;
+    pso_result_t *solution = s->solution;
+    double u, v, f, sigma;
+    int d, worst = g, top = s->nlevels - 1;
+
+    pso_rng_draw2(&s->rng, s->step, 1, 0, PSO_RNG_APSO, &u, &v);
+    sigma = 1.0 - 0.9 * s->step / settings->steps;
+    pso_rng_draw2(&s->rng, s->step, 2, 0, PSO_RNG_APSO, &f, &v);
+    d = (int)(f * settings->dim);
+
+    memmove((void *)s->els, (void *)s->pos_b[g], sizeof(double) * settings->dim);
+    s->els[d] += (settings->range_hi[d] - settings->range_lo[d]) * sigma *
+                 sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * v);
+    if (s->els[d] < settings->range_lo[d]) s->els[d] = settings->range_lo[d];
+    if (s->els[d] > settings->range_hi[d]) s->els[d] = settings->range_hi[d];
+
+    evaluate_list(s, &s->els, 1, &f);
+    solution->evals++;
+    if (top >= 0) {
+        solution->evals_level[top]++;
+        solution->cost += s->ladder[top].cost;
+    }
+
+    if (f < s->fit_b[g]) {
+        // a posio atual de g deixa de ser o pbest: vai para o buffer livre
+        if (s->at_b[g]) {
+            memmove((void *)s->pos[g], (void *)s->pos_b[g], sizeof(double) * settings->dim);
+            s->at_b[g] = 0;
+        }
+    } else {
+        for (int i=0; i<s->size; i++)
+            if (i != g && (worst == g || s->fit_b[i] > s->fit_b[worst])) worst = i;
+        if (worst == g) return;
+        s->at_b[worst] = 1;
+        g = worst;
+    }
+    memmove((void *)s->pos_b[g], (void *)s->els, sizeof(double) * settings->dim);
+    s->fit_b[g] = f;
+
+    if (f < solution->error) {
+        solution->error = f;
+        memmove((void *)solution->gbest, (void *)s->els, sizeof(double) * settings->dim);
+        s->improved = 1;
+        // improved  zerado depois do inform; a reduo do enxame olha esta
+        s->apso_improved = 1;
+    }
+}
+
+// Estima o estado do enxame e ajusta w, c1 e c2 para o passo atual
+static void apso_adapt(pso_state_t *s) {
+    double f, d1, d2, sum;
+    int g = 0;
+
+    for (int i=1; i<s->size; i++) if (s->fit_b[i] < s->fit_b[g]) g = i;
+    f = apso_factor(s, g);
+    s->ese = apso_classify(f, s->ese);
+
+    // w em [0,4; 0,9]: alto explorando, baixo convergindo
+    s->w = 1.0 / (1.0 + 1.5 * exp(-2.6 * f));
+
+    // acelerao: passo sorteado em [0,05; 0,1] (metade nos estados
+    // intermedirios)
+    pso_rng_draw2(&s->rng, s->step, 0, 0, PSO_RNG_APSO, &d1, &d2);
+    d1 = 0.05 + 0.05 * d1;
+    d2 = 0.05 + 0.05 * d2;
+    switch (s->ese) {
+        case APSO_EXPLORE:  s->c1 += d1;       s->c2 -= d2;       break;
+        case APSO_EXPLOIT:  s->c1 += 0.5 * d1; s->c2 -= 0.5 * d2; break;
+        case APSO_CONVERGE: s->c1 += 0.5 * d1; s->c2 += 0.5 * d2; break;
+        case APSO_JUMP:     s->c1 -= d1;       s->c2 += d2;       break;
+    }
+    if (s->c1 < 1.5) s->c1 = 1.5;
+    if (s->c1 > 2.5) s->c1 = 2.5;
+    if (s->c2 < 1.5) s->c2 = 1.5;
+    if (s->c2 > 2.5) s->c2 = 2.5;
+    sum = s->c1 + s->c2;
+    if (sum > 4.0) {
+        s->c1 *= 4.0 / sum;
+        s->c2 *= 4.0 / sum;
+    }
+
+    // (no modo ruidoso uma nica amostra no decide contra o gbest)
+    if (s->ese == APSO_CONVERGE && s->nb == NULL)
+        apso_elitist(s, g);
+}
+
+
+// Fronteira de fase para os contadores (settings->perf, pso_perf.h)
+static void phase(pso_state_t *s, int ph) {
+    if (s->settings->perf != NULL) pso_perf_phase(s->settings->perf, ph);
+}
+
+
+//        PGINA DE MTRICAS (MONITORAMENTO EXTERNO)
+
+// Distncia mdia das posies atuais ao centroide do enxame
+static double swarm_diversity(pso_state_t *s) {
+    const int dim = s->settings->dim;
+    double *c = s->centroid, *x, sum = 0.0;
+    int i, d;
+
+    memset(c, 0, dim * sizeof(double));
+    for (i=0; i<s->size; i++) {
+        x = s->at_b[i] ? s->pos_b[i] : s->pos[i];
+        for (d=0; d<dim; d++) c[d] += x[d];
+    }
+    for (d=0; d<dim; d++) c[d] /= s->size;
+
+    for (i=0; i<s->size; i++) {
+        double dist = 0.0;
+        x = s->at_b[i] ? s->pos_b[i] : s->pos[i];
+        for (d=0; d<dim; d++) dist += (x[d] - c[d]) * (x[d] - c[d]);
+        sum += sqrt(dist);
+    }
+    return sum / s->size;
+}
+
+// Publica o estado do passo na pgina (s escritas na memria
+// compartilhada; a diversidade  recalculada de tempos em tempos)
+static void metrics_publish(pso_state_t *s) {
+    pso_settings_t *settings = s->settings;
+    pso_metrics_snapshot_t m;
+
+    if (s->step % PSO_METRICS_DIVERSITY_EVERY == 0 || s->done)
+        s->diversity = swarm_diversity(s);
+
+    memset(&m, 0, sizeof(m));
+    m.done = s->done;
+    m.dim = settings->dim;
+    m.size = s->size;
+    m.nthreads = s->pool ? pso_pool_threads(s->pool) : 0;
+    m.step = s->step;
+    m.steps = settings->steps;
+    m.evals = s->solution->evals;
+    m.best = s->solution->error;
+    m.w = s->w;
+    m.diversity = s->diversity;
+    if (s->pool != NULL)
+        pso_pool_states(s->pool, m.thread_state, PSO_METRICS_MAX_THREADS);
+    pso_metrics_publish(settings->metrics, &m);
+}
+
+// marca o fim da otimizao
+static void state_finish(pso_state_t *s) {
+    s->done = 1;
+    // garante que o prompt no fique "colado" na barra
+    if (s->progress_used) printf("\n");
+}
+
+
+//        PARTCULAS (SERIAL OU POR BLOCO NUMA)
+
+// Posio e velocidade iniciais da partcula i (u1/u2: rea dos sorteios
+// de quem chama)
+static void init_particle(pso_state_t *s, int i, double *u1, double *u2) {
+    pso_settings_t *settings = s->settings;
+    double a, b;
+
+    pso_rng_block(&s->rng, 0, i, PSO_RNG_INIT, settings->dim, u1, u2);
+    for (int d=0; d<settings->dim; d++) {
+        // sorteia dois valores no intervalo [range_lo, range_hi]
+        a = settings->range_lo[d] + (settings->range_hi[d] - settings->range_lo[d]) * u1[d];
+        b = settings->range_lo[d] + (settings->range_hi[d] - settings->range_lo[d]) * u2[d];
+
+        // posio inicial (pbest comea igual a ela: fica direto em pos_b)
+        s->pos_b[i][d] = a;
+
+        // velocidade inicial (diferena entre dois pontos / 2)
+        s->vel[i][d] = (a-b) / 2.0;
+    }
+
+    s->at_b[i] = 1;
+}
+
+// Atualiza velocidade e posio da partcula i no passo atual
+static void update_particle(pso_state_t *s, int i, double *u1, double *u2) {
+    pso_settings_t *settings = s->settings;
+    double *pos = s->pos[i], *vel = s->vel[i], *pos_b = s->pos_b[i];
+    double *pos_nb = s->pos_nb[i];
+    double *x;         // posio atual (pos[i] ou pos_b[i])
     double rho1, rho2; // coeficientes aleatrios
-    double w = PSO_INERTIA; // inrcia atual
+    double w = s->w;
+
+    // posio atual: em pos_b[i] se a partcula acabou de melhorar
+    // (a nova posio  sempre escrita em pos[i])
+    x = s->at_b[i] ? pos_b : pos;
+    s->at_b[i] = 0;
+
+    // todos os sorteios da partcula de uma vez
+    pso_rng_block(&s->rng, s->step, i, PSO_RNG_UPDATE, settings->dim, u1, u2);
+
+    for (int d=0; d<settings->dim; d++) {
+        // coeficientes estocsticos
+        rho1 = s->c1 * u1[d];
+        rho2 = s->c2 * u2[d];
+
+        // atualizao de velocidade (frmula)
+        vel[d] = w * vel[d]
+            + rho1 * (pos_b[d] - x[d])
+            + rho2 * (pos_nb[d] - x[d]);
+
+        // APSO: velocidade limitada a 20% do domnio (c1 + c2 chega
+        // a 4, sem o fator de constrio)
+        if (s->xt != NULL) {
+            double vmax = 0.2 * (settings->range_hi[d] - settings->range_lo[d]);
+            if (vel[d] > vmax) vel[d] = vmax;
+            else if (vel[d] < -vmax) vel[d] = -vmax;
+        }
 
-    inform_fun_t  inform_fun = NULL;     // funo de vizinhana
-    inertia_fun_t calc_inertia_fun = NULL; // funo de inrcia
+        // atualizao de posio
+        pos[d] = x[d] + vel[d];
+
+        // tratamento de limites
+        if (settings->clamp_pos) {
+            // CLAMP: trava nas bordas e zera velocidade na dimenso
+            if (pos[d] < settings->range_lo[d]) {
+                pos[d] = settings->range_lo[d];
+                vel[d] = 0;
+            } else if (pos[d] > settings->range_hi[d]) {
+                pos[d] = settings->range_hi[d];
+                vel[d] = 0;
+            }
+        } else {
+            // PERIDICO: volta quando ultrapassa limites
+            if (pos[d] < settings->range_lo[d]) {
+                pos[d] = settings->range_hi[d] - fmod(settings->range_lo[d] - pos[d],
+                                                      settings->range_hi[d] - settings->range_lo[d]);
+                vel[d] = 0;
+            } else if (pos[d] > settings->range_hi[d]) {
+                pos[d] = settings->range_lo[d] + fmod(pos[d] - settings->range_hi[d],
+                                                      settings->range_hi[d] - settings->range_lo[d]);
+                vel[d] = 0;
+            }
+        }
+    }
+}
 
-    // semente aleatria
-    srand(time(NULL));
+// Tarefa da dona do bloco: aloca e inicializa as linhas das partculas.
+// O memset toca todas as pginas aqui (first-touch: elas ficam no n da
+// thread), inclusive as de pos e pos_nb, escritas s mais tarde.
+static void numa_init(void *arg) {
+    numa_part_t *p = (numa_part_t *)arg;
+    pso_state_t *s = p->s;
+    int dim = s->settings->dim, n = p->hi - p->lo;
+    size_t bytes = (size_t)4 * n * dim * sizeof(double);
+
+    p->u1 = (double *)malloc(dim * sizeof(double));
+    p->u2 = (double *)malloc(dim * sizeof(double));
+    p->slab = (double *)malloc(bytes);
+    if (p->u1 == NULL || p->u2 == NULL || p->slab == NULL) {
+        // sem memria: slab = NULL avisa state_new, que desiste
+        free(p->u1); free(p->u2); free(p->slab);
+        p->u1 = p->u2 = p->slab = NULL;
+        return;
+    }
+    memset(p->slab, 0, bytes);
+
+    // as quatro linhas de cada partcula lado a lado
+    for (int i=p->lo; i<p->hi; i++) {
+        double *row = p->slab + (size_t)4 * (i - p->lo) * dim;
+        s->pos[i]    = row;
+        s->vel[i]    = row + dim;
+        s->pos_b[i]  = row + 2 * dim;
+        s->pos_nb[i] = row + 3 * dim;
+        init_particle(s, i, p->u1, p->u2);
+    }
+}
+
+static void numa_update(void *arg) {
+    numa_part_t *p = (numa_part_t *)arg;
+    uint64_t t0 = pso_trace_begin();
+
+    for (int i=p->lo; i<p->hi; i++)
+        update_particle(p->s, i, p->u1, p->u2);
+    pso_trace_end("update", t0, p->hi - p->lo);
+}
+
+// Roda fun em cada bloco, na thread dona (pso_pool_spawn_to)
+static void numa_run(pso_state_t *s, pso_task_fun_t fun) {
+    pso_task_group_t group;
+
+    pso_task_group_init(&group);
+    for (int k=0; k<s->nparts; k++)
+        if (s->parts[k].lo < s->parts[k].hi)
+            pso_pool_spawn_to(s->pool, &group, s->parts[k].slot, fun, &s->parts[k]);
+    pso_pool_sync(s->pool, &group);
+}
+
+// Aloca o estado e avalia o enxame inicial.
+// plain != NULL: obj usa o adaptador obj_plain_cut, guardado no estado.
+static pso_state_t *state_new(const objective_t *obj, const obj_plain_t *plain,
+                              pso_result_t *solution, pso_settings_t *settings)
+{
+    pso_state_t *s = (pso_state_t *)malloc(sizeof(pso_state_t));
+    if (s == NULL) return NULL;
+
+    int i, g = 0;
+
+    s->obj = *obj;
+    if (plain != NULL) {
+        s->plain = *plain;
+        s->obj.params = &s->plain;
+    }
+    s->solution = solution;
+    s->settings = settings;
+
+    s->at_b   = (char *)malloc(settings->size * sizeof(char));
+    s->fit    = (double *)malloc(settings->size * sizeof(double));
+    s->fit_b  = (double *)malloc(settings->size * sizeof(double));
+    s->comm   = (int *)malloc(settings->size * settings->size * sizeof(int));
+
+    s->improved = 0;
+    s->size = settings->size;
+    s->stall = 0;
+    s->apso_improved = 0;
+    s->drop = (char *)malloc(settings->size * sizeof(char));
+    s->rows = (double **)malloc(settings->size * sizeof(double *));
+    s->step = 0;
+    s->done = 0;
+    s->progress_used = 0;
+    s->w = PSO_INERTIA;
+    s->c1 = settings->c1;
+    s->c2 = settings->c2;
+    s->xt = s->dist = s->acc = s->els = NULL;
+    s->centroid = NULL;
+    s->shared_pos = settings->shared_best != NULL
+                  ? (double *)malloc(settings->dim * sizeof(double)) : NULL;
+    s->diversity = 0.0;
+
+    // semente 0 = relgio
+    s->rng = pso_rng_new(settings->seed ? settings->seed
+                         : (uint64_t)time(NULL));
+
+    s->u1 = (double *)malloc(settings->dim * sizeof(double));
+    s->u2 = (double *)malloc(settings->dim * sizeof(double));
+
+    s->pool = settings->pool;
+    s->own_pool = 0;
+    if (s->pool == NULL && settings->threads > 1) {
+        int *cpus = settings->cpu_affinity;
+
+        // modo NUMA: threads fixadas, distribudas pelos ns
+        if (settings->numa && cpus == NULL &&
+            (cpus = (int *)malloc(settings->threads * sizeof(int))) != NULL)
+            pso_numa_layout(settings->threads, cpus, NULL);
+        s->pool = pso_pool_new(settings->threads, cpus);
+        s->own_pool = (s->pool != NULL);
+        if (cpus != settings->cpu_affinity) free(cpus);
+    }
+
+    // partio NUMA: um bloco por thread (no mximo um por partcula); as
+    // linhas so alocadas pelas donas dos blocos (numa_init)
+    s->parts = NULL;
+    s->nparts = 0;
+    if (settings->numa && s->own_pool) {
+        s->nparts = settings->threads < settings->size ? settings->threads : settings->size;
+        s->parts = (numa_part_t *)calloc(s->nparts, sizeof(numa_part_t));
+        if (s->parts == NULL) s->nparts = 0;   // segue sem partio
+    }
+    if (s->nparts > 0) {
+        for (int k=0; k<s->nparts; k++) {
+            s->parts[k].s = s;
+            s->parts[k].slot = k;
+        }
+        s->pos    = (double **)malloc(settings->size * sizeof(double *));
+        s->vel    = (double **)malloc(settings->size * sizeof(double *));
+        s->pos_b  = (double **)malloc(settings->size * sizeof(double *));
+        s->pos_nb = (double **)malloc(settings->size * sizeof(double *));
+    } else {
+        s->pos    = pso_matrix_new(settings->size, settings->dim);
+        s->vel    = pso_matrix_new(settings->size, settings->dim);
+        s->pos_b  = pso_matrix_new(settings->size, settings->dim);
+        s->pos_nb = pso_matrix_new(settings->size, settings->dim);
+    }
+
+    // blocos de avaliao (no mximo um por partcula)
+    s->chunks = (eval_chunk_t *)malloc(settings->size * sizeof(eval_chunk_t));
+    for (int k=0; k<settings->size; k++) {
+        s->chunks[k].obj = &s->obj;
+        s->chunks[k].fit = s->fit;
+        s->chunks[k].dim = settings->dim;
+        s->chunks[k].latency = settings->latency;
+    }
+    state_chunks(s);
+
+    // objetivo ruidoso: amostras por pbest e rea das corridas
+    s->nb = s->nc = NULL;
+    s->races = NULL;
+    s->race_idx = NULL;
+    s->sx = NULL;
+    s->sst = NULL;
+    s->sf = NULL;
+    s->g_best = 0;
+    s->nlevels = 0;
+    s->fidx = NULL;
+    if (settings->noise_samples > 1) {
+        s->nb       = (noise_stat_t *)calloc(settings->size, sizeof(noise_stat_t));
+        s->nc       = (noise_stat_t *)calloc(settings->size, sizeof(noise_stat_t));
+        s->races    = (noise_race_t *)malloc(settings->size * sizeof(noise_race_t));
+        s->race_idx = (int *)malloc(settings->size * sizeof(int));
+        s->sx       = (double **)malloc(settings->size * sizeof(double *));
+        s->sst      = (noise_stat_t **)malloc(settings->size * sizeof(noise_stat_t *));
+        s->sf       = (double *)malloc(settings->size * sizeof(double));
+    }
 
 
     // Escolhe a estratgia de vizinhana
 
     switch (settings->nhood_strategy) {
         case PSO_NHOOD_GLOBAL:
-            inform_fun = inform_global;
+            s->inform_fun = inform_global;
             break;
         case PSO_NHOOD_RING:
-            init_comm_ring(comm, settings);
-            inform_fun = inform_ring;
+            init_comm_ring(s->comm, settings->size);
+            s->inform_fun = inform_ring;
             break;
         case PSO_NHOOD_RANDOM:
-            init_comm_random(comm, settings);
-            inform_fun = inform_random;
+            init_comm_random(s->comm, &s->rng, -1, settings->size, settings);
+            s->inform_fun = inform_random;
             break;
         default:
-            inform_fun = inform_global;
+            s->inform_fun = inform_global;
             break;
     }
 
@@ -334,151 +1419,372 @@ void pso_solve(pso_obj_fun_t obj_fun, void *obj_fun_params,
 
     switch (settings->w_strategy) {
         case PSO_W_LIN_DEC:
-            calc_inertia_fun = calc_inertia_lin_dec;
+            s->calc_inertia_fun = calc_inertia_lin_dec;
+            break;
+        case PSO_W_APSO:
+            // w, c1 e c2 so ajustados por apso_adapt a cada passo
+            s->calc_inertia_fun = NULL;
+            s->w = 0.9;
+            s->c1 = s->c2 = 2.0;
+            s->ese = APSO_EXPLORE;
+            s->xt   = (double *)malloc(settings->size * settings->dim * sizeof(double));
+            s->dist = (double *)malloc(settings->size * sizeof(double));
+            s->acc  = (double *)malloc(settings->size * sizeof(double));
+            s->els  = (double *)malloc(settings->dim * sizeof(double));
             break;
         default:
             // se no definido, fica como constante (w = PSO_INERTIA)
-            calc_inertia_fun = NULL;
+            s->calc_inertia_fun = NULL;
             break;
     }
 
-    // Inicializa soluo (gbest)
+    // Inicializa soluo (gbest) e estatsticas
     solution->error = DBL_MAX;
+    solution->evals = 0;
+    solution->evals_aborted = 0;
+    memset(solution->evals_level, 0, sizeof(solution->evals_level));
+    solution->cost = 0.0;
 
 
-    // Inicializao do enxame
-
-    for (i=0; i<settings->size; i++) {
-        for (d=0; d<settings->dim; d++) {
-            // sorteia dois valores no intervalo [range_lo, range_hi]
-            a = settings->range_lo[d] + (settings->range_hi[d] - settings->range_lo[d]) * RNG_UNIFORM();
-            b = settings->range_lo[d] + (settings->range_hi[d] - settings->range_lo[d]) * RNG_UNIFORM();
+    // Inicializao do enxame (no modo NUMA, cada bloco na thread dona)
 
-            // posio inicial
-            pos[i][d] = a;
+    if (s->nparts > 0) {
+        numa_run(s, numa_init);
+        for (int k=0; k<s->nparts; k++) {
+            if (s->parts[k].lo < s->parts[k].hi && s->parts[k].slab == NULL) {
+                pso_state_free(s);
+                return NULL;
+            }
+        }
+    } else {
+        for (i=0; i<settings->size; i++)
+            init_particle(s, i, s->u1, s->u2);
+    }
 
-            // pbest comea igual  posio inicial
-            pos_b[i][d] = a;
+    // calcula fitness inicial (sem pbest ainda: nada a cortar)
+    phase(s, PSO_PHASE_EVAL);
+    evaluate(s->pool, s->chunks, s->nchunks, s->pos_b, NULL);
+    solution->evals += settings->size;
+    phase(s, PSO_PHASE_BOOK);
 
-            // velocidade inicial (diferena entre dois pontos / 2)
-            vel[i][d] = (a-b) / 2.0;
+    for (i=0; i<settings->size; i++) {
+        s->fit_b[i] = s->fit[i];
+        if (s->nb != NULL) {
+            s->nb[i].n = 1;
+            s->nb[i].mean = s->fit[i];
         }
 
-        // calcula fitness inicial
-        fit[i] = obj_fun(pos[i], settings->dim, obj_fun_params);
-        fit_b[i] = fit[i];
-
-        // atualiza gbest se necessrio
-        if (fit[i] < solution->error) {
-            solution->error = fit[i];
-            memmove((void *)solution->gbest, (void *)pos[i],
-                    sizeof(double) * settings->dim);
+        // atualiza gbest se necessrio (s guarda o ndice)
+        if (s->fit[i] < solution->error) {
+            solution->error = s->fit[i];
+            g = i;
         }
     }
 
+    s->g_best = g;
 
-    // Loop principal
+    // publica o gbest uma nica vez
+    memmove((void *)solution->gbest, (void *)s->pos_b[g],
+            sizeof(double) * settings->dim);
+    share_best(solution, settings, s->shared_pos);
 
-    int progress_used = 0; 
+    if (settings->steps <= 0) state_finish(s);
+    if (settings->metrics != NULL) {
+        s->centroid = (double *)malloc(settings->dim * sizeof(double));
+        pso_metrics_begin_run(settings->metrics);
+        metrics_publish(s);
+    }
+    phase(s, PSO_PHASE_NONE);
+    return s;
+}
 
-    for (step=0; step<settings->steps; step++) {
-        // registra o passo atual (caso seja usado fora)
-        settings->step = step;
+// Executa um passo do loop principal
+static void state_iterate(pso_state_t *s) {
+    pso_settings_t *settings = s->settings;
+    pso_result_t *solution = s->solution;
+    double **pos = s->pos, **pos_b = s->pos_b;
+    double *fit = s->fit, *fit_b = s->fit_b;
+    char *at_b = s->at_b;
+    int step = s->step;
+
+    int i;
+    int g = -1;        // ndice da partcula com o melhor pbest (gbest)
+    double *tmp;       // troca de ponteiros (pbest)
+    double w;
+    uint64_t trace_step = pso_trace_begin(), trace_t0;
+
+    phase(s, PSO_PHASE_BOOK);
+
+    // registra o passo atual (caso seja usado fora)
+    settings->step = step;
+
+    // atualiza inrcia (se houver estratgia definida)
+    if (s->calc_inertia_fun != NULL) {
+        s->w = s->calc_inertia_fun(step, settings);
+    }
+    w = s->w;
 
-        // atualiza inrcia (se houver estratgia definida)
-        if (calc_inertia_fun != NULL) {
-            w = calc_inertia_fun(step, settings);
+    // critrio de parada: atingiu o objetivo (goal)
+    if (solution->error <= settings->goal) {
+        if (settings->print_every) {
+            if (s->progress_used) printf("\n");
+            printf("Goal achieved @ step %d (error=%.3e) :-)\n", step, solution->error);
         }
+        state_finish(s);
+        if (s->centroid != NULL) metrics_publish(s);
+        phase(s, PSO_PHASE_NONE);
+        pso_trace_end("step", trace_step, step);
+        return;
+    }
 
-        // critrio de parada: atingiu o objetivo (goal)
-        if (solution->error <= settings->goal) {
-            if (settings->print_every) {
-                if (progress_used) printf("\n");
-                printf("Goal achieved @ step %d (error=%.3e) :-)\n", step, solution->error);
-            }
-            break;
-        }
+    phase(s, PSO_PHASE_INFORM);
+    trace_t0 = pso_trace_begin();
 
-        // encontra o melhor vizinho (pos_nb) para cada partcula
-        inform_fun(comm, pos_nb, pos_b, fit_b, solution->gbest, improved, settings);
-        improved = 0; // reseta flag
-
-        // atualiza todas as partculas
-        for (i=0; i<settings->size; i++) {
-            for (d=0; d<settings->dim; d++) {
-                // coeficientes estocsticos
-                rho1 = settings->c1 * RNG_UNIFORM();
-                rho2 = settings->c2 * RNG_UNIFORM();
-
-                // atualizao de velocidade (frmula)
-                vel[i][d] = w * vel[i][d]
-                    + rho1 * (pos_b[i][d] - pos[i][d])
-                    + rho2 * (pos_nb[i][d] - pos[i][d]);
-
-                // atualizao de posio
-                pos[i][d] += vel[i][d];
-
-                // tratamento de limites
-                if (settings->clamp_pos) {
-                    // CLAMP: trava nas bordas e zera velocidade na dimenso
-                    if (pos[i][d] < settings->range_lo[d]) {
-                        pos[i][d] = settings->range_lo[d];
-                        vel[i][d] = 0;
-                    } else if (pos[i][d] > settings->range_hi[d]) {
-                        pos[i][d] = settings->range_hi[d];
-                        vel[i][d] = 0;
-                    }
-                } else {
-                    // PERIDICO: volta quando ultrapassa limites
-                    if (pos[i][d] < settings->range_lo[d]) {
-                        pos[i][d] = settings->range_hi[d] - fmod(settings->range_lo[d] - pos[i][d],
-                                                                 settings->range_hi[d] - settings->range_lo[d]);
-                        vel[i][d] = 0;
-                    } else if (pos[i][d] > settings->range_hi[d]) {
-                        pos[i][d] = settings->range_lo[d] + fmod(pos[i][d] - settings->range_hi[d],
-                                                                 settings->range_hi[d] - settings->range_lo[d]);
-                        vel[i][d] = 0;
-                    }
-                }
-            }
+    // APSO: estado do enxame -> w, c1, c2 (e perturbao do gbest)
+    if (s->xt != NULL) {
+        apso_adapt(s);
+        w = s->w;
+    }
+
+    // encontra o melhor vizinho (pos_nb) para cada partcula
+    s->inform_fun(s->comm, s->pos_nb, pos_b, fit_b, solution->gbest,
+                  s->improved, &s->rng, s->size, settings);
+    s->improved = 0; // reseta flag
+    pso_trace_end("inform", trace_t0, step);
+
+    phase(s, PSO_PHASE_UPDATE);
+
+    // atualiza todas as partculas (no modo NUMA, cada bloco na thread
+    // dona)
+    if (s->nparts > 0) {
+        numa_run(s, numa_update);
+    } else {
+        for (i=0; i<s->size; i++)
+            update_particle(s, i, s->u1, s->u2);
+    }
 
-            // avalia fitness na nova posio
-            fit[i] = obj_fun(pos[i], settings->dim, obj_fun_params);
+    // avalia fitness nas novas posies (em paralelo, se houver pool)
+    // cutoff = pbest: acima disso a avaliao pode ser abortada
+    // (no modo ruidoso no: toda avaliao  uma amostra)
+    phase(s, PSO_PHASE_EVAL);
+    if (s->nlevels > 0) {
+        fidelity_evaluate(s);
+    } else {
+        evaluate(s->pool, s->chunks, s->nchunks, pos, s->nb ? NULL : fit_b);
+        solution->evals += s->size;
+    }
+
+    phase(s, PSO_PHASE_BOOK);
+
+    // atualiza pbest/gbest: no modo ruidoso por corridas; seno serial,
+    // na ordem das partculas
+    if (s->nb != NULL) {
+        g = noise_update(s);
+    } else {
+        for (i=0; i<s->size; i++) {
+            if (fit[i] == PSO_FIT_ABORTED) solution->evals_aborted++;
 
             // atualiza pbest (melhor pessoal)
+            // (valor abortado  > fit_b[i] >= solution->error, logo
+            //  nunca passa nas comparaes abaixo)
             if (fit[i] < fit_b[i]) {
                 fit_b[i] = fit[i];
-                memmove((void *)pos_b[i], (void *)pos[i],
-                        sizeof(double) * settings->dim);
+                // troca de ponteiros: pos_b[i] passa a ser a posio nova
+                tmp = pos_b[i]; pos_b[i] = pos[i]; pos[i] = tmp;
+                at_b[i] = 1;
             }
 
-            // atualiza gbest (melhor global)
+            // atualiza gbest (melhor global): s guarda o ndice
+            // (quem melhora o gbest tambm melhorou o pbest => est em pos_b)
             if (fit[i] < solution->error) {
-                improved = 1;
+                s->improved = 1;
                 solution->error = fit[i];
-                memmove((void *)solution->gbest, (void *)pos[i],
-                        sizeof(double) * settings->dim);
+                g = i;
             }
         }
+    }
+
+    // publica o gbest uma vez por passo
+    if (g >= 0) {
+        memmove((void *)solution->gbest, (void *)pos_b[g],
+                sizeof(double) * settings->dim);
+        pso_trace_instant("gbest", step);
+    }
+    share_best(solution, settings, s->shared_pos);
+
+    // imprime progresso a cada N passos
+    if (settings->print_every && (step % settings->print_every == 0)) {
+        pso_print_progress_bar(step, settings->steps, w, solution->error);
+        s->progress_used = 1;
+    }
+
+    // reduz o enxame para o prximo passo
+    if (settings->size_strategy != PSO_SIZE_CONST) {
+        trace_t0 = pso_trace_begin();
+        swarm_resize(s);
+        pso_trace_end("resize", trace_t0, s->size);
+    }
+
+    s->step++;
+    if (s->step >= settings->steps) state_finish(s);
+    if (s->centroid != NULL) metrics_publish(s);
+    phase(s, PSO_PHASE_NONE);
+    pso_trace_end("step", trace_step, step);
+}
+
+
+//            API INCREMENTAL (PASSO A PASSO)
+
+pso_state_t *pso_state_new(pso_obj_fun_t obj_fun, void *obj_fun_params,
+                           pso_result_t *solution, pso_settings_t *settings)
+{
+    obj_plain_t plain = { obj_fun, obj_fun_params };
+    objective_t obj = { obj_plain_cut, NULL, NULL };
+    return state_new(&obj, &plain, solution, settings);
+}
+
+pso_state_t *pso_state_new_cut(pso_obj_fun_cut_t obj_fun, void *obj_fun_params,
+                               pso_result_t *solution, pso_settings_t *settings)
+{
+    objective_t obj = { obj_fun, NULL, obj_fun_params };
+    return state_new(&obj, NULL, solution, settings);
+}
 
-        // imprime progresso a cada N passos
-        if (settings->print_every && (step % settings->print_every == 0)) {
-            pso_print_progress_bar(step, settings->steps, w, solution->error);
-            progress_used = 1;
+pso_state_t *pso_state_new_batch(pso_obj_batch_fun_t obj_fun, void *obj_fun_params,
+                                 pso_result_t *solution, pso_settings_t *settings)
+{
+    objective_t obj = { NULL, obj_fun, obj_fun_params };
+    return state_new(&obj, NULL, solution, settings);
+}
+
+pso_state_t *pso_state_new_multi(const pso_fidelity_t *ladder, int nlevels,
+                                 pso_result_t *solution, pso_settings_t *settings)
+{
+    if (nlevels < 1 || nlevels > PSO_MAX_FIDELITY) return NULL;
+
+    // o enxame inicial  avaliado direto no topo
+    obj_plain_t plain = { ladder[nlevels-1].fun, ladder[nlevels-1].params };
+    objective_t obj = { obj_plain_cut, NULL, NULL };
+    pso_state_t *s = state_new(&obj, &plain, solution, settings);
+    if (s == NULL) return NULL;
+
+    memcpy(s->ladder, ladder, nlevels * sizeof(pso_fidelity_t));
+    s->nlevels = nlevels;
+    memset(s->delta, 0, sizeof(s->delta));
+    for (int k=0; k<PSO_MAX_FIDELITY; k++)
+        s->flev[k] = k < nlevels - 1 ? (double *)malloc(settings->size * sizeof(double)) : NULL;
+    s->fidx = (int *)malloc(settings->size * sizeof(int));
+    if (s->sx == NULL) {
+        s->sx = (double **)malloc(settings->size * sizeof(double *));
+        s->sf = (double *)malloc(settings->size * sizeof(double));
+    }
+    solution->evals_level[nlevels-1] = settings->size;
+    solution->cost = settings->size * ladder[nlevels-1].cost;
+    return s;
+}
+
+int pso_state_step(pso_state_t *state, int nsteps) {
+    for (int k=0; k<nsteps && !state->done; k++)
+        state_iterate(state);
+    return state->done;
+}
+
+int pso_state_done(const pso_state_t *state) {
+    return state->done;
+}
+
+int pso_state_steps_done(const pso_state_t *state) {
+    return state->step;
+}
+
+int pso_state_size(const pso_state_t *state) {
+    return state->size;
+}
+
+double pso_state_best(const pso_state_t *state) {
+    double best = state->fit_b[0];
+    for (int i=1; i<state->size; i++)
+        if (state->fit_b[i] < best) best = state->fit_b[i];
+    return best;
+}
+
+void pso_state_free(pso_state_t *s) {
+    if (s->nparts > 0) {
+        // linhas nos blocos das threads (numa_init)
+        for (int k=0; k<s->nparts; k++) {
+            free(s->parts[k].slab);
+            free(s->parts[k].u1);
+            free(s->parts[k].u2);
         }
+        free(s->parts);
+        free(s->pos);
+        free(s->vel);
+        free(s->pos_b);
+        free(s->pos_nb);
+    } else {
+        pso_matrix_free(s->pos, s->settings->size);
+        pso_matrix_free(s->vel, s->settings->size);
+        pso_matrix_free(s->pos_b, s->settings->size);
+        pso_matrix_free(s->pos_nb, s->settings->size);
     }
+    free(s->comm);
+    free(s->at_b);
+    free(s->drop);
+    free(s->rows);
+    free(s->xt);
+    free(s->dist);
+    free(s->acc);
+    free(s->els);
+    free(s->centroid);
+    free(s->shared_pos);
+    free(s->u1);
+    free(s->u2);
+    free(s->chunks);
+    if (s->own_pool) pso_pool_free(s->pool);
+    free(s->fit);
+    free(s->fit_b);
+    free(s->nb);
+    free(s->nc);
+    free(s->races);
+    free(s->race_idx);
+    free(s->sx);
+    free(s->sst);
+    free(s->sf);
+    for (int k=0; k<s->nlevels; k++) free(s->flev[k]);
+    free(s->fidx);
+    free(s);
+}
 
-    // garante que o prompt no fique "colado" na barra
-    if (progress_used) printf("\n");
 
+//              EXECUO COMPLETA (PSO_SOLVE)
+
+// Roda a otimizao inteira sobre o estado incremental
+static void solve_state(pso_state_t *state) {
+    if (state == NULL) return;
+    pso_state_step(state, state->settings->steps);
+    pso_state_free(state);
+}
+
+void pso_solve(pso_obj_fun_t obj_fun, void *obj_fun_params,
+               pso_result_t *solution, pso_settings_t *settings)
+{
+    solve_state(pso_state_new(obj_fun, obj_fun_params, solution, settings));
+}
+
+void pso_solve_cut(pso_obj_fun_cut_t obj_fun, void *obj_fun_params,
+                   pso_result_t *solution, pso_settings_t *settings)
+{
+    solve_state(pso_state_new_cut(obj_fun, obj_fun_params, solution, settings));
+}
 
-    // Libera memria
+void pso_solve_batch(pso_obj_batch_fun_t obj_fun, void *obj_fun_params,
+                     pso_result_t *solution, pso_settings_t *settings)
+{
+    solve_state(pso_state_new_batch(obj_fun, obj_fun_params, solution, settings));
+}
 
-    pso_matrix_free(pos, settings->size);
-    pso_matrix_free(vel, settings->size);
-    pso_matrix_free(pos_b, settings->size);
-    pso_matrix_free(pos_nb, settings->size);
-    free(comm);
-    free(fit);
-    free(fit_b);
+void pso_solve_multi(const pso_fidelity_t *ladder, int nlevels,
+                     pso_result_t *solution, pso_settings_t *settings)
+{
+    solve_state(pso_state_new_multi(ladder, nlevels, solution, settings));
 }
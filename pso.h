@@ -4,6 +4,8 @@
 #ifndef PSO_H_
 #define PSO_H_
 
+#include <math.h> // HUGE_VAL
+
 
 //                     CONSTANTES GERAIS
 
@@ -16,6 +18,9 @@
 // (referncia: Clerc 2002 / constriction factor)
 #define PSO_INERTIA 0.7298
 
+// Nmero mximo de degraus na escada de fidelidade (pso_solve_multi)
+#define PSO_MAX_FIDELITY 4
+
 
 //                 ESQUEMAS DE VIZINHANA (NHOOD)
 
@@ -47,6 +52,28 @@
 // 1) Inrcia decrescente linear (w cai de w_max para w_min)
 #define PSO_W_LIN_DEC 1
 
+// 2) APSO (Zhan et al. 2009): a cada passo o estado do enxame
+// (explorao, aproveitamento, convergncia ou fuga)  estimado pelas
+// distncias mdias entre as partculas, e w, c1 e c2 se ajustam a ele
+// (settings->c1/c2/w_max/w_min so ignorados). Na convergncia o gbest
+// recebe uma perturbao elitista: uma avaliao a mais por passo.
+#define PSO_W_APSO 2
+
+
+
+//           ESTRATGIAS DE TAMANHO DO ENXAME (SIZE)
+
+
+// 0) Tamanho constante (size partculas o tempo todo)
+#define PSO_SIZE_CONST 0
+
+// 1) Reduo linear: o enxame cai de size para size_min ao longo dos steps
+#define PSO_SIZE_LIN_DEC 1
+
+// 2) Reduo adaptativa: uma partcula sai a cada 10 passos seguidos sem
+// melhora do gbest (enquanto h progresso, o tamanho se mantm)
+#define PSO_SIZE_ADAPTIVE 2
+
 
 //              ESTRUTURA DE RESULTADO DO PSO
 
@@ -61,6 +88,18 @@ typedef struct {
     // Deve ter exatamente DIM elementos
     double *gbest;
 
+    // Estatsticas (preenchidas pelo pso_solve):
+    // evals         = total de chamadas  funo objetivo
+    // evals_aborted = quantas retornaram PSO_FIT_ABORTED (corte antecipado)
+    long evals;
+    long evals_aborted;
+
+    // S com pso_solve_multi (seno ficam zerados):
+    // evals_level[k] = avaliaes no degrau k da escada de fidelidade
+    // cost          = soma dos custos (pso_fidelity_t.cost) das avaliaes
+    long evals_level[PSO_MAX_FIDELITY];
+    double cost;
+
 } pso_result_t;
 
 
@@ -75,6 +114,32 @@ typedef struct {
 typedef double (*pso_obj_fun_t)(double *, int, void *);
 
 
+//          FUNO OBJETIVO COM CORTE (EARLY-ABORT)
+
+// Mesma assinatura da anterior, com um quarto argumento:
+// - cutoff: fitness do pbest atual da partcula avaliada.
+// Como s interessa saber se x  melhor que o pbest, a funo pode parar
+// assim que o valor parcial passar de cutoff (ex.: soma de resduos) e
+// retornar PSO_FIT_ABORTED (ou qualquer valor > cutoff).
+// Na avaliao inicial do enxame cutoff = DBL_MAX (no h pbest ainda).
+typedef double (*pso_obj_fun_cut_t)(double *, int, void *, double);
+
+// Marcador "pior que o cutoff" (avaliao interrompida)
+#define PSO_FIT_ABORTED HUGE_VAL
+
+
+//              FUNO OBJETIVO EM LOTE (BATCH)
+
+// Avalia vrias posies em uma nica chamada:
+// - ponteiro para vetor de n posies (double **x, cada uma com dim elementos)
+// - dimenso do problema (int dim)
+// - nmero de posies (int n)
+// - sada: fitness de cada posio (double *fit, n elementos)
+// - ponteiro genrico para parmetros extras (void *params)
+// til quando o modelo  muito mais eficiente em lotes (ou remoto).
+typedef void (*pso_obj_batch_fun_t)(double **, int, int, double *, void *);
+
+
 
 //                ESTRUTURA DE CONFIGURAO
 
@@ -93,6 +158,14 @@ typedef struct {
     // Tamanho do enxame (nmero de partculas)
     int size;
 
+    // Reduo do enxame:
+    // PSO_SIZE_CONST, PSO_SIZE_LIN_DEC ou PSO_SIZE_ADAPTIVE
+    // A cada passo as partculas de pior pbest (nunca a do gbest) saem at
+    // o enxame ter o tamanho da estratgia, e a vizinhana  refeita.
+    // size_min = tamanho final (no reduz abaixo dele)
+    int size_strategy;
+    int size_min;
+
     // Frequncia de impresso (a cada N passos)
     // Se 0, no imprime nada durante a execuo
     int print_every;
@@ -127,9 +200,65 @@ typedef struct {
     int nhood_size;
 
     // Estratgia de inrcia:
-    // PSO_W_CONST ou PSO_W_LIN_DEC
+    // PSO_W_CONST, PSO_W_LIN_DEC ou PSO_W_APSO
     int w_strategy;
 
+    // Semente dos nmeros aleatrios
+    // Se 0, usa o relgio (time) como antes: cada execuo  diferente
+    unsigned int seed;
+
+    // Melhor soluo compartilhada com outros solvers (pso_shared.h)
+    // Se != NULL, o gbest  publicado nela a cada passo e, se outro solver
+    // encontrou algo melhor, ele  adotado como gbest. NULL = desligado.
+    struct pso_shared_best *shared_best;
+
+    // Paralelismo da avaliao (pso_pool.h):
+    // threads       = n total de threads (0 ou 1 = serial)
+    // cpu_affinity  = NULL ou vetor com "threads" ids de CPU
+    // pool          = pool j existente a reutilizar (se != NULL, threads e
+    //                 cpu_affinity so ignorados). A funo objetivo pode
+    //                 usar o mesmo pool via pso_pool_self() (spawn/sync).
+    // numa          = 1: threads fixadas em CPUs de cada n NUMA
+    //                 (pso_numa.h; cpu_affinity, se dado, tem prioridade;
+    //                 a thread que chama volta  afinidade original no fim)
+    //                 e enxame dividido em um bloco de partculas por
+    //                 thread: a dona aloca e inicializa as linhas do bloco
+    //                 (first-touch, memria no n dela), atualiza e avalia
+    //                 sempre as mesmas partculas. S o melhor da
+    //                 vizinhana (pos_nb) cruza os ns. Vale s com pool
+    //                 prprio (pool = NULL, threads > 1).
+    // O resultado no depende do nmero de threads.
+    int threads;
+    int *cpu_affinity;
+    struct pso_pool *pool;
+    int numa;
+
+    // Objetivo ruidoso (simulaes):
+    // noise_samples > 1 liga a reamostragem adaptativa. Uma posio nova
+    // s substitui o pbest (e um pbest s vira gbest) depois de uma
+    // "corrida" de reavaliaes em que a diferena entre as mdias fica
+    // significativa, com no mximo noise_samples amostras por ponto.
+    // fit do pbest/gbest passa a ser a mdia das amostras.
+    // 0 ou 1 = desligado (uma avaliao, comparao direta).
+    int noise_samples;
+
+    // Contadores por fase (pso_perf.h): se != NULL, o tempo e os
+    // contadores de hardware de cada fase do passo (atualizao,
+    // vizinhana, avaliao, registro) so somados nele. Criado na thread
+    // que roda o solver. NULL = desligado.
+    struct pso_perf *perf;
+
+    // Latncia do objetivo (pso_latency.h): se != NULL, cada chamada 
+    // cronometrada num histograma (por thread) e as posies mais lentas
+    // ficam guardadas. NULL = desligado.
+    struct pso_latency *latency;
+
+    // Pgina de mtricas em memria compartilhada (pso_metrics.h): se
+    // != NULL, passo, avaliaes, melhor erro, w, diversidade e estado
+    // das threads so publicados a cada passo (pso_top mostra). NULL =
+    // desligado.
+    struct pso_metrics *metrics;
+
 } pso_settings_t;
 
 
@@ -156,4 +285,87 @@ int pso_calc_swarm_size(int dim);
 void pso_solve(pso_obj_fun_t obj_fun, void *obj_fun_params,
                pso_result_t *solution, pso_settings_t *settings);
 
+// Igual ao pso_solve, mas com funo objetivo que aceita cutoff
+// (ver pso_obj_fun_cut_t). Avaliaes abortadas nunca viram pbest/gbest
+// e so contadas em solution->evals_aborted.
+void pso_solve_cut(pso_obj_fun_cut_t obj_fun, void *obj_fun_params,
+                   pso_result_t *solution, pso_settings_t *settings);
+
+// Igual ao pso_solve, mas com funo objetivo em lote
+// (ver pso_obj_batch_fun_t): a cada passo o enxame inteiro  avaliado em
+// uma chamada (ou em uma chamada por bloco de partculas, se
+// settings->threads > 1).
+void pso_solve_batch(pso_obj_batch_fun_t obj_fun, void *obj_fun_params,
+                     pso_result_t *solution, pso_settings_t *settings);
+
+
+//              MULTI-FIDELIDADE
+
+// Degrau da escada de fidelidade. Os degraus vo do mais barato ao mais
+// caro; o ltimo  a fidelidade "verdadeira": s ele define pbest, gbest
+// e solution->error.
+typedef struct {
+    pso_obj_fun_t fun;
+    void *params;
+    double cost;      // custo relativo de uma avaliao (soma em solution->cost)
+    double z;         // otimismo ao subir deste degrau (em desvios): 0 = sobe
+                      // se a previso bate o pbest; > 0 sobe mais (perde
+                      // menos melhoras, custa mais). Ignorado no topo.
+} pso_fidelity_t;
+
+// Igual ao pso_solve, com uma escada de nlevels (1..PSO_MAX_FIDELITY)
+// fidelidades. O enxame inicial  avaliado no topo; depois, a cada passo,
+// toda posio  avaliada no degrau mais barato e s sobe um degrau se
+// ainda puder bater o pbest da partcula: o valor do degrau  corrigido
+// pela diferena at o topo (mdia mvel, medida nas posies que chegaram
+// l) menos z desvios dessa diferena. Posies que param antes do topo
+// no viram pbest.
+void pso_solve_multi(const pso_fidelity_t *ladder, int nlevels,
+                     pso_result_t *solution, pso_settings_t *settings);
+
+
+//            API INCREMENTAL (PASSO A PASSO)
+
+// O pso_solve  equivalente a:
+//   pso_state_t *st = pso_state_new(obj_fun, params, &solution, settings);
+//   pso_state_step(st, settings->steps);
+//   pso_state_free(st);
+// Com o estado  possvel rodar alguns passos, fazer outra coisa e
+// continuar depois (ex.: dividir o tempo entre vrias otimizaes).
+// solution e settings precisam continuar vlidos enquanto o estado existir.
+
+// Estrutura opaca (ver pso.c)
+typedef struct pso_state pso_state_t;
+
+// Cria o estado e avalia o enxame inicial (solution j recebe o gbest
+// inicial). Retorna NULL em caso de falha.
+pso_state_t *pso_state_new(pso_obj_fun_t obj_fun, void *obj_fun_params,
+                           pso_result_t *solution, pso_settings_t *settings);
+pso_state_t *pso_state_new_cut(pso_obj_fun_cut_t obj_fun, void *obj_fun_params,
+                               pso_result_t *solution, pso_settings_t *settings);
+pso_state_t *pso_state_new_batch(pso_obj_batch_fun_t obj_fun, void *obj_fun_params,
+                                 pso_result_t *solution, pso_settings_t *settings);
+pso_state_t *pso_state_new_multi(const pso_fidelity_t *ladder, int nlevels,
+                                 pso_result_t *solution, pso_settings_t *settings);
+
+// Executa at nsteps passos. Retorna 1 se a otimizao terminou (goal
+// atingido ou settings->steps passos), 0 caso contrrio.
+int pso_state_step(pso_state_t *state, int nsteps);
+
+// 1 se a otimizao j terminou
+int pso_state_done(const pso_state_t *state);
+
+// Nmero de passos j executados
+int pso_state_steps_done(const pso_state_t *state);
+
+// Partculas ativas (settings->size, ou menos com settings->size_strategy)
+int pso_state_size(const pso_state_t *state);
+
+// Melhor pbest do prprio enxame (solution->error pode ter vindo de
+// settings->shared_best; este no)
+double pso_state_best(const pso_state_t *state);
+
+// Libera o estado (solution mantm o melhor resultado encontrado)
+void pso_state_free(pso_state_t *state);
+
 #endif // PSO_H_
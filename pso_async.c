@@ -0,0 +1,232 @@
+/* Função objetivo assíncrona (laço de eventos numa única thread)
+*/
+
+#include <stdlib.h>     // malloc(), free()
+#include <math.h>       // HUGE_VAL
+#include <time.h>       // clock_gettime()
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+
+#include "pso_async.h"
+#include "pso_trace.h"
+
+
+// Avaliação em voo
+typedef struct {
+    pso_async_op_t op;
+    int idx;            // posição no lote
+    int busy;
+    double started;     // ns
+    uint64_t traced;    // início no traço (pso_trace.h)
+} slot_t;
+
+struct pso_async {
+    pthread_mutex_t lock;     // uma chamada de pso_async_batch por vez
+    pso_async_fun_t funs;
+    void *params;
+    int dim;
+    int depth;
+    int timeout_ms;
+    int epfd;
+
+    slot_t *slots;
+    int *free_slots, nfree;   // pilha de slots livres
+    struct epoll_event *events;
+
+    pso_async_stats_t stats;
+};
+
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static uint32_t to_epoll(int events) {
+    uint32_t e = 0;
+    if (events & POLLIN)  e |= EPOLLIN;
+    if (events & POLLOUT) e |= EPOLLOUT;
+    return e;
+}
+
+static int from_epoll(uint32_t e) {
+    int r = 0;
+    if (e & EPOLLIN)  r |= POLLIN;
+    if (e & EPOLLOUT) r |= POLLOUT;
+    if (e & EPOLLERR) r |= POLLERR;
+    if (e & EPOLLHUP) r |= POLLHUP;
+    return r;
+}
+
+// O fd só fica no epoll entre uma chamada e outra do objetivo, que assim
+// pode fechá-lo (ou trocá-lo) à vontade dentro de start/resume.
+static int watch(pso_async_t *a, int k) {
+    struct epoll_event ev;
+    ev.events = to_epoll(a->slots[k].op.events);
+    ev.data.u32 = (uint32_t)k;
+    return epoll_ctl(a->epfd, EPOLL_CTL_ADD, a->slots[k].op.fd, &ev);
+}
+
+static void unwatch(pso_async_t *a, int k) {
+    epoll_ctl(a->epfd, EPOLL_CTL_DEL, a->slots[k].op.fd, NULL);
+}
+
+// Trata o retorno de start/resume. Retorna 1 se o slot foi liberado.
+static int settle(pso_async_t *a, int k, int rc, double f, double *fit) {
+    slot_t *s = &a->slots[k];
+
+    if (rc == PSO_ASYNC_PENDING) {
+        if (watch(a, k) == 0) return 0;
+        // fd inválido ou repetido: abandona
+        if (a->funs.cancel) a->funs.cancel(&s->op, a->params);
+        rc = PSO_ASYNC_FAILED;
+    }
+    if (rc == PSO_ASYNC_DONE) {
+        fit[s->idx] = f;
+        a->stats.evals++;
+    } else {
+        fit[s->idx] = HUGE_VAL;
+        a->stats.failed++;
+    }
+    s->busy = 0;
+    a->free_slots[a->nfree++] = k;
+    pso_trace_async("async eval", s->traced, k, s->idx);
+    return 1;
+}
+
+// Abandona uma avaliação em voo (timeout ou erro do epoll)
+static void abandon(pso_async_t *a, int k, double *fit) {
+    unwatch(a, k);
+    if (a->funs.cancel) a->funs.cancel(&a->slots[k].op, a->params);
+    settle(a, k, PSO_ASYNC_FAILED, HUGE_VAL, fit);
+}
+
+
+// ============================
+//         API PÚBLICA
+// ============================
+
+pso_async_t *pso_async_new(const pso_async_fun_t *funs, void *params,
+                           int dim, int depth)
+{
+    if (depth < 1) depth = 1;
+
+    pso_async_t *a = (pso_async_t *)calloc(1, sizeof(pso_async_t));
+    if (a == NULL) return NULL;
+    a->funs = *funs;
+    a->params = params;
+    a->dim = dim;
+    a->depth = depth;
+    a->epfd = epoll_create1(EPOLL_CLOEXEC);
+    a->slots = (slot_t *)calloc(depth, sizeof(slot_t));
+    a->free_slots = (int *)malloc(depth * sizeof(int));
+    a->events = (struct epoll_event *)malloc(depth * sizeof(struct epoll_event));
+    if (a->epfd < 0 || a->slots == NULL || a->free_slots == NULL || a->events == NULL) {
+        if (a->epfd >= 0) close(a->epfd);
+        free(a->slots); free(a->free_slots); free(a->events); free(a);
+        return NULL;
+    }
+    pthread_mutex_init(&a->lock, NULL);
+    return a;
+}
+
+void pso_async_timeout(pso_async_t *a, int timeout_ms) {
+    pthread_mutex_lock(&a->lock);
+    a->timeout_ms = timeout_ms > 0 ? timeout_ms : 0;
+    pthread_mutex_unlock(&a->lock);
+}
+
+void pso_async_free(pso_async_t *a) {
+    pthread_mutex_destroy(&a->lock);
+    close(a->epfd);
+    free(a->slots);
+    free(a->free_slots);
+    free(a->events);
+    free(a);
+}
+
+void pso_async_stats(pso_async_t *a, pso_async_stats_t *stats) {
+    pthread_mutex_lock(&a->lock);
+    *stats = a->stats;
+    pthread_mutex_unlock(&a->lock);
+}
+
+void pso_async_batch(double **x, int dim, int n, double *fit, void *params) {
+    pso_async_t *a = (pso_async_t *)params;
+    int next = 0;
+    (void)dim;
+
+    pthread_mutex_lock(&a->lock);
+    a->nfree = 0;
+    for (int k=a->depth-1; k>=0; k--) a->free_slots[a->nfree++] = k;
+
+    for (;;) {
+        // completa a janela de avaliações em voo
+        while (a->nfree > 0 && next < n) {
+            int k = a->free_slots[--a->nfree];
+            slot_t *s = &a->slots[k];
+            double f = HUGE_VAL;
+
+            s->idx = next++;
+            s->op.fd = -1;
+            s->op.events = 0;
+            s->op.ctx = NULL;
+            s->busy = 1;
+            s->started = now_ns();
+            s->traced = pso_trace_begin();
+            int rc = a->funs.start(x[s->idx], a->dim, &s->op, &f, a->params);
+            settle(a, k, rc, f, fit);
+
+            int inflight = a->depth - a->nfree;
+            if (inflight > a->stats.max_inflight) a->stats.max_inflight = inflight;
+        }
+        if (a->nfree == a->depth) break;      // nada em voo e nada a iniciar
+
+        // espera até o fim do prazo mais próximo (ou indefinidamente)
+        int wait_ms = -1;
+        if (a->timeout_ms > 0) {
+            double now = now_ns(), first = now;
+            for (int k=0; k<a->depth; k++)
+                if (a->slots[k].busy && a->slots[k].started < first)
+                    first = a->slots[k].started;
+            wait_ms = (int)(a->timeout_ms - (now - first) / 1e6) + 1;
+            if (wait_ms < 0) wait_ms = 0;
+        }
+
+        uint64_t t0 = pso_trace_begin();
+        int ne = epoll_wait(a->epfd, a->events, a->depth, wait_ms);
+        pso_trace_end("wait", t0, a->depth - a->nfree);
+        if (ne < 0 && errno != EINTR) {
+            for (int k=0; k<a->depth; k++)
+                if (a->slots[k].busy) abandon(a, k, fit);
+            continue;
+        }
+
+        for (int e=0; e<ne; e++) {
+            int k = (int)a->events[e].data.u32;
+            slot_t *s = &a->slots[k];
+            double f = HUGE_VAL;
+
+            unwatch(a, k);
+            int rc = a->funs.resume(&s->op, from_epoll(a->events[e].events), &f, a->params);
+            settle(a, k, rc, f, fit);
+        }
+
+        if (a->timeout_ms > 0) {
+            double now = now_ns();
+            for (int k=0; k<a->depth; k++) {
+                slot_t *s = &a->slots[k];
+                if (s->busy && (now - s->started) / 1e6 > a->timeout_ms) {
+                    a->stats.timeouts++;
+                    abandon(a, k, fit);
+                }
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&a->lock);
+}
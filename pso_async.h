@@ -0,0 +1,78 @@
+/* Função objetivo assíncrona (laço de eventos numa única thread)
+
+   Para objetivos limitados por E/S (consulta a um banco local, socket de
+   um simulador), bloquear uma thread por avaliação desperdiça recursos.
+   Aqui a avaliação é dividida em duas etapas não bloqueantes:
+
+   - start(x, op): inicia a avaliação (ex.: envia a consulta) e diz em
+     op->fd/op->events o que esperar; ou já devolve o fitness.
+   - resume(op, revents): chamada quando o fd fica pronto; lê o que houver
+     e diz se terminou (fitness) ou o que esperar em seguida (pode trocar
+     de fd entre etapas).
+
+   Um laço epoll mantém até depth avaliações em voo na mesma thread; a
+   vazão cresce com a profundidade, não com o número de threads:
+
+     pso_async_t *a = pso_async_new(&minhas_funcs, meu_ctx, dim, 64);
+     pso_solve_batch(pso_async_batch, a, &result, settings);
+
+   Cada avaliação em voo precisa de um fd próprio (o mesmo fd não pode
+   estar em duas avaliações ao mesmo tempo). Use settings->threads = 1:
+   assim o enxame inteiro chega numa única chamada e a janela enche.
+*/
+
+#ifndef PSO_ASYNC_H_
+#define PSO_ASYNC_H_
+
+#include "pso.h"
+
+// Estado de uma avaliação em voo (preenchido pelo objetivo)
+typedef struct {
+    int fd;          // descritor a vigiar
+    int events;      // POLLIN e/ou POLLOUT
+    void *ctx;       // estado da avaliação (livre para o objetivo)
+} pso_async_op_t;
+
+// Retorno de start/resume
+#define PSO_ASYNC_DONE     1    // terminou, fitness em *fit
+#define PSO_ASYNC_PENDING  0    // esperar op->fd/op->events de novo
+#define PSO_ASYNC_FAILED  -1    // falhou (fitness = HUGE_VAL)
+
+typedef struct {
+    int (*start)(const double *x, int dim, pso_async_op_t *op, double *fit,
+                 void *params);
+    // revents: eventos ocorridos (POLLIN/POLLOUT/POLLERR/POLLHUP)
+    int (*resume)(pso_async_op_t *op, int revents, double *fit, void *params);
+    // libera uma avaliação abandonada (timeout); pode ser NULL
+    void (*cancel)(pso_async_op_t *op, void *params);
+} pso_async_fun_t;
+
+// Estrutura opaca (ver pso_async.c)
+typedef struct pso_async pso_async_t;
+
+typedef struct {
+    long evals;       // avaliações terminadas
+    long failed;      // avaliações que falharam (inclui timeouts)
+    long timeouts;    // avaliações abandonadas por timeout
+    int max_inflight; // maior número de avaliações em voo ao mesmo tempo
+} pso_async_stats_t;
+
+
+// depth: avaliações em voo ao mesmo tempo (>= 1)
+// Retorna NULL em caso de falha.
+pso_async_t *pso_async_new(const pso_async_fun_t *funs, void *params,
+                           int dim, int depth);
+
+// Limite de cada avaliação em ms (0 = sem limite, o padrão). Uma
+// avaliação que passa do limite é cancelada e recebe HUGE_VAL.
+void pso_async_timeout(pso_async_t *async, int timeout_ms);
+
+void pso_async_free(pso_async_t *async);
+
+// Função objetivo em lote para pso_solve_batch (params = async)
+void pso_async_batch(double **x, int dim, int n, double *fit, void *async);
+
+// Copia os contadores atuais
+void pso_async_stats(pso_async_t *async, pso_async_stats_t *stats);
+
+#endif // PSO_ASYNC_H_
@@ -0,0 +1,266 @@
+/* PSO em lote: muitos problemas pequenos e independentes resolvidos
+   em paralelo (lock-step), um problema por "lane" SIMD.
+*/
+
+#include <stdlib.h>   // malloc(), free()
+#include <stdint.h>   // uint32_t
+#include <time.h>     // time()
+#include <math.h>     // fmod()
+#include <float.h>    // DBL_MAX
+
+#include "pso_batch.h"
+
+// definida em pso.c
+double calc_inertia_lin_dec(int step, pso_settings_t *settings);
+
+
+// Números aleatórios por lane (xorshift32):
+// cada problema tem seu próprio estado, então os loops sobre p não têm
+// dependência entre iterações e o compilador consegue vetorizar.
+
+// gera um double no intervalo [0, 1)
+static inline double lane_uniform(uint32_t *s) {
+    uint32_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *s = x;
+    return (double)(int32_t)(x >> 8) * (1.0 / 16777216.0);
+}
+
+// semente distinta (e não nula) para cada lane
+static uint32_t lane_seed(uint32_t base, int p) {
+    uint32_t z = base + 0x9e3779b9u * (uint32_t)(p + 1);
+    z = (z ^ (z >> 16)) * 0x85ebca6bu;
+    z = (z ^ (z >> 13)) * 0xc2b2ae35u;
+    z ^= z >> 16;
+    return z ? z : 0x6d2b79f5u;
+}
+
+
+// Bytes de estado para um bloco de np lanes
+static size_t tile_bytes(int np, pso_settings_t *settings) {
+    const size_t nx = (size_t)settings->size * settings->dim * np;
+    const size_t nf = (size_t)settings->size * np;
+    return (4 * nx + 2 * nf + (size_t)settings->dim * np + np) * sizeof(double)
+        + (size_t)np * (2 * sizeof(int) + sizeof(uint32_t));
+}
+
+
+//          ALGORITMO PRINCIPAL (UM BLOCO DE LANES)
+
+// Resolve os problemas [first, first+np) usando o bloco de memória mem
+static void batch_tile(pso_obj_lanes_fun_t obj_fun, void *obj_fun_params,
+                       int first, int np, char *mem, uint32_t seed,
+                       pso_batch_result_t *solution,
+                       pso_settings_t *settings)
+{
+    const int dim = settings->dim;
+    const int size = settings->size;
+    const int ring = (settings->nhood_strategy != PSO_NHOOD_GLOBAL);
+    const int clamp = settings->clamp_pos;
+
+    // Layout SoA com a lane como índice mais interno:
+    // v[(j*dim + d)*np + p]  (partícula j, dimensão d, lane p)
+    const size_t nx = (size_t)size * dim * np;
+    const size_t nf = (size_t)size * np;
+
+    double *pos    = (double *)mem;       // posições atuais
+    double *vel    = pos + nx;            // velocidades
+    double *pos_b  = vel + nx;            // pbest
+    double *pos_nb = pos_b + nx;          // melhor vizinho (RING)
+    double *fit    = pos_nb + nx;         // fitness atual
+    double *fit_b  = fit + nf;            // fitness do pbest
+    double *gb     = fit_b + nf;          // gbest por lane: gb[d*np + p]
+    double *gerr   = gb + (size_t)dim * np; // erro do gbest por lane
+    int *gidx      = (int *)(gerr + np);  // partícula dona do gbest
+    int *nbk       = gidx + np;           // melhor vizinho escolhido (RING)
+    uint32_t *rng  = (uint32_t *)(nbk + np);
+
+    int j, d, p, step;
+    size_t o;
+    double w = PSO_INERTIA;
+    const double c1 = settings->c1, c2 = settings->c2;
+
+    for (p=0; p<np; p++) {
+        rng[p] = lane_seed(seed, first + p);
+        gerr[p] = DBL_MAX;
+        gidx[p] = 0;
+    }
+
+
+    // Inicialização do enxame (todas as lanes)
+
+    for (j=0; j<size; j++) {
+        for (d=0; d<dim; d++) {
+            const double lo = settings->range_lo[d];
+            const double span = settings->range_hi[d] - lo;
+            o = ((size_t)j * dim + d) * np;
+            for (p=0; p<np; p++) {
+                double a = lo + span * lane_uniform(&rng[p]);
+                double b = lo + span * lane_uniform(&rng[p]);
+                pos[o+p] = a;
+                pos_b[o+p] = a;
+                vel[o+p] = (a-b) / 2.0;
+            }
+        }
+    }
+
+    obj_fun(pos, dim, size, np, first, fit, obj_fun_params);
+    solution->calls++;
+
+    for (j=0; j<size; j++) {
+        for (p=0; p<np; p++) {
+            fit_b[j*np+p] = fit[j*np+p];
+            if (fit[j*np+p] < gerr[p]) {
+                gerr[p] = fit[j*np+p];
+                gidx[p] = j;
+            }
+        }
+    }
+    for (d=0; d<dim; d++)
+        for (p=0; p<np; p++)
+            gb[(size_t)d*np+p] = pos_b[((size_t)gidx[p]*dim + d)*np + p];
+
+
+    // Loop principal (lock-step entre problemas)
+
+    for (step=0; step<settings->steps; step++) {
+        settings->step = step;
+
+        if (settings->w_strategy == PSO_W_LIN_DEC)
+            w = calc_inertia_lin_dec(step, settings);
+
+        // critério de parada: todos os problemas do bloco atingiram o goal
+        int done = 1;
+        for (p=0; p<np; p++)
+            done &= (gerr[p] <= settings->goal);
+        if (done) break;
+
+        // RING: melhor entre (j-1, j, j+1) em cada lane
+        if (ring) {
+            for (j=0; j<size; j++) {
+                const int l = (j + size - 1) % size;
+                const int r = (j + 1) % size;
+                for (p=0; p<np; p++) {
+                    int k = j;
+                    if (fit_b[l*np+p] < fit_b[k*np+p]) k = l;
+                    if (fit_b[r*np+p] < fit_b[k*np+p]) k = r;
+                    nbk[p] = k;
+                }
+                for (d=0; d<dim; d++) {
+                    o = ((size_t)j * dim + d) * np;
+                    for (p=0; p<np; p++)
+                        pos_nb[o+p] = pos_b[((size_t)nbk[p]*dim + d)*np + p];
+                }
+            }
+        }
+
+        // atualiza velocidade/posição de todas as partículas
+        for (j=0; j<size; j++) {
+            for (d=0; d<dim; d++) {
+                const double lo = settings->range_lo[d];
+                const double hi = settings->range_hi[d];
+                o = ((size_t)j * dim + d) * np;
+                // atrator social: pos_nb (RING) ou gbest da lane (GLOBAL)
+                const double *nb = ring ? pos_nb + o : gb + (size_t)d * np;
+
+                for (p=0; p<np; p++) {
+                    double rho1 = c1 * lane_uniform(&rng[p]);
+                    double rho2 = c2 * lane_uniform(&rng[p]);
+                    vel[o+p] = w * vel[o+p]
+                        + rho1 * (pos_b[o+p] - pos[o+p])
+                        + rho2 * (nb[p] - pos[o+p]);
+                    pos[o+p] += vel[o+p];
+                }
+
+                if (clamp) {
+                    // CLAMP sem desvios (selects vetorizáveis)
+                    for (p=0; p<np; p++) {
+                        double x = pos[o+p];
+                        double c = x < lo ? lo : x;
+                        c = c > hi ? hi : c;
+                        vel[o+p] = c == x ? vel[o+p] : 0.0;
+                        pos[o+p] = c;
+                    }
+                } else {
+                    // PERIÓDICO: fmod não vetoriza, loop escalar à parte
+                    for (p=0; p<np; p++) {
+                        if (pos[o+p] < lo) {
+                            pos[o+p] = hi - fmod(lo - pos[o+p], hi - lo);
+                            vel[o+p] = 0;
+                        } else if (pos[o+p] > hi) {
+                            pos[o+p] = lo + fmod(pos[o+p] - hi, hi - lo);
+                            vel[o+p] = 0;
+                        }
+                    }
+                }
+            }
+        }
+
+        // uma única avaliação para todos os problemas
+        obj_fun(pos, dim, size, np, first, fit, obj_fun_params);
+        solution->calls++;
+
+        // atualiza pbest (select por lane, sem desvios)
+        for (j=0; j<size; j++) {
+            const double *f = fit + (size_t)j * np;
+            const double *fb = fit_b + (size_t)j * np;
+            for (d=0; d<dim; d++) {
+                o = ((size_t)j * dim + d) * np;
+                for (p=0; p<np; p++)
+                    pos_b[o+p] = f[p] < fb[p] ? pos[o+p] : pos_b[o+p];
+            }
+        }
+        for (o=0; o<nf; o++)
+            fit_b[o] = fit[o] < fit_b[o] ? fit[o] : fit_b[o];
+
+        // atualiza gbest de cada lane
+        for (j=0; j<size; j++) {
+            for (p=0; p<np; p++) {
+                if (fit_b[j*np+p] < gerr[p]) {
+                    gerr[p] = fit_b[j*np+p];
+                    gidx[p] = j;
+                }
+            }
+        }
+        for (d=0; d<dim; d++)
+            for (p=0; p<np; p++)
+                gb[(size_t)d*np+p] = pos_b[((size_t)gidx[p]*dim + d)*np + p];
+    }
+
+
+    // Copia resultados (layout por problema)
+
+    for (p=0; p<np; p++) {
+        solution->error[first + p] = gerr[p];
+        for (d=0; d<dim; d++)
+            solution->gbest[(size_t)(first + p)*dim + d] = gb[(size_t)d*np + p];
+    }
+}
+
+
+//                 ALGORITMO PRINCIPAL (EM LOTE)
+
+void pso_batch_solve(pso_obj_lanes_fun_t obj_fun, void *obj_fun_params,
+                     int nprob, pso_batch_result_t *solution,
+                     pso_settings_t *settings)
+{
+    int lanes = nprob < PSO_BATCH_LANES ? nprob : PSO_BATCH_LANES;
+
+    // Um único bloco de memória reaproveitado por todos os tiles
+    // (o estado de um tile cabe no cache; o lote inteiro não caberia)
+    char *mem = (char *)malloc(tile_bytes(lanes, settings));
+    if (mem == NULL) return;
+
+    uint32_t seed = settings->seed ? settings->seed : (uint32_t)time(NULL);
+    solution->calls = 0;
+
+    for (int first=0; first<nprob; first+=lanes) {
+        int np = nprob - first < lanes ? nprob - first : lanes;
+        batch_tile(obj_fun, obj_fun_params, first, np, mem, seed,
+                   solution, settings);
+    }
+
+    free(mem);
+}
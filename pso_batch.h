@@ -0,0 +1,59 @@
+/* PSO em lote: muitos problemas pequenos e independentes resolvidos
+   em paralelo (lock-step), um problema por "lane" SIMD.
+*/
+
+#ifndef PSO_BATCH_H_
+#define PSO_BATCH_H_
+
+#include "pso.h"
+
+
+//              FUNÇÃO OBJETIVO EM LOTE (LANES)
+
+// Os problemas são resolvidos em blocos (tiles) de até PSO_BATCH_LANES
+// lanes que cabem no cache; a cada passo, uma única chamada avalia todas
+// as partículas de todos os problemas do bloco.
+// Layout (problema mais interno, para vetorizar entre problemas):
+//   x[(j*dim + d)*nlanes + p] = coordenada d da partícula j da lane p
+//   fit[j*nlanes + p]         = fitness da partícula j da lane p
+// A lane p corresponde ao problema (first + p).
+// params é o mesmo ponteiro passado ao pso_batch_solve.
+typedef void (*pso_obj_lanes_fun_t)(const double *x, int dim, int size,
+                                    int nlanes, int first, double *fit,
+                                    void *params);
+
+// Número máximo de lanes (problemas) por bloco
+#define PSO_BATCH_LANES 256
+
+
+//                 RESULTADO DO PSO EM LOTE
+
+// Preparado pelo usuário antes de chamar pso_batch_solve():
+// - error deve ter nprob elementos
+// - gbest deve ter nprob*dim elementos (gbest[p*dim + d])
+typedef struct {
+
+    // Melhor erro de cada problema
+    double *error;
+
+    // Melhor posição de cada problema
+    double *gbest;
+
+    // Total de chamadas à função objetivo (cada uma avalia size*nlanes pontos)
+    long calls;
+
+} pso_batch_result_t;
+
+
+// Resolve nprob problemas independentes com as mesmas configurações
+// (dim, limites, size, steps, c1/c2, inércia, clamp).
+// - Topologias: PSO_NHOOD_GLOBAL e PSO_NHOOD_RING (RANDOM usa RING,
+//   pois a vizinhança aleatória não anda em lock-step entre problemas)
+// - Cada bloco para quando todos os seus problemas atingirem goal
+//   ou após steps passos
+// - print_every é ignorado (sem saída no terminal)
+void pso_batch_solve(pso_obj_lanes_fun_t obj_fun, void *obj_fun_params,
+                     int nprob, pso_batch_result_t *solution,
+                     pso_settings_t *settings);
+
+#endif // PSO_BATCH_H_
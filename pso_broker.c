@@ -0,0 +1,245 @@
+/* Agrupador de avaliações (broker) entre solvers concorrentes
+*/
+
+#include <stdlib.h>     // malloc(), free()
+#include <time.h>       // clock_gettime()
+#include <errno.h>      // ETIMEDOUT
+#include <pthread.h>
+
+#include "pso_broker.h"
+
+
+// Pedido de um solver (fica na pilha de quem pede até ser atendido)
+typedef struct request {
+    double **x;
+    double *fit;
+    int n;
+    int taken;            // posições já colocadas em algum lote
+    int remaining;        // posições ainda sem fitness
+    struct timespec arrival;
+    pthread_cond_t done;
+    struct request *next;
+} request_t;
+
+// Trecho de um pedido dentro do lote atual
+typedef struct {
+    request_t *req;
+    int first;            // índice no pedido
+    int count;
+} segment_t;
+
+struct pso_broker {
+    pso_obj_batch_fun_t eval;
+    void *eval_params;
+    int dim;
+    int max_batch;
+    long max_wait_ns;
+
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;  // sinaliza a thread do broker
+    int stop;
+
+    // fila de pedidos (FIFO) e posições ainda não colocadas em lote
+    request_t *head, *tail;
+    long pending;
+
+    // lote em montagem (usado só pela thread do broker)
+    double **bx;
+    double *bfit;
+    segment_t *seg;
+
+    pso_broker_stats_t stats;
+};
+
+
+static void add_ns(struct timespec *t, long ns) {
+    t->tv_nsec += ns;
+    while (t->tv_nsec >= 1000000000L) {
+        t->tv_nsec -= 1000000000L;
+        t->tv_sec++;
+    }
+}
+
+// Espera (com o lock) até ter um lote cheio, o pedido mais antigo
+// estourar max_wait_ns ou o broker ser encerrado.
+// Retorna 0 se deve encerrar.
+static int wait_batch(pso_broker_t *b) {
+    while (b->head == NULL && !b->stop)
+        pthread_cond_wait(&b->wake, &b->lock);
+    if (b->head == NULL) return 0;
+
+    struct timespec deadline = b->head->arrival;
+    add_ns(&deadline, b->max_wait_ns);
+    while (b->pending < b->max_batch && !b->stop) {
+        if (pthread_cond_timedwait(&b->wake, &b->lock, &deadline) == ETIMEDOUT)
+            break;
+    }
+    return 1;
+}
+
+// Tira da fila até max_batch posições (com o lock)
+static int fill_batch(pso_broker_t *b, int *nseg) {
+    int nb = 0, ns = 0;
+
+    while (b->head != NULL && nb < b->max_batch) {
+        request_t *r = b->head;
+        int count = r->n - r->taken;
+        if (count > b->max_batch - nb) count = b->max_batch - nb;
+
+        b->seg[ns].req = r;
+        b->seg[ns].first = r->taken;
+        b->seg[ns].count = count;
+        ns++;
+        for (int k=0; k<count; k++)
+            b->bx[nb + k] = r->x[r->taken + k];
+        nb += count;
+        r->taken += count;
+
+        // pedido inteiramente no lote: sai da fila (o dono continua
+        // esperando por "remaining")
+        if (r->taken == r->n) {
+            b->head = r->next;
+            if (b->head == NULL) b->tail = NULL;
+        }
+    }
+    b->pending -= nb;
+    *nseg = ns;
+    return nb;
+}
+
+static void *broker_main(void *p) {
+    pso_broker_t *b = (pso_broker_t *)p;
+    int nb, ns;
+
+    pthread_mutex_lock(&b->lock);
+    while (wait_batch(b)) {
+        nb = fill_batch(b, &ns);
+        pthread_mutex_unlock(&b->lock);
+
+        // avaliação fora do lock: os solvers continuam enfileirando
+        b->eval(b->bx, b->dim, nb, b->bfit, b->eval_params);
+
+        pthread_mutex_lock(&b->lock);
+        int off = 0;
+        for (int s=0; s<ns; s++) {
+            request_t *r = b->seg[s].req;
+            for (int k=0; k<b->seg[s].count; k++)
+                r->fit[b->seg[s].first + k] = b->bfit[off + k];
+            off += b->seg[s].count;
+            r->remaining -= b->seg[s].count;
+            if (r->remaining == 0)
+                pthread_cond_signal(&r->done);
+        }
+        b->stats.positions += nb;
+        b->stats.batches++;
+        if (nb > b->stats.max_batch) b->stats.max_batch = nb;
+    }
+    pthread_mutex_unlock(&b->lock);
+    return NULL;
+}
+
+
+// ============================
+//         API PÚBLICA
+// ============================
+
+pso_broker_t *pso_broker_new(pso_obj_batch_fun_t eval, void *eval_params,
+                             int dim, int max_batch, int max_wait_us)
+{
+    if (max_batch < 1) max_batch = 1;
+    if (max_wait_us < 0) max_wait_us = 0;
+
+    pso_broker_t *b = (pso_broker_t *)malloc(sizeof(pso_broker_t));
+    if (b == NULL) return NULL;
+
+    b->eval = eval;
+    b->eval_params = eval_params;
+    b->dim = dim;
+    b->max_batch = max_batch;
+    b->max_wait_ns = max_wait_us * 1000L;
+    b->stop = 0;
+    b->head = b->tail = NULL;
+    b->pending = 0;
+    b->stats.requests = b->stats.positions = b->stats.batches = 0;
+    b->stats.max_batch = 0;
+
+    // um lote tem no máximo max_batch segmentos (um por posição)
+    b->bx = (double **)malloc(max_batch * sizeof(double *));
+    b->bfit = (double *)malloc(max_batch * sizeof(double));
+    b->seg = (segment_t *)malloc(max_batch * sizeof(segment_t));
+    if (b->bx == NULL || b->bfit == NULL || b->seg == NULL) {
+        free(b->bx); free(b->bfit); free(b->seg); free(b);
+        return NULL;
+    }
+
+    pthread_mutex_init(&b->lock, NULL);
+    pthread_cond_init(&b->wake, NULL);
+    if (pthread_create(&b->thread, NULL, broker_main, b) != 0) {
+        pthread_mutex_destroy(&b->lock);
+        pthread_cond_destroy(&b->wake);
+        free(b->bx); free(b->bfit); free(b->seg); free(b);
+        return NULL;
+    }
+    return b;
+}
+
+void pso_broker_free(pso_broker_t *b) {
+    pthread_mutex_lock(&b->lock);
+    b->stop = 1;
+    pthread_cond_signal(&b->wake);
+    pthread_mutex_unlock(&b->lock);
+    pthread_join(b->thread, NULL);
+
+    pthread_mutex_destroy(&b->lock);
+    pthread_cond_destroy(&b->wake);
+    free(b->bx);
+    free(b->bfit);
+    free(b->seg);
+    free(b);
+}
+
+void pso_broker_batch(double **x, int dim, int n, double *fit, void *params) {
+    pso_broker_t *b = (pso_broker_t *)params;
+    request_t r;
+    (void)dim;
+
+    if (n <= 0) return;
+    r.x = x;
+    r.fit = fit;
+    r.n = n;
+    r.taken = 0;
+    r.remaining = n;
+    r.next = NULL;
+    clock_gettime(CLOCK_REALTIME, &r.arrival); // base de pthread_cond_timedwait
+    pthread_cond_init(&r.done, NULL);
+
+    pthread_mutex_lock(&b->lock);
+    if (b->tail != NULL) b->tail->next = &r;
+    else b->head = &r;
+    b->tail = &r;
+    b->pending += n;
+    b->stats.requests++;
+    // acorda o broker se a fila estava vazia (início da janela de espera)
+    // ou se agora já há um lote cheio
+    if (b->head == &r || b->pending >= b->max_batch)
+        pthread_cond_signal(&b->wake);
+
+    while (r.remaining > 0)
+        pthread_cond_wait(&r.done, &b->lock);
+    pthread_mutex_unlock(&b->lock);
+
+    pthread_cond_destroy(&r.done);
+}
+
+double pso_broker_eval(double *x, int dim, void *params) {
+    double fit;
+    pso_broker_batch(&x, dim, 1, &fit, params);
+    return fit;
+}
+
+void pso_broker_stats(pso_broker_t *b, pso_broker_stats_t *stats) {
+    pthread_mutex_lock(&b->lock);
+    *stats = b->stats;
+    pthread_mutex_unlock(&b->lock);
+}
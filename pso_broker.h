@@ -0,0 +1,56 @@
+/* Agrupador de avaliações (broker) entre solvers concorrentes
+
+   Vários pso_solve / pso_solve_batch rodando em threads diferentes, todos
+   avaliando o mesmo modelo, enviam suas posições a um broker. Uma thread
+   do broker junta os pedidos pendentes em lotes (até max_batch posições
+   ou max_wait_us microssegundos de espera), chama uma única vez a função
+   objetivo em lote e devolve cada fitness a quem pediu.
+
+   Uso típico (cada solver em sua thread):
+     pso_solve_batch(pso_broker_batch, broker, &result, settings);
+*/
+
+#ifndef PSO_BROKER_H_
+#define PSO_BROKER_H_
+
+#include "pso.h"
+
+// Estrutura opaca (ver pso_broker.c)
+typedef struct pso_broker pso_broker_t;
+
+// Contadores acumulados desde a criação
+typedef struct {
+    long requests;    // pedidos recebidos (chamadas dos solvers)
+    long positions;   // posições avaliadas
+    long batches;     // chamadas à função objetivo em lote
+    int max_batch;    // maior lote formado
+} pso_broker_stats_t;
+
+
+// Cria o broker e sua thread.
+// eval/eval_params: função objetivo em lote (chamada sempre pela thread do
+// broker, nunca em paralelo consigo mesma)
+// dim: dimensão das posições
+// max_batch: tamanho máximo de um lote (pedidos maiores são divididos)
+// max_wait_us: espera máxima do pedido mais antigo antes de o lote sair
+// incompleto (0 = sai assim que houver algum pedido)
+// Retorna NULL em caso de falha.
+pso_broker_t *pso_broker_new(pso_obj_batch_fun_t eval, void *eval_params,
+                             int dim, int max_batch, int max_wait_us);
+
+// Encerra a thread e libera o broker (nenhum solver pode estar usando)
+void pso_broker_free(pso_broker_t *broker);
+
+// Função objetivo em lote para pso_solve_batch (params = broker):
+// bloqueia até as n posições terem sido avaliadas
+void pso_broker_batch(double **x, int dim, int n, double *fit, void *broker);
+
+// Função objetivo escalar para pso_solve (params = broker). Cada chamada
+// é um pedido de uma posição; prefira pso_broker_batch, que envia o
+// enxame inteiro de uma vez.
+double pso_broker_eval(double *x, int dim, void *broker);
+
+// Copia os contadores atuais
+void pso_broker_stats(pso_broker_t *broker, pso_broker_stats_t *stats);
+
+#endif // PSO_BROKER_H_
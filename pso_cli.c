@@ -0,0 +1,520 @@
+/* Linha de comando do PSO (sem menus, para scripts e benchmarks)
+
+   Roda uma ou mais otimizações com todos os parâmetros vindos dos
+   argumentos e imprime resultado e tempos em formato legível por máquina.
+
+   uso: pso_cli --fun rastrigin --dim 30 --steps 10000 --seed 1 --format json
+        pso_cli --help            (lista completa de opções)
+
+   Saída (uma linha por execução):
+     text : run=0 seed=1 status=done error=... evals=... steps=... time_ms=...
+     csv  : cabeçalho + uma linha por execução
+     json : um objeto JSON por linha (JSON Lines)
+   Com --gbest a melhor posição é incluída (json: vetor, csv: colunas
+   gbest_0..gbest_{dim-1}, text: gbest=x1,x2,...).
+
+   Código de saída: 0 = ok, 1 = falha ao carregar/rodar, 2 = argumentos.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+
+#include "pso.h"
+#include "pso_funcs.h"
+#include "pso_plugin.h"
+#include "pso_portfolio.h"
+#include "pso_perf.h"
+#include "pso_trace.h"
+#include "pso_latency.h"
+#include "pso_metrics.h"
+
+#define FMT_TEXT 0
+#define FMT_CSV  1
+#define FMT_JSON 2
+
+// Eventos guardados por thread no --trace (os mais recentes)
+#define PSO_CLI_TRACE_EVENTS (1 << 18)
+
+
+// ============================
+//        UTILITÁRIOS
+// ============================
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// tempo de CPU do processo (todas as threads), em ns
+static double cpu_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void usage(FILE *f, const char *prog) {
+    fprintf(f,
+"uso: %s (--fun NOME | --plugin ARQ.so) --dim N [opções]\n"
+"\n"
+"função objetivo:\n"
+"  --fun NOME           sphere, rosenbrock, griewank, rastrigin, ackley\n"
+"  --plugin ARQ.so      função objetivo em plugin (pso_plugin.h)\n"
+"  --plugin-args S      argumentos passados ao init do plugin\n"
+"  --batch              avalia o plugin pela entrada em lote\n"
+"\n"
+"problema e enxame (padrões de pso_settings_new):\n"
+"  --dim N              dimensão (obrigatório)\n"
+"  --lo X --hi X        limites (padrão: domínio usual da função)\n"
+"  --size N             partículas (padrão: pso_calc_swarm_size)\n"
+"  --size-strategy const|lindec|adaptive\n"
+"                       redução do enxame (tira as piores partículas)\n"
+"  --size-min N         tamanho final do enxame na redução\n"
+"  --steps N            máximo de iterações\n"
+"  --goal X             para quando erro <= goal\n"
+"  --c1 X --c2 X        coeficientes cognitivo/social\n"
+"  --w const|lindec|apso\n"
+"                       estratégia de inércia (apso também ajusta c1/c2)\n"
+"  --w-max X --w-min X  limites da inércia linear decrescente\n"
+"  --nhood global|ring|random\n"
+"  --nhood-size N       tamanho médio da vizinhança\n"
+"  --clamp 0|1          1 = trava nas bordas, 0 = periódico\n"
+"  --noise-samples N    objetivo ruidoso: reamostragem adaptativa com até\n"
+"                       N amostras por ponto (0 = desligado)\n"
+"  --portfolio          corre as 3 vizinhanças x {lindec, apso} ao mesmo\n"
+"                       tempo, nas --threads threads (pso_portfolio.h)\n"
+"\n"
+"execução:\n"
+"  --seed N             semente (0 = relógio); execução k usa N+k\n"
+"  --runs N             número de execuções (padrão 1)\n"
+"  --threads N          threads na avaliação (settings->threads)\n"
+"  --numa               threads fixadas por nó NUMA e enxame dividido entre\n"
+"                       elas (settings->numa, pso_numa.h)\n"
+"  --format text|csv|json\n"
+"  --gbest              inclui a melhor posição na saída\n"
+"  --progress N         barra de progresso a cada N passos (só com\n"
+"                       --format text)\n"
+"  --perf               tempo e contadores de hardware por fase do passo,\n"
+"                       em stderr (pso_perf.h; ignorado com --portfolio)\n"
+"  --latency            histograma de latência do objetivo (p50/p90/p99/max)\n"
+"                       e posições mais lentas, em stderr (pso_latency.h)\n"
+"  --metrics NOME       publica passo, erro, avaliações etc. na memória\n"
+"                       compartilhada NOME (ver com pso_top NOME)\n"
+"  --trace ARQ          linha do tempo das threads em JSON (Chrome/Perfetto,\n"
+"                       pso_trace.h)\n",
+            prog);
+}
+
+
+// ============================
+//           SAÍDA
+// ============================
+
+static void print_header(int format, int with_gbest, int dim) {
+    if (format != FMT_CSV) return;
+    printf("run,seed,status,error,evals,evals_aborted,steps,time_ms,cpu_ms,evals_per_s");
+    if (with_gbest)
+        for (int d=0; d<dim; d++) printf(",gbest_%d", d);
+    printf("\n");
+}
+
+static void print_run(int format, int with_gbest, int dim, int run,
+                      unsigned int seed, const char *status,
+                      const pso_result_t *r, int steps,
+                      double wall_ms, double cpu_ms)
+{
+    double rate = wall_ms > 0 ? r->evals / (wall_ms / 1e3) : 0.0;
+
+    switch (format) {
+    case FMT_CSV:
+        printf("%d,%u,%s,%.17g,%ld,%ld,%d,%.3f,%.3f,%.0f",
+               run, seed, status, r->error, r->evals, r->evals_aborted,
+               steps, wall_ms, cpu_ms, rate);
+        if (with_gbest)
+            for (int d=0; d<dim; d++) printf(",%.17g", r->gbest[d]);
+        printf("\n");
+        break;
+
+    case FMT_JSON:
+        printf("{\"run\":%d,\"seed\":%u,\"status\":\"%s\",\"error\":%.17g,"
+               "\"evals\":%ld,\"evals_aborted\":%ld,\"steps\":%d,"
+               "\"time_ms\":%.3f,\"cpu_ms\":%.3f,\"evals_per_s\":%.0f",
+               run, seed, status, r->error, r->evals, r->evals_aborted,
+               steps, wall_ms, cpu_ms, rate);
+        if (with_gbest) {
+            printf(",\"gbest\":[");
+            for (int d=0; d<dim; d++) printf(d ? ",%.17g" : "%.17g", r->gbest[d]);
+            printf("]");
+        }
+        printf("}\n");
+        break;
+
+    default:
+        printf("run=%d seed=%u status=%s error=%.17g evals=%ld evals_aborted=%ld "
+               "steps=%d time_ms=%.3f cpu_ms=%.3f evals_per_s=%.0f",
+               run, seed, status, r->error, r->evals, r->evals_aborted,
+               steps, wall_ms, cpu_ms, rate);
+        if (with_gbest) {
+            printf(" gbest=");
+            for (int d=0; d<dim; d++) printf(d ? ",%.17g" : "%.17g", r->gbest[d]);
+        }
+        printf("\n");
+        break;
+    }
+    fflush(stdout);
+}
+
+
+// ============================
+//            MAIN
+// ============================
+
+enum {
+    OPT_FUN = 256, OPT_PLUGIN, OPT_PLUGIN_ARGS, OPT_BATCH, OPT_DIM, OPT_LO,
+    OPT_HI, OPT_SIZE, OPT_STEPS, OPT_GOAL, OPT_C1, OPT_C2, OPT_W, OPT_W_MAX,
+    OPT_W_MIN, OPT_NHOOD, OPT_NHOOD_SIZE, OPT_CLAMP, OPT_SEED, OPT_RUNS,
+    OPT_THREADS, OPT_NUMA, OPT_FORMAT, OPT_GBEST, OPT_PROGRESS, OPT_NOISE, OPT_SIZE_STRATEGY,
+    OPT_SIZE_MIN, OPT_PORTFOLIO, OPT_PERF, OPT_LATENCY, OPT_METRICS, OPT_TRACE, OPT_HELP
+};
+
+static const struct option long_opts[] = {
+    { "fun",         required_argument, NULL, OPT_FUN },
+    { "plugin",      required_argument, NULL, OPT_PLUGIN },
+    { "plugin-args", required_argument, NULL, OPT_PLUGIN_ARGS },
+    { "batch",       no_argument,       NULL, OPT_BATCH },
+    { "dim",         required_argument, NULL, OPT_DIM },
+    { "lo",          required_argument, NULL, OPT_LO },
+    { "hi",          required_argument, NULL, OPT_HI },
+    { "size",        required_argument, NULL, OPT_SIZE },
+    { "size-strategy", required_argument, NULL, OPT_SIZE_STRATEGY },
+    { "size-min",    required_argument, NULL, OPT_SIZE_MIN },
+    { "steps",       required_argument, NULL, OPT_STEPS },
+    { "goal",        required_argument, NULL, OPT_GOAL },
+    { "c1",          required_argument, NULL, OPT_C1 },
+    { "c2",          required_argument, NULL, OPT_C2 },
+    { "w",           required_argument, NULL, OPT_W },
+    { "w-max",       required_argument, NULL, OPT_W_MAX },
+    { "w-min",       required_argument, NULL, OPT_W_MIN },
+    { "nhood",       required_argument, NULL, OPT_NHOOD },
+    { "nhood-size",  required_argument, NULL, OPT_NHOOD_SIZE },
+    { "clamp",       required_argument, NULL, OPT_CLAMP },
+    { "noise-samples", required_argument, NULL, OPT_NOISE },
+    { "portfolio",   no_argument,       NULL, OPT_PORTFOLIO },
+    { "seed",        required_argument, NULL, OPT_SEED },
+    { "runs",        required_argument, NULL, OPT_RUNS },
+    { "threads",     required_argument, NULL, OPT_THREADS },
+    { "numa",        no_argument,       NULL, OPT_NUMA },
+    { "format",      required_argument, NULL, OPT_FORMAT },
+    { "gbest",       no_argument,       NULL, OPT_GBEST },
+    { "progress",    required_argument, NULL, OPT_PROGRESS },
+    { "perf",        no_argument,       NULL, OPT_PERF },
+    { "latency",     no_argument,       NULL, OPT_LATENCY },
+    { "metrics",     required_argument, NULL, OPT_METRICS },
+    { "trace",       required_argument, NULL, OPT_TRACE },
+    { "help",        no_argument,       NULL, OPT_HELP },
+    { NULL, 0, NULL, 0 }
+};
+
+// Valores lidos dos argumentos; -1 / have_* = 0 = "não informado" (fica o
+// padrão de pso_settings_new)
+typedef struct {
+    const char *fun, *plugin, *plugin_args, *trace, *metrics;
+    int batch;
+    int dim, size, steps, nhood_size, clamp, threads, runs, progress, noise;
+    int w_strategy, nhood_strategy, size_strategy, size_min;
+    double lo, hi, goal, c1, c2, w_max, w_min;
+    int have_lo, have_hi, have_goal, have_c1, have_c2, have_w_max, have_w_min;
+    unsigned int seed;
+    int format, gbest, portfolio, perf, latency, numa;
+} cli_args_t;
+
+static int parse_args(int argc, char **argv, cli_args_t *a) {
+    int c;
+
+    memset(a, 0, sizeof(*a));
+    a->dim = a->size = a->steps = a->nhood_size = a->clamp = -1;
+    a->w_strategy = a->nhood_strategy = a->size_strategy = a->size_min = -1;
+    a->threads = 1;
+    a->runs = 1;
+
+    while ((c = getopt_long(argc, argv, "", long_opts, NULL)) != -1) {
+        switch (c) {
+        case OPT_FUN:         a->fun = optarg; break;
+        case OPT_PLUGIN:      a->plugin = optarg; break;
+        case OPT_PLUGIN_ARGS: a->plugin_args = optarg; break;
+        case OPT_BATCH:       a->batch = 1; break;
+        case OPT_DIM:         a->dim = atoi(optarg); break;
+        case OPT_LO:          a->lo = atof(optarg); a->have_lo = 1; break;
+        case OPT_HI:          a->hi = atof(optarg); a->have_hi = 1; break;
+        case OPT_SIZE:        a->size = atoi(optarg); break;
+        case OPT_SIZE_MIN:    a->size_min = atoi(optarg); break;
+        case OPT_STEPS:       a->steps = atoi(optarg); break;
+        case OPT_GOAL:        a->goal = atof(optarg); a->have_goal = 1; break;
+        case OPT_C1:          a->c1 = atof(optarg); a->have_c1 = 1; break;
+        case OPT_C2:          a->c2 = atof(optarg); a->have_c2 = 1; break;
+        case OPT_W_MAX:       a->w_max = atof(optarg); a->have_w_max = 1; break;
+        case OPT_W_MIN:       a->w_min = atof(optarg); a->have_w_min = 1; break;
+        case OPT_NHOOD_SIZE:  a->nhood_size = atoi(optarg); break;
+        case OPT_CLAMP:       a->clamp = atoi(optarg) != 0; break;
+        case OPT_NOISE:       a->noise = atoi(optarg); break;
+        case OPT_SEED:        a->seed = (unsigned int)strtoul(optarg, NULL, 10); break;
+        case OPT_RUNS:        a->runs = atoi(optarg); break;
+        case OPT_THREADS:     a->threads = atoi(optarg); break;
+        case OPT_NUMA:        a->numa = 1; break;
+        case OPT_GBEST:       a->gbest = 1; break;
+        case OPT_PORTFOLIO:   a->portfolio = 1; break;
+        case OPT_PERF:        a->perf = 1; break;
+        case OPT_LATENCY:     a->latency = 1; break;
+        case OPT_METRICS:     a->metrics = optarg; break;
+        case OPT_TRACE:       a->trace = optarg; break;
+        case OPT_PROGRESS:    a->progress = atoi(optarg); break;
+        case OPT_W:
+            if      (strcmp(optarg, "const") == 0)  a->w_strategy = PSO_W_CONST;
+            else if (strcmp(optarg, "lindec") == 0) a->w_strategy = PSO_W_LIN_DEC;
+            else if (strcmp(optarg, "apso") == 0)   a->w_strategy = PSO_W_APSO;
+            else { fprintf(stderr, "--w invalido: %s\n", optarg); return -1; }
+            break;
+        case OPT_SIZE_STRATEGY:
+            if      (strcmp(optarg, "const") == 0)    a->size_strategy = PSO_SIZE_CONST;
+            else if (strcmp(optarg, "lindec") == 0)   a->size_strategy = PSO_SIZE_LIN_DEC;
+            else if (strcmp(optarg, "adaptive") == 0) a->size_strategy = PSO_SIZE_ADAPTIVE;
+            else { fprintf(stderr, "--size-strategy invalido: %s\n", optarg); return -1; }
+            break;
+        case OPT_NHOOD:
+            if      (strcmp(optarg, "global") == 0) a->nhood_strategy = PSO_NHOOD_GLOBAL;
+            else if (strcmp(optarg, "ring") == 0)   a->nhood_strategy = PSO_NHOOD_RING;
+            else if (strcmp(optarg, "random") == 0) a->nhood_strategy = PSO_NHOOD_RANDOM;
+            else { fprintf(stderr, "--nhood invalido: %s\n", optarg); return -1; }
+            break;
+        case OPT_FORMAT:
+            if      (strcmp(optarg, "text") == 0) a->format = FMT_TEXT;
+            else if (strcmp(optarg, "csv") == 0)  a->format = FMT_CSV;
+            else if (strcmp(optarg, "json") == 0) a->format = FMT_JSON;
+            else { fprintf(stderr, "--format invalido: %s\n", optarg); return -1; }
+            break;
+        case OPT_HELP:
+            usage(stdout, argv[0]);
+            exit(0);
+        default:
+            return -1;
+        }
+    }
+
+    if (optind < argc) {
+        fprintf(stderr, "argumento inesperado: %s\n", argv[optind]);
+        return -1;
+    }
+    if ((a->fun == NULL) == (a->plugin == NULL)) {
+        fprintf(stderr, "informe --fun ou --plugin (um dos dois)\n");
+        return -1;
+    }
+    if (a->dim < 1) {
+        fprintf(stderr, "--dim obrigatório (>= 1)\n");
+        return -1;
+    }
+    if (a->runs < 1) a->runs = 1;
+    return 0;
+}
+
+// Copia para settings o que foi informado na linha de comando
+static int apply_args(const cli_args_t *a, pso_settings_t *s) {
+    if (a->size > 0)            s->size = a->size;
+    if (a->size_strategy >= 0)  s->size_strategy = a->size_strategy;
+    if (a->size_min > 0)        s->size_min = a->size_min;
+    if (a->steps >= 0)          s->steps = a->steps;
+    if (a->have_goal)           s->goal = a->goal;
+    if (a->have_c1)             s->c1 = a->c1;
+    if (a->have_c2)             s->c2 = a->c2;
+    if (a->have_w_max)          s->w_max = a->w_max;
+    if (a->have_w_min)          s->w_min = a->w_min;
+    if (a->w_strategy >= 0)     s->w_strategy = a->w_strategy;
+    if (a->nhood_strategy >= 0) s->nhood_strategy = a->nhood_strategy;
+    if (a->nhood_size > 0)      s->nhood_size = a->nhood_size;
+    if (a->clamp >= 0)          s->clamp_pos = a->clamp;
+    if (a->noise > 1)           s->noise_samples = a->noise;
+    s->threads = a->threads;
+    s->numa = a->numa;
+    s->print_every = a->format == FMT_TEXT ? a->progress : 0;
+
+    if (s->size < 1 || s->size > PSO_MAX_SIZE) {
+        fprintf(stderr, "--size deve estar em 1..%d\n", PSO_MAX_SIZE);
+        return -1;
+    }
+    // o anel precisa de vizinhos distintos (init_comm_ring); é o padrão e
+    // um dos braços do portfólio
+    if (s->size < 2 && (s->nhood_strategy == PSO_NHOOD_RING || a->portfolio)) {
+        fprintf(stderr, "--size 1 exige --nhood global ou random (sem --portfolio)\n");
+        return -1;
+    }
+    if (s->nhood_size > s->size) s->nhood_size = s->size;
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    cli_args_t a;
+    pso_obj_fun_t fun = NULL;
+    pso_plugin_t *plugin = NULL;
+    pso_trace_t *trace = NULL;
+    double lo, hi;
+    int rc = 0;
+
+    if (parse_args(argc, argv, &a) != 0) {
+        usage(stderr, argv[0]);
+        return 2;
+    }
+
+    if (a.plugin != NULL) {
+        char err[256];
+        plugin = pso_plugin_load(a.plugin, a.plugin_args, err, sizeof(err));
+        if (plugin == NULL) {
+            fprintf(stderr, "%s\n", err);
+            return 1;
+        }
+        lo = pso_plugin_api(plugin)->lo;
+        hi = pso_plugin_api(plugin)->hi;
+    } else {
+        const pso_func_info_t *info = pso_funcs_find(a.fun);
+        if (info == NULL) {
+            fprintf(stderr, "função desconhecida: %s\n", a.fun);
+            return 2;
+        }
+        fun = info->fun;
+        lo = info->lo;
+        hi = info->hi;
+    }
+    if (a.have_lo) lo = a.lo;
+    if (a.have_hi) hi = a.hi;
+    if (!(lo < hi)) {
+        fprintf(stderr, "--lo deve ser menor que --hi\n");
+        return 2;
+    }
+
+    pso_settings_t *settings = pso_settings_new(a.dim, lo, hi);
+    pso_result_t result;
+    result.gbest = (double *)malloc(a.dim * sizeof(double));
+    if (settings == NULL || result.gbest == NULL || apply_args(&a, settings) != 0) {
+        rc = 2;
+        goto out;
+    }
+
+    if (a.perf && !a.portfolio && (settings->perf = pso_perf_new()) == NULL) {
+        rc = 1;
+        goto out;
+    }
+
+    if (a.latency && (settings->latency = pso_latency_new(a.dim)) == NULL) {
+        rc = 1;
+        goto out;
+    }
+
+    if (a.metrics != NULL && (settings->metrics = pso_metrics_open(a.metrics)) == NULL) {
+        fprintf(stderr, "falha ao criar a página de métricas %s\n", a.metrics);
+        rc = 1;
+        goto out;
+    }
+
+    if (a.trace != NULL) {
+        if ((trace = pso_trace_new(PSO_CLI_TRACE_EVENTS)) == NULL) {
+            rc = 1;
+            goto out;
+        }
+        pso_trace_thread_name("main");
+        pso_trace_start(trace);
+    }
+
+    print_header(a.format, a.gbest, a.dim);
+    unsigned int base_seed = a.seed ? a.seed : (unsigned int)time(NULL);
+
+    for (int run=0; run<a.runs; run++) {
+        settings->seed = base_seed + run;
+
+        double t0 = now_ns(), c0 = cpu_ns();
+        pso_state_t *st;
+
+        if (settings->perf != NULL) pso_perf_reset(settings->perf);
+        if (settings->latency != NULL) pso_latency_reset(settings->latency);
+
+        if (a.portfolio) {
+            pso_portfolio_stats_t stats[PSO_PORTFOLIO_DEFAULT_ARMS];
+            int steps = 0, n;
+            if (plugin != NULL && a.batch)
+                n = pso_portfolio_solve_batch(pso_plugin_batch, plugin, settings, NULL, 0,
+                                              a.threads, 0, &result, stats);
+            else if (plugin != NULL)
+                n = pso_portfolio_solve(pso_plugin_eval, plugin, settings, NULL, 0,
+                                        a.threads, 0, &result, stats);
+            else
+                n = pso_portfolio_solve(fun, NULL, settings, NULL, 0,
+                                        a.threads, 0, &result, stats);
+            if (n < 0) {
+                fprintf(stderr, "falha ao criar o portfólio\n");
+                rc = 1;
+                break;
+            }
+            for (int k=0; k<n; k++) if (stats[k].steps > steps) steps = stats[k].steps;
+            double wall_ms = (now_ns() - t0) / 1e6, cpu_ms = (cpu_ns() - c0) / 1e6;
+            print_run(a.format, a.gbest, a.dim, run, settings->seed,
+                      result.error <= settings->goal ? "goal" : "done",
+                      &result, steps, wall_ms, cpu_ms);
+            if (settings->latency != NULL) {
+                fprintf(stderr, "# execução %d: latência do objetivo\n", run);
+                pso_latency_print(stderr, settings->latency);
+            }
+            continue;
+        }
+
+        if (plugin != NULL && a.batch)
+            st = pso_state_new_batch(pso_plugin_batch, plugin, &result, settings);
+        else if (plugin != NULL)
+            st = pso_state_new(pso_plugin_eval, plugin, &result, settings);
+        else
+            st = pso_state_new(fun, NULL, &result, settings);
+        if (st == NULL) {
+            fprintf(stderr, "falha ao criar o estado do PSO\n");
+            rc = 1;
+            break;
+        }
+        pso_state_step(st, settings->steps);
+        int steps = pso_state_steps_done(st);
+        pso_state_free(st);
+        double wall_ms = (now_ns() - t0) / 1e6, cpu_ms = (cpu_ns() - c0) / 1e6;
+
+        print_run(a.format, a.gbest, a.dim, run, settings->seed,
+                  result.error <= settings->goal ? "goal" : "done",
+                  &result, steps, wall_ms, cpu_ms);
+        if (settings->perf != NULL) {
+            fprintf(stderr, "# execução %d: fases\n", run);
+            pso_perf_print(stderr, settings->perf);
+        }
+        if (settings->latency != NULL) {
+            fprintf(stderr, "# execução %d: latência do objetivo\n", run);
+            pso_latency_print(stderr, settings->latency);
+        }
+    }
+
+    if (trace != NULL) {
+        pso_trace_stop(trace);
+        if (pso_trace_write(trace, a.trace) != 0) {
+            fprintf(stderr, "falha ao gravar %s\n", a.trace);
+            rc = 1;
+        } else if (pso_trace_dropped(trace) > 0) {
+            fprintf(stderr, "traço: %ld eventos antigos sobrescritos\n",
+                    pso_trace_dropped(trace));
+        }
+    }
+
+out:
+    free(result.gbest);
+    pso_trace_free(trace);
+    if (settings) {
+        pso_perf_free(settings->perf);
+        pso_latency_free(settings->latency);
+        pso_metrics_close(settings->metrics, 1);
+        pso_settings_free(settings);
+    }
+    if (plugin) pso_plugin_unload(plugin);
+    return rc;
+}
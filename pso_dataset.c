@@ -0,0 +1,317 @@
+/* Objetivos sobre conjuntos de dados (mmap + mini-lotes)
+*/
+
+#include <stdio.h>      // fopen(), snprintf()
+#include <stdlib.h>     // malloc(), free(), qsort()
+#include <limits.h>     // INT_MAX
+#include <string.h>
+#include <math.h>       // HUGE_VAL
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "pso_dataset.h"
+#include "pso_rng.h"
+
+// Candidatas não confirmadas seguidas antes de o mini-lote crescer
+#define PSO_DATASET_PATIENCE 3
+
+struct pso_dataset {
+    void *map;
+    size_t map_len;
+    long nrows;
+    int ncols;
+    const double **cols;
+};
+
+struct pso_dataset_obj {
+    pthread_mutex_t lock;
+    const pso_dataset_t *ds;
+    pso_dataset_loss_t loss;
+    void *params;
+
+    long nblocks;          // blocos de PSO_DATASET_BLOCK linhas
+    long batch_blocks;     // tamanho atual do mini-lote (em blocos)
+    double grow;
+    long *perm;            // permutação parcial para o sorteio sem repetição
+    pso_rng_t rng;
+    long calls;
+    int misses;            // candidatas seguidas não confirmadas
+
+    pso_dataset_stats_t stats;
+};
+
+
+static int host_is_le(void) {
+    const uint16_t one = 1;
+    return *(const unsigned char *)&one == 1;
+}
+
+static void put_u32(unsigned char *p, uint32_t v) {
+    for (int k=0; k<4; k++) p[k] = (unsigned char)(v >> (8 * k));
+}
+
+static uint32_t get_u32(const unsigned char *p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static uint64_t get_u64(const unsigned char *p) {
+    return (uint64_t)get_u32(p) | (uint64_t)get_u32(p + 4) << 32;
+}
+
+
+// ============================
+//          ARQUIVO
+// ============================
+
+int pso_dataset_write(const char *path, const double *const *cols,
+                      int ncols, long nrows)
+{
+    unsigned char hdr[PSO_DATASET_HDR];
+    FILE *f;
+
+    if (!host_is_le()) { errno = ENOTSUP; return -1; }
+    memset(hdr, 0, sizeof(hdr));
+    put_u32(hdr, PSO_DATASET_MAGIC);
+    put_u32(hdr + 4, 1);
+    put_u32(hdr + 8, (uint32_t)ncols);
+    put_u32(hdr + 16, (uint32_t)((uint64_t)nrows));
+    put_u32(hdr + 20, (uint32_t)((uint64_t)nrows >> 32));
+
+    if ((f = fopen(path, "wb")) == NULL) return -1;
+    int ok = fwrite(hdr, 1, sizeof(hdr), f) == sizeof(hdr);
+    for (int j=0; ok && j<ncols; j++)
+        ok = fwrite(cols[j], sizeof(double), (size_t)nrows, f) == (size_t)nrows;
+    if (fclose(f) != 0) ok = 0;
+    return ok ? 0 : -1;
+}
+
+pso_dataset_t *pso_dataset_open(const char *path, char *err, int errlen) {
+    struct stat st;
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        snprintf(err, errlen, "%s: %s", path, strerror(errno));
+        if (fd >= 0) close(fd);
+        return NULL;
+    }
+    if (!host_is_le() || st.st_size < PSO_DATASET_HDR) {
+        snprintf(err, errlen, "%s: arquivo invalido", path);
+        close(fd);
+        return NULL;
+    }
+
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        snprintf(err, errlen, "%s: mmap: %s", path, strerror(errno));
+        return NULL;
+    }
+
+    const unsigned char *h = (const unsigned char *)map;
+    uint32_t ncols = get_u32(h + 8);
+    uint64_t nrows = get_u64(h + 16);
+    // nrows é limitado pelo tamanho real antes de multiplicar: um
+    // produto que dá a volta em 64 bits poderia bater com o tamanho e
+    // deixar colunas fora do mapeamento
+    if (get_u32(h) != PSO_DATASET_MAGIC || get_u32(h + 4) != 1 || ncols > INT_MAX ||
+        nrows > ((uint64_t)st.st_size - PSO_DATASET_HDR) / sizeof(double) / (ncols ? ncols : 1) ||
+        (uint64_t)st.st_size != PSO_DATASET_HDR + (uint64_t)ncols * nrows * sizeof(double)) {
+        snprintf(err, errlen, "%s: cabecalho invalido ou tamanho incorreto", path);
+        munmap(map, (size_t)st.st_size);
+        return NULL;
+    }
+
+    pso_dataset_t *ds = (pso_dataset_t *)malloc(sizeof(pso_dataset_t));
+    if (ds == NULL || (ds->cols = (const double **)malloc((ncols ? ncols : 1) *
+                                                          sizeof(double *))) == NULL) {
+        snprintf(err, errlen, "%s: sem memoria", path);
+        free(ds);
+        munmap(map, (size_t)st.st_size);
+        return NULL;
+    }
+    ds->map = map;
+    ds->map_len = (size_t)st.st_size;
+    ds->nrows = (long)nrows;
+    ds->ncols = (int)ncols;
+    for (uint32_t j=0; j<ncols; j++)
+        ds->cols[j] = (const double *)(h + PSO_DATASET_HDR) + (size_t)j * nrows;
+    return ds;
+}
+
+void pso_dataset_close(pso_dataset_t *ds) {
+    munmap(ds->map, ds->map_len);
+    free(ds->cols);
+    free(ds);
+}
+
+long pso_dataset_rows(const pso_dataset_t *ds) { return ds->nrows; }
+int pso_dataset_cols(const pso_dataset_t *ds) { return ds->ncols; }
+
+const double *pso_dataset_col(const pso_dataset_t *ds, int j) {
+    return ds->cols[j];
+}
+
+
+// ============================
+//      OBJETIVO EM MINI-LOTE
+// ============================
+
+pso_dataset_obj_t *pso_dataset_obj_new(const pso_dataset_t *ds,
+                                       pso_dataset_loss_t loss, void *params,
+                                       long batch_rows, double grow,
+                                       uint64_t seed)
+{
+    pso_dataset_obj_t *o = (pso_dataset_obj_t *)calloc(1, sizeof(pso_dataset_obj_t));
+    if (o == NULL) return NULL;
+
+    o->ds = ds;
+    o->loss = loss;
+    o->params = params;
+    o->nblocks = (ds->nrows + PSO_DATASET_BLOCK - 1) / PSO_DATASET_BLOCK;
+    o->batch_blocks = batch_rows > 0
+                    ? (batch_rows + PSO_DATASET_BLOCK - 1) / PSO_DATASET_BLOCK
+                    : o->nblocks;
+    if (o->batch_blocks > o->nblocks) o->batch_blocks = o->nblocks;
+    o->grow = grow > 1.0 ? grow : 2.0;
+    o->rng = pso_rng_new(seed);
+    o->perm = (long *)malloc((o->nblocks ? o->nblocks : 1) * sizeof(long));
+    for (long b=0; b<o->nblocks; b++) o->perm[b] = b;
+    pthread_mutex_init(&o->lock, NULL);
+
+    o->stats.best_full = HUGE_VAL;
+    o->stats.batch_rows = o->batch_blocks * PSO_DATASET_BLOCK;
+    return o;
+}
+
+void pso_dataset_obj_free(pso_dataset_obj_t *o) {
+    pthread_mutex_destroy(&o->lock);
+    free(o->perm);
+    free(o);
+}
+
+void pso_dataset_obj_stats(pso_dataset_obj_t *o, pso_dataset_stats_t *stats) {
+    pthread_mutex_lock(&o->lock);
+    *stats = o->stats;
+    if (stats->batch_rows > o->ds->nrows) stats->batch_rows = o->ds->nrows;
+    pthread_mutex_unlock(&o->lock);
+}
+
+// perda média nos dados completos
+static double full_loss(pso_dataset_obj_t *o, const double *x, int dim) {
+    if (o->ds->nrows == 0) return 0.0;
+    return o->loss(x, dim, o->ds, 0, o->ds->nrows, o->params) / o->ds->nrows;
+}
+
+double pso_dataset_full(pso_dataset_obj_t *o, const double *x, int dim) {
+    double f = full_loss(o, x, dim);
+    pthread_mutex_lock(&o->lock);
+    o->stats.full_evals++;
+    o->stats.rows_read += o->ds->nrows;
+    pthread_mutex_unlock(&o->lock);
+    return f;
+}
+
+static int cmp_long(const void *a, const void *b) {
+    long x = *(const long *)a, y = *(const long *)b;
+    return (x > y) - (x < y);
+}
+
+void pso_dataset_batch(double **x, int dim, int n, double *fit, void *params) {
+    pso_dataset_obj_t *o = (pso_dataset_obj_t *)params;
+    const pso_dataset_t *ds = o->ds;
+    long m, rows = 0, rows_read = 0, *blocks;
+    double best;
+    int full;
+
+    // sorteia o mini-lote: m blocos distintos (Fisher-Yates parcial),
+    // em ordem crescente para percorrer o arquivo para a frente
+    pthread_mutex_lock(&o->lock);
+    m = o->batch_blocks;
+    full = m >= o->nblocks;
+    blocks = (long *)malloc((m ? m : 1) * sizeof(long));
+    if (!full) {
+        for (long k=0; k<m; k++) {
+            uint32_t ctr[4] = { (uint32_t)o->calls, (uint32_t)k,
+                                (uint32_t)(o->calls >> 32), PSO_RNG_DATA };
+            uint32_t out[4];
+            pso_philox4x32(ctr, o->rng.key, out);
+            long j = k + (long)(pso_rng_u53(out[0], out[1]) * (o->nblocks - k));
+            long t = o->perm[k]; o->perm[k] = o->perm[j]; o->perm[j] = t;
+            blocks[k] = o->perm[k];
+        }
+        o->calls++;
+    }
+    best = o->stats.best_full;
+    pthread_mutex_unlock(&o->lock);
+
+    if (full) {
+        for (int i=0; i<n; i++) {
+            fit[i] = full_loss(o, x[i], dim);
+            if (fit[i] < best) best = fit[i];
+        }
+        pthread_mutex_lock(&o->lock);
+        o->stats.full_evals += n;
+        o->stats.rows_read += (long)n * ds->nrows;
+        if (best < o->stats.best_full) o->stats.best_full = best;
+        pthread_mutex_unlock(&o->lock);
+        free(blocks);
+        return;
+    }
+
+    qsort(blocks, m, sizeof(long), cmp_long);
+    for (long k=0; k<m; k++) {
+        long first = blocks[k] * PSO_DATASET_BLOCK;
+        rows += first + PSO_DATASET_BLOCK <= ds->nrows ? PSO_DATASET_BLOCK : ds->nrows - first;
+    }
+
+    // estimativa no mini-lote
+    for (int i=0; i<n; i++) {
+        double sum = 0.0;
+        for (long k=0; k<m; k++) {
+            long first = blocks[k] * PSO_DATASET_BLOCK;
+            long count = first + PSO_DATASET_BLOCK <= ds->nrows ? PSO_DATASET_BLOCK : ds->nrows - first;
+            sum += o->loss(x[i], dim, ds, first, count, o->params);
+        }
+        fit[i] = sum / rows;
+    }
+    rows_read = (long)n * rows;
+    free(blocks);
+
+    // a melhor estimativa abaixo do melhor erro completo é confirmada nos
+    // dados completos; as demais candidatas valem o melhor erro (podem
+    // virar pbest, mas nunca tomam o lugar de um gbest confirmado)
+    int top = -1, nfull = 0, confirmed = 0;
+    for (int i=0; i<n; i++)
+        if (fit[i] < best && (top < 0 || fit[i] < fit[top])) top = i;
+    if (top >= 0) {
+        fit[top] = full_loss(o, x[top], dim);
+        rows_read += ds->nrows;
+        nfull = 1;
+        if (fit[top] < best) { best = fit[top]; confirmed = 1; }
+        for (int i=0; i<n; i++)
+            if (i != top && fit[i] < best) fit[i] = best;
+    }
+
+    pthread_mutex_lock(&o->lock);
+    o->stats.evals += n;
+    o->stats.full_evals += nfull;
+    o->stats.rows_read += rows_read;
+    if (best < o->stats.best_full) o->stats.best_full = best;
+    // alarmes falsos seguidos: o ruído do mini-lote já é da ordem das
+    // diferenças entre as posições, cresce o mini-lote
+    if (confirmed) o->misses = 0;
+    else if (nfull > 0 && ++o->misses >= PSO_DATASET_PATIENCE &&
+             o->batch_blocks < o->nblocks) {
+        o->misses = 0;
+        // ao menos um bloco a mais (grow pequeno não arredondaria)
+        long grown = (long)(o->batch_blocks * o->grow + 0.5);
+        o->batch_blocks = grown > o->batch_blocks ? grown : o->batch_blocks + 1;
+        if (o->batch_blocks > o->nblocks) o->batch_blocks = o->nblocks;
+        o->stats.batch_rows = o->batch_blocks * PSO_DATASET_BLOCK;
+    }
+    pthread_mutex_unlock(&o->lock);
+}
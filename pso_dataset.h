@@ -0,0 +1,113 @@
+/* Objetivos sobre conjuntos de dados (mmap + mini-lotes)
+
+   Para ajustar parâmetros de um modelo a um conjunto de dados grande sem
+   ler tudo a cada avaliação:
+
+   - o arquivo é mapeado na memória (mmap, somente leitura) uma única vez
+     e compartilhado entre as threads;
+   - cada chamada do objetivo em lote sorteia um mini-lote (blocos de
+     PSO_DATASET_BLOCK linhas consecutivas) e avalia todas as posições
+     nele, de modo que as posições de um mesmo passo são comparadas nos
+     mesmos dados;
+   - posições cuja estimativa bate o melhor erro já medido nos dados
+     completos (candidatas a gbest) são reavaliadas nos dados completos,
+     e é esse valor exato que o solver recebe;
+   - quando nenhuma candidata se confirma, o ruído do mini-lote está
+     enganando o enxame (ele convergiu até a escala do ruído) e o
+     mini-lote cresce.
+
+   Formato do arquivo (little-endian, colunar):
+     cabeçalho de 64 bytes: magic "PSOD" (0x444F5350), versão (1),
+     ncols (u32), reservado (u32), nrows (u64), zeros até 64 bytes;
+     em seguida ncols colunas de nrows doubles cada.
+   Se as linhas estiverem ordenadas (por tempo, por classe), embaralhe ao
+   gravar: o mini-lote sorteia blocos de linhas consecutivas.
+
+     pso_dataset_t *ds = pso_dataset_open("dados.psod", err, sizeof(err));
+     pso_dataset_obj_t *o = pso_dataset_obj_new(ds, minha_perda, NULL,
+                                                4096, 2.0, 1);
+     settings->threads = 1;   // um mini-lote por passo (ver abaixo)
+     pso_solve_batch(pso_dataset_batch, o, &result, settings);
+*/
+
+#ifndef PSO_DATASET_H_
+#define PSO_DATASET_H_
+
+#include <stdint.h>
+
+#include "pso.h"
+
+#define PSO_DATASET_MAGIC 0x444F5350u   // "PSOD"
+#define PSO_DATASET_HDR   64
+
+// Granularidade do sorteio: 512 doubles = uma página de 4 KB por coluna
+#define PSO_DATASET_BLOCK 512
+
+// Estruturas opacas (ver pso_dataset.c)
+typedef struct pso_dataset pso_dataset_t;
+typedef struct pso_dataset_obj pso_dataset_obj_t;
+
+// Perda de x somada sobre as linhas [first, first + count).
+// As colunas são lidas com pso_dataset_col (ex.: col[j][first + i]).
+typedef double (*pso_dataset_loss_t)(const double *x, int dim,
+                                     const pso_dataset_t *ds,
+                                     long first, long count, void *params);
+
+typedef struct {
+    long evals;        // avaliações em mini-lote
+    long full_evals;   // reavaliações nos dados completos
+    long rows_read;    // linhas percorridas (mini-lotes + completas)
+    long batch_rows;   // tamanho atual do mini-lote
+    double best_full;  // melhor perda média medida nos dados completos
+} pso_dataset_stats_t;
+
+
+// ============================
+//          ARQUIVO
+// ============================
+
+// Grava as colunas no formato acima. Retorna 0 ou -1 (errno).
+int pso_dataset_write(const char *path, const double *const *cols,
+                      int ncols, long nrows);
+
+// Mapeia o arquivo. Retorna NULL (e o motivo em err) se falhar.
+pso_dataset_t *pso_dataset_open(const char *path, char *err, int errlen);
+
+void pso_dataset_close(pso_dataset_t *ds);
+
+long pso_dataset_rows(const pso_dataset_t *ds);
+int pso_dataset_cols(const pso_dataset_t *ds);
+
+// Coluna j (nrows doubles)
+const double *pso_dataset_col(const pso_dataset_t *ds, int j);
+
+
+// ============================
+//      OBJETIVO EM MINI-LOTE
+// ============================
+
+// batch_rows: linhas do mini-lote inicial (arredondado para blocos;
+//             <= 0 ou >= nrows avalia sempre os dados completos)
+// grow:       fator de crescimento do mini-lote (ex.: 2.0)
+// seed:       semente do sorteio dos blocos
+// O fitness é a perda média por linha (mini-lote e completa são comparáveis).
+pso_dataset_obj_t *pso_dataset_obj_new(const pso_dataset_t *ds,
+                                       pso_dataset_loss_t loss, void *params,
+                                       long batch_rows, double grow,
+                                       uint64_t seed);
+
+void pso_dataset_obj_free(pso_dataset_obj_t *obj);
+
+// Função objetivo em lote para pso_solve_batch (params = obj).
+// Pode ser chamada de várias threads, mas cada chamada sorteia seu
+// próprio mini-lote: com settings->threads > 1 as partes do enxame de um
+// mesmo passo são comparadas em dados diferentes.
+void pso_dataset_batch(double **x, int dim, int n, double *fit, void *obj);
+
+// Perda média de x nos dados completos (ex.: para relatar o gbest)
+double pso_dataset_full(pso_dataset_obj_t *obj, const double *x, int dim);
+
+// Copia os contadores atuais
+void pso_dataset_obj_stats(pso_dataset_obj_t *obj, pso_dataset_stats_t *stats);
+
+#endif // PSO_DATASET_H_
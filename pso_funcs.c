@@ -0,0 +1,77 @@
+/* Funções de teste clássicas (benchmarks de otimização)
+*/
+
+#include <math.h>     // cos(), sqrt(), exp()
+#include <string.h>   // strcmp()
+
+#include "pso_funcs.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+
+double pso_sphere(double *x, int dim, void *p) {
+    (void)p;
+    double s=0.0;
+    for(int i=0;i<dim;i++) s += x[i]*x[i];
+    return s;
+}
+
+double pso_rosenbrock(double *x, int dim, void *p) {
+    (void)p;
+    if (dim < 2) return 1e9; // evita caso degenerado
+    double s=0.0;
+    for(int i=0;i<dim-1;i++){
+        double a = x[i+1] - x[i]*x[i];
+        double b = 1.0 - x[i];
+        s += 100.0*a*a + b*b;
+    }
+    return s;
+}
+
+double pso_griewank(double *x, int dim, void *p) {
+    (void)p;
+    double sum=0.0, prod=1.0;
+    for(int i=0;i<dim;i++){
+        sum += x[i]*x[i];
+        prod *= cos(x[i]/sqrt(i+1.0));
+    }
+    return sum/4000.0 - prod + 1.0;
+}
+
+double pso_rastrigin(double *x, int dim, void *p) {
+    (void)p;
+    double s = 10.0*dim;
+    for(int i=0;i<dim;i++)
+        s += x[i]*x[i] - 10.0*cos(2.0*M_PI*x[i]);
+    return s;
+}
+
+double pso_ackley(double *x, int dim, void *p) {
+    (void)p;
+    double a=20.0, b=0.2, c=2.0*M_PI;
+    double s1=0.0, s2=0.0;
+    for(int i=0;i<dim;i++){
+        s1 += x[i]*x[i];
+        s2 += cos(c*x[i]);
+    }
+    return -a*exp(-b*sqrt(s1/dim)) - exp(s2/dim) + a + exp(1.0);
+}
+
+
+const pso_func_info_t pso_funcs[] = {
+    { "sphere",     pso_sphere,     -100.0,  100.0  },
+    { "rosenbrock", pso_rosenbrock, -2.048,  2.048  },
+    { "griewank",   pso_griewank,   -600.0,  600.0  },
+    { "rastrigin",  pso_rastrigin,  -5.12,   5.12   },
+    { "ackley",     pso_ackley,     -32.0,   32.0   },
+    { NULL,         NULL,           0.0,     0.0    }
+};
+
+const pso_func_info_t *pso_funcs_find(const char *name) {
+    for (int k=0; pso_funcs[k].name != NULL; k++)
+        if (strcmp(pso_funcs[k].name, name) == 0)
+            return &pso_funcs[k];
+    return NULL;
+}
@@ -0,0 +1,31 @@
+/* Funções de teste clássicas (benchmarks de otimização)
+
+   Usadas pelo demo, pelo servidor e por quem quiser escolher uma função
+   objetivo pelo nome.
+*/
+
+#ifndef PSO_FUNCS_H_
+#define PSO_FUNCS_H_
+
+#include "pso.h"
+
+// Descrição de uma função de teste
+typedef struct {
+    const char *name;     // nome curto ("sphere", "rastrigin", ...)
+    pso_obj_fun_t fun;
+    double lo, hi;        // domínio usual (mesmo para todas as dimensões)
+} pso_func_info_t;
+
+double pso_sphere(double *x, int dim, void *p);
+double pso_rosenbrock(double *x, int dim, void *p);
+double pso_griewank(double *x, int dim, void *p);
+double pso_rastrigin(double *x, int dim, void *p);
+double pso_ackley(double *x, int dim, void *p);
+
+// Tabela das funções, terminada por um item com name == NULL
+extern const pso_func_info_t pso_funcs[];
+
+// Procura uma função pelo nome (NULL se não existir)
+const pso_func_info_t *pso_funcs_find(const char *name);
+
+#endif // PSO_FUNCS_H_
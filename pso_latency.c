@@ -0,0 +1,278 @@
+/* Latência da função objetivo (histograma e avaliações mais lentas)
+*/
+
+#define _POSIX_C_SOURCE 200809L   // clock_gettime()
+
+#include <stdlib.h>     // malloc(), free(), qsort()
+#include <string.h>
+#include <time.h>       // clock_gettime()
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "pso_latency.h"
+
+// Faixas: valores < 2*SUB têm faixa própria; acima, SUB subfaixas por
+// potência de 2 (a mantissa são os SUB_BITS+1 bits mais altos)
+#define SUB_BITS 5
+#define SUB (1 << SUB_BITS)
+#define NBUCKETS (2 * SUB + (63 - SUB_BITS) * SUB)
+
+// Histograma de uma thread (só ela escreve)
+typedef struct lat_buf {
+    struct lat_buf *next;
+    const void *owner;          // &tls_token da thread dona
+    uint64_t hist[NBUCKETS];
+    long count;
+    double sum;
+    uint64_t min, max;
+    int nslow;
+    uint64_t slow_ns[PSO_LATENCY_SLOWEST];
+    uint64_t slow_floor;        // menor de slow_ns quando cheio
+    double *slow_pos;           // PSO_LATENCY_SLOWEST x dim
+} lat_buf_t;
+
+struct pso_latency {
+    int dim;
+    unsigned long id;
+    pthread_mutex_t lock;       // só no registro de threads
+    lat_buf_t *bufs;
+    uint64_t hist[NBUCKETS];    // soma das threads (stats)
+    double *merged;             // posições mais lentas de todas (stats)
+};
+
+static atomic_ulong next_id = 1;
+
+static _Thread_local char tls_token;
+static _Thread_local lat_buf_t *tls_buf;
+static _Thread_local unsigned long tls_id;
+
+
+static int bucket_of(uint64_t v) {
+    if (v < 2 * SUB) return (int)v;
+    int shift = 63 - __builtin_clzll(v) - SUB_BITS;
+    return 2 * SUB + (shift - 1) * SUB + (int)((v >> shift) - SUB);
+}
+
+// maior valor que cai na faixa b
+static uint64_t bucket_hi(int b) {
+    if (b < 2 * SUB) return (uint64_t)b;
+    int shift = (b - 2 * SUB) / SUB + 1;
+    uint64_t mant = SUB + (uint64_t)((b - 2 * SUB) % SUB);
+    return ((mant + 1) << shift) - 1;
+}
+
+// Histograma da thread atual (procura um já registrado por ela antes de
+// criar: a mesma thread pode alternar entre coletores)
+static lat_buf_t *thread_buf(pso_latency_t *l) {
+    lat_buf_t *b;
+
+    if (tls_id == l->id) return tls_buf;
+
+    pthread_mutex_lock(&l->lock);
+    for (b=l->bufs; b!=NULL; b=b->next)
+        if (b->owner == &tls_token) break;
+    if (b == NULL && (b = (lat_buf_t *)calloc(1, sizeof(lat_buf_t))) != NULL) {
+        b->slow_pos = (double *)malloc(PSO_LATENCY_SLOWEST * l->dim * sizeof(double));
+        if (b->slow_pos == NULL) {
+            free(b);
+            b = NULL;
+        } else {
+            b->owner = &tls_token;
+            b->min = UINT64_MAX;
+            b->next = l->bufs;
+            l->bufs = b;
+        }
+    }
+    pthread_mutex_unlock(&l->lock);
+
+    if (b != NULL) {
+        tls_buf = b;
+        tls_id = l->id;
+    }
+    return b;
+}
+
+// Guarda (ns, x) se estiver entre as mais lentas da thread
+static void keep_slow(lat_buf_t *b, int dim, uint64_t ns, const double *x) {
+    int k = b->nslow;
+
+    if (k == PSO_LATENCY_SLOWEST) {
+        if (ns <= b->slow_floor) return;
+        // substitui a mais rápida das guardadas
+        for (k=0; b->slow_ns[k] != b->slow_floor; k++) ;
+    } else {
+        b->nslow++;
+    }
+    b->slow_ns[k] = ns;
+    memcpy(b->slow_pos + k * dim, x, dim * sizeof(double));
+
+    if (b->nslow == PSO_LATENCY_SLOWEST) {
+        b->slow_floor = b->slow_ns[0];
+        for (k=1; k<b->nslow; k++)
+            if (b->slow_ns[k] < b->slow_floor) b->slow_floor = b->slow_ns[k];
+    }
+}
+
+
+// ============================
+//         API PÚBLICA
+// ============================
+
+pso_latency_t *pso_latency_new(int dim) {
+    pso_latency_t *l = (pso_latency_t *)calloc(1, sizeof(pso_latency_t));
+
+    if (l == NULL) return NULL;
+    l->dim = dim;
+    l->id = atomic_fetch_add(&next_id, 1);
+    l->merged = (double *)malloc(PSO_LATENCY_SLOWEST * dim * sizeof(double));
+    if (l->merged == NULL) {
+        free(l);
+        return NULL;
+    }
+    pthread_mutex_init(&l->lock, NULL);
+    return l;
+}
+
+void pso_latency_free(pso_latency_t *lat) {
+    lat_buf_t *b, *next;
+
+    if (lat == NULL) return;
+    for (b=lat->bufs; b!=NULL; b=next) {
+        next = b->next;
+        free(b->slow_pos);
+        free(b);
+    }
+    pthread_mutex_destroy(&lat->lock);
+    free(lat->merged);
+    free(lat);
+}
+
+void pso_latency_reset(pso_latency_t *lat) {
+    for (lat_buf_t *b=lat->bufs; b!=NULL; b=b->next) {
+        memset(b->hist, 0, sizeof(b->hist));
+        b->count = 0;
+        b->sum = 0.0;
+        b->min = UINT64_MAX;
+        b->max = 0;
+        b->nslow = 0;
+    }
+}
+
+uint64_t pso_latency_begin(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+void pso_latency_end(pso_latency_t *lat, uint64_t t0, int n, const double *x) {
+    uint64_t t = pso_latency_begin(), ns;
+    lat_buf_t *b;
+
+    if (n < 1 || (b = thread_buf(lat)) == NULL) return;
+    ns = (t - t0) / (uint64_t)n;
+
+    b->hist[bucket_of(ns)] += n;
+    b->count += n;
+    b->sum += (double)(t - t0);
+    if (ns < b->min) b->min = ns;
+    if (ns > b->max) b->max = ns;
+    if (n == 1 && x != NULL) keep_slow(b, lat->dim, ns, x);
+}
+
+// candidata a mais lenta (merge das threads)
+typedef struct {
+    uint64_t ns;
+    const double *pos;
+} slow_t;
+
+static int cmp_slow(const void *a, const void *b) {
+    uint64_t x = ((const slow_t *)a)->ns, y = ((const slow_t *)b)->ns;
+    return (x < y) - (x > y); // decrescente
+}
+
+void pso_latency_stats(pso_latency_t *lat, pso_latency_stats_t *stats) {
+    const double q[3] = { 0.50, 0.90, 0.99 };
+    double *pct[3] = { &stats->p50, &stats->p90, &stats->p99 };
+    uint64_t min = UINT64_MAX, max = 0, seen = 0;
+    double sum = 0.0;
+    slow_t *cand;
+    lat_buf_t *b;
+    int k, j, n = 0;
+
+    memset(stats, 0, sizeof(*stats));
+    memset(lat->hist, 0, sizeof(lat->hist));
+    for (b=lat->bufs; b!=NULL; b=b->next) {
+        for (k=0; k<NBUCKETS; k++) lat->hist[k] += b->hist[k];
+        stats->count += b->count;
+        sum += b->sum;
+        if (b->count > 0 && b->min < min) min = b->min;
+        if (b->max > max) max = b->max;
+        n += b->nslow;
+    }
+    if (stats->count == 0) return;
+
+    stats->mean = sum / stats->count;
+    stats->min = (double)min;
+    stats->max = (double)max;
+
+    // percentil q: faixa em que a contagem acumulada chega a q * count
+    for (k=0, j=0; k<NBUCKETS && j<3; k++) {
+        seen += lat->hist[k];
+        while (j < 3 && seen > 0 && seen >= (uint64_t)(q[j] * stats->count + 0.5)) {
+            double v = (double)bucket_hi(k);
+            *pct[j++] = v < stats->max ? v : stats->max;
+        }
+    }
+
+    // mais lentas de todas as threads
+    if (n == 0 || (cand = (slow_t *)malloc(n * sizeof(slow_t))) == NULL) return;
+    n = 0;
+    for (b=lat->bufs; b!=NULL; b=b->next)
+        for (j=0; j<b->nslow; j++) {
+            cand[n].ns = b->slow_ns[j];
+            cand[n++].pos = b->slow_pos + j * lat->dim;
+        }
+    qsort(cand, n, sizeof(slow_t), cmp_slow);
+    for (k=0; k<n && k<PSO_LATENCY_SLOWEST; k++) {
+        stats->slow_ns[k] = (double)cand[k].ns;
+        memcpy(lat->merged + k * lat->dim, cand[k].pos, lat->dim * sizeof(double));
+        stats->slow_pos[k] = lat->merged + k * lat->dim;
+        stats->nslow++;
+    }
+    free(cand);
+}
+
+// ns em unidade legível
+static void print_ns(FILE *f, const char *label, double ns) {
+    if (ns < 1e3)      fprintf(f, " %s=%.0fns", label, ns);
+    else if (ns < 1e6) fprintf(f, " %s=%.1fus", label, ns / 1e3);
+    else if (ns < 1e9) fprintf(f, " %s=%.1fms", label, ns / 1e6);
+    else               fprintf(f, " %s=%.2fs", label, ns / 1e9);
+}
+
+void pso_latency_print(FILE *f, pso_latency_t *lat) {
+    pso_latency_stats_t st;
+    int k, d;
+
+    pso_latency_stats(lat, &st);
+    fprintf(f, "avaliações=%ld", st.count);
+    if (st.count == 0) {
+        fprintf(f, "\n");
+        return;
+    }
+    print_ns(f, "média", st.mean);
+    print_ns(f, "p50", st.p50);
+    print_ns(f, "p90", st.p90);
+    print_ns(f, "p99", st.p99);
+    print_ns(f, "max", st.max);
+    fprintf(f, " p99/p50=%.1f\n", st.p50 > 0 ? st.p99 / st.p50 : 0.0);
+
+    for (k=0; k<st.nslow; k++) {
+        fprintf(f, " ");
+        print_ns(f, "lenta", st.slow_ns[k]);
+        fprintf(f, " x=(");
+        for (d=0; d<lat->dim && d<4; d++)
+            fprintf(f, "%s%.4g", d ? ", " : "", st.slow_pos[k][d]);
+        fprintf(f, "%s)\n", lat->dim > 4 ? ", ..." : "");
+    }
+}
@@ -0,0 +1,75 @@
+/* Latência da função objetivo (histograma e avaliações mais lentas)
+
+   Quando o custo do objetivo varia muito de uma região para outra, a
+   média não basta para escolher o modo de avaliação: com custo estável e
+   baixo, lote (pso_solve_batch) amortiza a chamada; com cauda longa, as
+   threads ficam esperando a mais lenta de cada passo e blocos menores ou
+   avaliação assíncrona (pso_async.h) rendem mais.
+
+   Com settings->latency != NULL cada chamada do objetivo é cronometrada
+   num histograma de faixas logarítmicas (estilo HDR: 32 subfaixas por
+   potência de 2, erro relativo < 3%, de 1 ns a horas), um por thread,
+   somados só em pso_latency_stats. Também ficam guardadas as
+   PSO_LATENCY_SLOWEST avaliações mais lentas com as posições.
+
+   No objetivo em lote a chamada inteira é medida e dividida igualmente
+   entre as posições do lote (sem posições mais lentas). Avaliações
+   abortadas pelo cutoff e reavaliações (modo ruidoso, degraus da
+   multi-fidelidade, APSO) entram no mesmo histograma.
+
+     pso_latency_t *lat = pso_latency_new(dim);
+     settings->latency = lat;
+     pso_solve(...);
+     pso_latency_print(stdout, lat);
+     pso_latency_free(lat);
+
+   reset/stats/free só com o solver parado.
+*/
+
+#ifndef PSO_LATENCY_H_
+#define PSO_LATENCY_H_
+
+#include <stdio.h>      // FILE
+#include <stdint.h>     // uint64_t
+
+// Avaliações mais lentas guardadas (com posição)
+#define PSO_LATENCY_SLOWEST 8
+
+// Estrutura opaca (ver pso_latency.c)
+typedef struct pso_latency pso_latency_t;
+
+typedef struct {
+    long count;                 // avaliações medidas
+    double mean, min, max;      // ns
+    double p50, p90, p99;       // ns (limite superior da faixa)
+    int nslow;                  // <= PSO_LATENCY_SLOWEST
+    double slow_ns[PSO_LATENCY_SLOWEST];         // em ordem decrescente
+    const double *slow_pos[PSO_LATENCY_SLOWEST]; // dim valores cada; válidas
+                                                 // até a próxima chamada
+} pso_latency_stats_t;
+
+// Cria o coletor para posições de dim elementos (NULL em falha)
+pso_latency_t *pso_latency_new(int dim);
+
+void pso_latency_free(pso_latency_t *lat);
+
+// Zera todas as threads
+void pso_latency_reset(pso_latency_t *lat);
+
+// Soma os histogramas das threads
+void pso_latency_stats(pso_latency_t *lat, pso_latency_stats_t *stats);
+
+// p50/p90/p99/max e as posições mais lentas (primeiras coordenadas)
+void pso_latency_print(FILE *f, pso_latency_t *lat);
+
+
+// Registro (usado pelo solver)
+
+// Instante atual (ns, relógio monotônico)
+uint64_t pso_latency_begin(void);
+
+// n avaliações terminadas agora, iniciadas em t0 (tempo dividido
+// igualmente). x = posição avaliada (só com n = 1; NULL = não guarda).
+void pso_latency_end(pso_latency_t *lat, uint64_t t0, int n, const double *x);
+
+#endif // PSO_LATENCY_H_
@@ -0,0 +1,171 @@
+/* Página de métricas em memória compartilhada (monitoramento externo)
+*/
+
+#define _GNU_SOURCE   // shm_open(), ftruncate()
+
+#include <stdio.h>      // snprintf()
+#include <stdlib.h>     // malloc(), free()
+#include <string.h>     // memcpy()
+#include <sched.h>      // sched_yield()
+#include <time.h>       // clock_gettime()
+
+#if defined(__unix__) || defined(__APPLE__)
+#define PSO_METRICS_SHM 1
+#include <fcntl.h>      // O_CREAT, O_RDWR
+#include <unistd.h>     // ftruncate(), close(), getpid()
+#include <sys/mman.h>   // shm_open(), mmap()
+#endif
+
+#include "pso_metrics.h"
+
+struct pso_metrics {
+    pso_metrics_page_t *page;
+    double t0;              // início da execução (s)
+    char name[256];
+};
+
+
+static inline uint64_t dbl_bits(double x) {
+    uint64_t u;
+    memcpy(&u, &x, sizeof(u));
+    return u;
+}
+
+static inline double bits_dbl(uint64_t u) {
+    double x;
+    memcpy(&x, &u, sizeof(x));
+    return x;
+}
+
+// relógio monotônico em segundos (vDSO no Linux: sem chamada de sistema)
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+#ifdef PSO_METRICS_SHM
+
+pso_metrics_t *pso_metrics_open(const char *name) {
+    pso_metrics_t *m = (pso_metrics_t *)calloc(1, sizeof(pso_metrics_t));
+    void *p;
+    int fd;
+
+    if (m == NULL) return NULL;
+    snprintf(m->name, sizeof(m->name), "%s%s", name[0] == '/' ? "" : "/", name);
+
+    fd = shm_open(m->name, O_CREAT | O_RDWR, 0644);
+    if (fd < 0) { free(m); return NULL; }
+    if (ftruncate(fd, sizeof(pso_metrics_page_t)) != 0) {
+        close(fd);
+        free(m);
+        return NULL;
+    }
+    p = mmap(NULL, sizeof(pso_metrics_page_t), PROT_READ | PROT_WRITE,
+             MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) { free(m); return NULL; }
+
+    // página zerada; magic por último (o leitor só confia nela depois)
+    m->page = (pso_metrics_page_t *)p;
+    memset(p, 0, sizeof(pso_metrics_page_t));
+    m->page->version = PSO_METRICS_VERSION;
+    atomic_store(&m->page->pid, (int32_t)getpid());
+    atomic_thread_fence(memory_order_release);
+    m->page->magic = PSO_METRICS_MAGIC;
+    m->t0 = now_s();
+    return m;
+}
+
+void pso_metrics_close(pso_metrics_t *metrics, int unlink) {
+    if (metrics == NULL) return;
+    munmap(metrics->page, sizeof(pso_metrics_page_t));
+    if (unlink) shm_unlink(metrics->name);
+    free(metrics);
+}
+
+#else
+
+pso_metrics_t *pso_metrics_open(const char *name) {
+    (void)name;
+    return NULL;
+}
+
+void pso_metrics_close(pso_metrics_t *metrics, int unlink) {
+    (void)metrics;
+    (void)unlink;
+}
+
+#endif
+
+pso_metrics_page_t *pso_metrics_page(pso_metrics_t *metrics) {
+    return metrics->page;
+}
+
+void pso_metrics_begin_run(pso_metrics_t *metrics) {
+    metrics->t0 = now_s();
+}
+
+void pso_metrics_publish(pso_metrics_t *metrics, const pso_metrics_snapshot_t *snap) {
+    pso_metrics_page_t *p = metrics->page;
+    uint32_t s = atomic_load_explicit(&p->seq, memory_order_relaxed);
+    double elapsed = now_s() - metrics->t0;
+
+    // escritor único: não precisa disputar o seqlock
+    atomic_store_explicit(&p->seq, s + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    atomic_store_explicit(&p->done, snap->done, memory_order_relaxed);
+    atomic_store_explicit(&p->dim, snap->dim, memory_order_relaxed);
+    atomic_store_explicit(&p->size, snap->size, memory_order_relaxed);
+    atomic_store_explicit(&p->nthreads, snap->nthreads, memory_order_relaxed);
+    atomic_store_explicit(&p->step, snap->step, memory_order_relaxed);
+    atomic_store_explicit(&p->steps, snap->steps, memory_order_relaxed);
+    atomic_store_explicit(&p->evals, snap->evals, memory_order_relaxed);
+    atomic_store_explicit(&p->best, dbl_bits(snap->best), memory_order_relaxed);
+    atomic_store_explicit(&p->w, dbl_bits(snap->w), memory_order_relaxed);
+    atomic_store_explicit(&p->diversity, dbl_bits(snap->diversity), memory_order_relaxed);
+    atomic_store_explicit(&p->evals_per_s, dbl_bits(elapsed > 0 ? snap->evals / elapsed : 0.0),
+                          memory_order_relaxed);
+    atomic_store_explicit(&p->elapsed, dbl_bits(elapsed), memory_order_relaxed);
+    for (int k=0; k<PSO_METRICS_MAX_THREADS; k++)
+        atomic_store_explicit(&p->thread_state[k], snap->thread_state[k], memory_order_relaxed);
+
+    atomic_store_explicit(&p->seq, s + 2, memory_order_release);
+}
+
+int pso_metrics_snapshot(const pso_metrics_page_t *page,
+                         pso_metrics_snapshot_t *snap)
+{
+    // o leitor só lê: os campos atômicos são acessados por cópia não-const
+    pso_metrics_page_t *p = (pso_metrics_page_t *)page;
+    uint32_t s0, s1;
+    int spins = 0;
+
+    if (page->magic != PSO_METRICS_MAGIC || page->version != PSO_METRICS_VERSION)
+        return -1;
+
+    do {
+        while ((s0 = atomic_load_explicit(&p->seq, memory_order_acquire)) & 1) {
+            if (++spins > 64) { sched_yield(); spins = 0; }
+        }
+        snap->pid = atomic_load_explicit(&p->pid, memory_order_relaxed);
+        snap->done = atomic_load_explicit(&p->done, memory_order_relaxed);
+        snap->dim = atomic_load_explicit(&p->dim, memory_order_relaxed);
+        snap->size = atomic_load_explicit(&p->size, memory_order_relaxed);
+        snap->nthreads = atomic_load_explicit(&p->nthreads, memory_order_relaxed);
+        snap->step = (long)atomic_load_explicit(&p->step, memory_order_relaxed);
+        snap->steps = (long)atomic_load_explicit(&p->steps, memory_order_relaxed);
+        snap->evals = (long)atomic_load_explicit(&p->evals, memory_order_relaxed);
+        snap->best = bits_dbl(atomic_load_explicit(&p->best, memory_order_relaxed));
+        snap->w = bits_dbl(atomic_load_explicit(&p->w, memory_order_relaxed));
+        snap->diversity = bits_dbl(atomic_load_explicit(&p->diversity, memory_order_relaxed));
+        snap->evals_per_s = bits_dbl(atomic_load_explicit(&p->evals_per_s, memory_order_relaxed));
+        snap->elapsed = bits_dbl(atomic_load_explicit(&p->elapsed, memory_order_relaxed));
+        for (int k=0; k<PSO_METRICS_MAX_THREADS; k++)
+            snap->thread_state[k] = atomic_load_explicit(&p->thread_state[k], memory_order_relaxed);
+        atomic_thread_fence(memory_order_acquire);
+        s1 = atomic_load_explicit(&p->seq, memory_order_relaxed);
+    } while (s0 != s1);
+    return 0;
+}
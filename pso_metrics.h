@@ -0,0 +1,99 @@
+/* Página de métricas em memória compartilhada (monitoramento externo)
+
+   Para acompanhar execuções longas sem printf nem callbacks no caminho
+   quente, o solver publica a cada passo uma página de layout fixo num
+   segmento de memória compartilhada com nome (shm_open). Outro processo
+   (pso_top) mapeia o segmento só para leitura e mostra a página.
+
+   - a publicação são só escritas na memória mapeada: nenhuma chamada de
+     sistema no caminho quente (o relógio vem de clock_gettime, que no
+     Linux é atendido no vDSO);
+   - os campos ficam sob um seqlock: o leitor repete a cópia se ela
+     cruzou uma escrita e nunca bloqueia o solver;
+   - thread_state mostra, para cada thread do pool, se ela estava
+     rodando uma tarefa, procurando/esperando ou dormindo no fim do passo
+     (pso_pool_states);
+   - a diversidade (distância média das partículas ao centroide) custa
+     uma passada pelo enxame e é recalculada a cada
+     PSO_METRICS_DIVERSITY_EVERY passos.
+
+     pso_metrics_t *m = pso_metrics_open("/pso-run1");
+     settings->metrics = m;
+     pso_solve(...);                     // em outro terminal: pso_top /pso-run1
+     pso_metrics_close(m, 1);            // 1 = remove o segmento
+
+   Um solver por página (o portfólio não publica).
+*/
+
+#ifndef PSO_METRICS_H_
+#define PSO_METRICS_H_
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+#define PSO_METRICS_MAGIC 0x4d4f5350u   // "PSOM"
+#define PSO_METRICS_VERSION 1
+
+// Threads do pool mostradas (as demais não aparecem)
+#define PSO_METRICS_MAX_THREADS 64
+
+// Passos entre dois cálculos da diversidade
+#define PSO_METRICS_DIVERSITY_EVERY 10
+
+// Layout da página (compartilhado entre processos: só tipos de tamanho
+// fixo; doubles guardados como bits em inteiros atômicos)
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    _Atomic uint32_t seq;          // seqlock: ímpar = escrita em andamento
+    _Atomic int32_t pid;           // processo do solver
+    _Atomic int32_t done;          // 1 = solver terminou
+    _Atomic int32_t dim;
+    _Atomic int32_t size;          // partículas ativas
+    _Atomic int32_t nthreads;      // threads do pool (0 = serial)
+    _Atomic int64_t step;
+    _Atomic int64_t steps;         // settings->steps
+    _Atomic int64_t evals;
+    _Atomic uint64_t best;         // double: melhor erro
+    _Atomic uint64_t w;            // double: inércia atual
+    _Atomic uint64_t diversity;    // double
+    _Atomic uint64_t evals_per_s;  // double: média desde o início
+    _Atomic uint64_t elapsed;      // double: segundos desde o início
+    _Atomic uint8_t thread_state[PSO_METRICS_MAX_THREADS]; // PSO_POOL_* (pso_pool.h)
+} pso_metrics_page_t;
+
+// Cópia consistente da página
+typedef struct {
+    int pid, done, dim, size, nthreads;
+    long step, steps, evals;
+    double best, w, diversity, evals_per_s, elapsed;
+    unsigned char thread_state[PSO_METRICS_MAX_THREADS];
+} pso_metrics_snapshot_t;
+
+// Estrutura opaca (ver pso_metrics.c)
+typedef struct pso_metrics pso_metrics_t;
+
+// Cria (ou reabre e zera) o segmento "name" (ex.: "/pso-run1"; a barra
+// inicial é acrescentada se faltar). NULL em falha ou em sistemas sem
+// shm_open.
+pso_metrics_t *pso_metrics_open(const char *name);
+
+// Desmapeia; unlink = 1 também remove o segmento
+void pso_metrics_close(pso_metrics_t *metrics, int unlink);
+
+// Página para escrita (usada pelo solver)
+pso_metrics_page_t *pso_metrics_page(pso_metrics_t *metrics);
+
+// Lê a página de forma consistente. Retorna 0, ou -1 se a página não
+// tem o magic/versão esperados.
+int pso_metrics_snapshot(const pso_metrics_page_t *page,
+                         pso_metrics_snapshot_t *snap);
+
+// Início de uma execução: elapsed e evals_per_s contam a partir daqui
+void pso_metrics_begin_run(pso_metrics_t *metrics);
+
+// Publica os valores de snap sob o seqlock (elapsed e evals_per_s são
+// calculados aqui). Um escritor por página.
+void pso_metrics_publish(pso_metrics_t *metrics, const pso_metrics_snapshot_t *snap);
+
+#endif // PSO_METRICS_H_
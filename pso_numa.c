@@ -0,0 +1,142 @@
+/* Topologia NUMA (nós e CPUs de cada nó)
+*/
+
+#define _GNU_SOURCE   // sched_getaffinity(), CPU_ISSET()
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+#include <unistd.h>     // sysconf()
+
+#include "pso_numa.h"
+
+// Maior id de CPU considerado
+#define MAX_CPUS 1024
+
+// CPUs permitidas agrupadas por nó: as de node[k] são
+// cpu[first[k]] .. cpu[first[k+1]-1]
+typedef struct {
+    int nnodes;
+    int node[PSO_NUMA_MAX_NODES];
+    int first[PSO_NUMA_MAX_NODES + 1];
+    int cpu[MAX_CPUS];
+} topology_t;
+
+
+// CPUs permitidas ao processo (allowed[c] = 1)
+static void allowed_cpus(char *allowed) {
+#ifdef __linux__
+    cpu_set_t set;
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int c=0; c<MAX_CPUS && c<CPU_SETSIZE; c++)
+            allowed[c] = CPU_ISSET(c, &set) ? 1 : 0;
+        return;
+    }
+#endif
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    for (int c=0; c<MAX_CPUS; c++) allowed[c] = c < n;
+}
+
+// Lê uma lista de CPUs do sysfs ("0-3,8-11") em mark (1 = presente).
+// Retorna -1 se o arquivo não existe.
+static int read_cpulist(const char *path, char *mark) {
+    FILE *f = fopen(path, "r");
+    int lo, hi;
+    char sep;
+
+    if (f == NULL) return -1;
+    memset(mark, 0, MAX_CPUS);
+    while (fscanf(f, "%d", &lo) == 1) {
+        hi = lo;
+        if (fscanf(f, "%c", &sep) == 1 && sep == '-') {
+            if (fscanf(f, "%d", &hi) != 1) break;
+            if (fscanf(f, "%c", &sep) != 1) sep = '\n';
+        }
+        for (int c=lo; c<=hi && c<MAX_CPUS; c++)
+            if (c >= 0) mark[c] = 1;
+        if (sep != ',') break;
+    }
+    fclose(f);
+    return 0;
+}
+
+static void read_topology(topology_t *t) {
+    char allowed[MAX_CPUS], mark[MAX_CPUS], path[64];
+    int n = 0;
+
+    allowed_cpus(allowed);
+    t->nnodes = 0;
+#ifdef __linux__
+    for (int id=0; id<PSO_NUMA_MAX_NODES; id++) {
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", id);
+        if (read_cpulist(path, mark) != 0) continue;
+
+        int start = n;
+        for (int c=0; c<MAX_CPUS; c++)
+            if (mark[c] && allowed[c]) t->cpu[n++] = c;
+        if (n == start) continue; // nó sem CPUs (só memória) ou não permitido
+        t->node[t->nnodes] = id;
+        t->first[t->nnodes++] = start;
+    }
+#else
+    (void)mark; (void)path;
+#endif
+    if (t->nnodes == 0) {
+        // sem topologia: um nó com todas as CPUs permitidas
+        for (int c=0; c<MAX_CPUS; c++)
+            if (allowed[c]) t->cpu[n++] = c;
+        if (n == 0) t->cpu[n++] = 0;
+        t->node[0] = 0;
+        t->first[0] = 0;
+        t->nnodes = 1;
+    }
+    t->first[t->nnodes] = n;
+}
+
+
+// ============================
+//         API PÚBLICA
+// ============================
+
+int pso_numa_nodes(void) {
+    topology_t *t = (topology_t *)malloc(sizeof(topology_t));
+    int n = 1;
+
+    if (t == NULL) return 1;
+    read_topology(t);
+    n = t->nnodes;
+    free(t);
+    return n;
+}
+
+int pso_numa_layout(int nthreads, int *cpus, int *nodes) {
+    topology_t *t = (topology_t *)malloc(sizeof(topology_t));
+    int used = 0, prev = -1;
+
+    if (t == NULL) {
+        for (int k=0; k<nthreads; k++) {
+            if (cpus) cpus[k] = -1;
+            if (nodes) nodes[k] = 0;
+        }
+        return 1;
+    }
+    read_topology(t);
+
+    for (int k=0; k<nthreads; k++) {
+        int j = (int)((long)k * t->nnodes / nthreads);
+        // posição da thread k dentro do bloco do nó j
+        int k0 = (int)(((long)j * nthreads + t->nnodes - 1) / t->nnodes);
+        int ncpu = t->first[j+1] - t->first[j];
+
+        if (cpus) cpus[k] = t->cpu[t->first[j] + (k - k0) % ncpu];
+        if (nodes) nodes[k] = t->node[j];
+        if (j != prev) used++;
+        prev = j;
+    }
+    free(t);
+    return used;
+}
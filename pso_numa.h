@@ -0,0 +1,35 @@
+/* Topologia NUMA (nós e CPUs de cada nó)
+
+   Em máquinas com mais de um soquete cada nó tem a própria memória, e
+   ler ou escrever a memória de outro nó atravessa a interconexão. O
+   Linux coloca cada página no nó da thread que a toca primeiro
+   (first-touch): com as threads fixadas em CPUs conhecidas, basta cada
+   uma alocar e inicializar os dados que ela mesma vai usar.
+
+   A topologia vem de /sys/devices/system/node (sem libnuma), restrita às
+   CPUs permitidas ao processo (taskset, cgroups). Sem essa informação
+   (outros SOs, kernel sem NUMA) há um único nó com as CPUs permitidas.
+
+   Usado pelo solver com settings->numa (ver pso.h):
+
+     settings->threads = 16;
+     settings->numa = 1;     // threads fixadas e enxame dividido por nó
+*/
+
+#ifndef PSO_NUMA_H_
+#define PSO_NUMA_H_
+
+// Nós considerados (os de id maior são ignorados)
+#define PSO_NUMA_MAX_NODES 64
+
+// Número de nós com CPUs permitidas ao processo (>= 1)
+int pso_numa_nodes(void);
+
+// Distribui nthreads threads pelos nós, em blocos contíguos do mesmo
+// tamanho (a thread k fica no nó k * nós / nthreads), e cada bloco pelas
+// CPUs do seu nó. cpus[k] = CPU da thread k e nodes[k] = nó dela (qualquer
+// um dos dois pode ser NULL). Com mais threads que CPUs num nó, as CPUs
+// se repetem. Retorna o número de nós usados.
+int pso_numa_layout(int nthreads, int *cpus, int *nodes);
+
+#endif // PSO_NUMA_H_
@@ -0,0 +1,211 @@
+/* Contadores de hardware por fase do solver
+*/
+
+#define _GNU_SOURCE   // syscall()
+
+#include <stdlib.h>     // malloc(), free()
+#include <string.h>
+#include <errno.h>
+#include <time.h>       // clock_gettime()
+
+#ifdef __linux__
+#include <unistd.h>             // read(), close(), syscall()
+#include <sys/syscall.h>        // SYS_perf_event_open
+#include <linux/perf_event.h>
+#endif
+
+#include "pso_perf.h"
+
+struct pso_perf {
+    int fd[PSO_PERF_COUNTERS];    // -1 = indisponível
+    int slot[PSO_PERF_COUNTERS];  // posição na leitura do grupo
+    int leader;                   // fd do líder do grupo (-1 = nenhum)
+    int nopen;
+    int phase;                    // fase em andamento
+    double t0;                    // início da fase
+    uint64_t v0[PSO_PERF_COUNTERS]; // contadores no início da fase
+    pso_perf_stats_t stats;
+    char status[128];
+};
+
+static const char *counter_names[PSO_PERF_COUNTERS] = {
+    "cycles", "instructions", "cache-misses", "branch-misses"
+};
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+#ifdef __linux__
+
+static const unsigned long long counter_config[PSO_PERF_COUNTERS] = {
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+};
+
+// Abre os contadores num grupo (lidos juntos, numa chamada). O primeiro
+// que abrir é o líder; um contador que não abre fica de fora.
+static void counters_open(pso_perf_t *p) {
+    struct perf_event_attr attr;
+    int c;
+
+    for (c=0; c<PSO_PERF_COUNTERS; c++) {
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = counter_config[c];
+        attr.exclude_kernel = 1; // basta perf_event_paranoid <= 2
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP;
+
+        p->fd[c] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, p->leader, 0);
+        if (p->fd[c] < 0) {
+            if (p->status[0] == '\0')
+                snprintf(p->status, sizeof(p->status), "%s: %s",
+                         counter_names[c], strerror(errno));
+            continue;
+        }
+        if (p->leader < 0) p->leader = p->fd[c];
+        p->slot[c] = p->nopen++;
+    }
+}
+
+// Lê o grupo em v (contadores indisponíveis ficam em 0)
+static void counters_read(const pso_perf_t *p, uint64_t *v) {
+    uint64_t buf[1 + PSO_PERF_COUNTERS]; // nr, valores na ordem do grupo
+    int c;
+
+    memset(v, 0, PSO_PERF_COUNTERS * sizeof(uint64_t));
+    if (p->nopen == 0) return;
+    if (read(p->leader, buf, sizeof(buf)) < (ssize_t)((1 + p->nopen) * sizeof(uint64_t)))
+        return;
+    for (c=0; c<PSO_PERF_COUNTERS; c++)
+        if (p->fd[c] >= 0) v[c] = buf[1 + p->slot[c]];
+}
+
+static void counters_close(pso_perf_t *p) {
+    int c;
+    // membros antes do líder
+    for (c=0; c<PSO_PERF_COUNTERS; c++)
+        if (p->fd[c] >= 0 && p->fd[c] != p->leader) close(p->fd[c]);
+    if (p->leader >= 0) close(p->leader);
+}
+
+#else
+
+static void counters_open(pso_perf_t *p) {
+    snprintf(p->status, sizeof(p->status), "perf_event_open não existe neste sistema");
+}
+
+static void counters_read(const pso_perf_t *p, uint64_t *v) {
+    (void)p;
+    memset(v, 0, PSO_PERF_COUNTERS * sizeof(uint64_t));
+}
+
+static void counters_close(pso_perf_t *p) {
+    (void)p;
+}
+
+#endif
+
+
+pso_perf_t *pso_perf_new(void) {
+    pso_perf_t *p = (pso_perf_t *)calloc(1, sizeof(pso_perf_t));
+    int c;
+
+    if (p == NULL) return NULL;
+    p->leader = -1;
+    p->phase = PSO_PHASE_NONE;
+    for (c=0; c<PSO_PERF_COUNTERS; c++) p->fd[c] = -1;
+    counters_open(p);
+    for (c=0; c<PSO_PERF_COUNTERS; c++) p->stats.available[c] = p->fd[c] >= 0;
+    return p;
+}
+
+void pso_perf_free(pso_perf_t *perf) {
+    if (perf == NULL) return;
+    counters_close(perf);
+    free(perf);
+}
+
+void pso_perf_phase(pso_perf_t *perf, int phase) {
+    uint64_t v[PSO_PERF_COUNTERS];
+    double t;
+    int c;
+
+    if (phase == perf->phase) return;
+    counters_read(perf, v);
+    t = now_ns();
+
+    if (perf->phase != PSO_PHASE_NONE) {
+        pso_perf_stats_t *st = &perf->stats;
+        st->calls[perf->phase]++;
+        st->ns[perf->phase] += t - perf->t0;
+        for (c=0; c<PSO_PERF_COUNTERS; c++)
+            st->count[perf->phase][c] += v[c] - perf->v0[c];
+    }
+
+    perf->phase = phase;
+    perf->t0 = t;
+    memcpy(perf->v0, v, sizeof(v));
+}
+
+void pso_perf_reset(pso_perf_t *perf) {
+    int available[PSO_PERF_COUNTERS];
+
+    memcpy(available, perf->stats.available, sizeof(available));
+    memset(&perf->stats, 0, sizeof(perf->stats));
+    memcpy(perf->stats.available, available, sizeof(available));
+    perf->phase = PSO_PHASE_NONE;
+}
+
+void pso_perf_stats(const pso_perf_t *perf, pso_perf_stats_t *stats) {
+    *stats = perf->stats;
+}
+
+const char *pso_perf_status(const pso_perf_t *perf) {
+    return perf->status[0] ? perf->status : NULL;
+}
+
+const char *pso_perf_phase_name(int phase) {
+    static const char *names[PSO_PHASES] = { "update", "inform", "eval", "book" };
+    return phase >= 0 && phase < PSO_PHASES ? names[phase] : "none";
+}
+
+// valor por mil instruções (ou "-")
+static void print_per_ki(FILE *f, const pso_perf_stats_t *st, int ph, int c) {
+    uint64_t ins = st->count[ph][PSO_PERF_INSTRUCTIONS];
+    if (!st->available[c] || !st->available[PSO_PERF_INSTRUCTIONS] || ins == 0)
+        fprintf(f, " %9s", "-");
+    else
+        fprintf(f, " %9.2f", 1000.0 * st->count[ph][c] / ins);
+}
+
+void pso_perf_print(FILE *f, const pso_perf_t *perf) {
+    const pso_perf_stats_t *st = &perf->stats;
+    double total = 0.0;
+    int ph;
+
+    for (ph=0; ph<PSO_PHASES; ph++) total += st->ns[ph];
+
+    fprintf(f, "%-7s %10s %6s %8s %9s %9s\n",
+            "fase", "ms", "%", "IPC", "cache/ki", "desvio/ki");
+    for (ph=0; ph<PSO_PHASES; ph++) {
+        uint64_t cyc = st->count[ph][PSO_PERF_CYCLES];
+        fprintf(f, "%-7s %10.2f %6.1f", pso_perf_phase_name(ph),
+                st->ns[ph] / 1e6, total > 0 ? 100.0 * st->ns[ph] / total : 0.0);
+        if (st->available[PSO_PERF_CYCLES] && st->available[PSO_PERF_INSTRUCTIONS] && cyc > 0)
+            fprintf(f, " %8.2f", (double)st->count[ph][PSO_PERF_INSTRUCTIONS] / cyc);
+        else
+            fprintf(f, " %8s", "-");
+        print_per_ki(f, st, ph, PSO_PERF_CACHE_MISSES);
+        print_per_ki(f, st, ph, PSO_PERF_BRANCH_MISSES);
+        fprintf(f, "\n");
+    }
+    if (perf->nopen == 0)
+        fprintf(f, "contadores indisponíveis (%s): só tempo\n", perf->status);
+    else if (perf->status[0])
+        fprintf(f, "parte dos contadores indisponível (%s)\n", perf->status);
+}
@@ -0,0 +1,94 @@
+/* Contadores de hardware por fase do solver
+
+   Um passo do PSO tem quatro fases com perfis bem diferentes:
+   - PSO_PHASE_UPDATE: atualização de velocidade/posição (laço denso
+     sobre as matrizes do enxame: tende a ser limitado pela memória
+     quando size * dim não cabe no cache);
+   - PSO_PHASE_INFORM: vizinhança e coeficientes (inform, APSO);
+   - PSO_PHASE_EVAL: chamadas da função objetivo (as reavaliações do
+     modo ruidoso e do APSO contam na fase que as faz);
+   - PSO_PHASE_BOOK: registro (pbest/gbest, melhor compartilhado,
+     progresso, redução do enxame).
+
+   Com settings->perf != NULL o solver marca a fronteira de cada fase e o
+   coletor soma, por fase, o tempo de relógio e os contadores de hardware
+   da thread (perf_event_open, só espaço de usuário): ciclos, instruções,
+   falhas de cache (último nível) e desvios mal previstos. Uma leitura do
+   grupo de contadores por fronteira (uma chamada de sistema).
+
+   Onde os contadores não existem (fora do Linux, máquina virtual sem PMU,
+   perf_event_paranoid alto) o coletor continua medindo o tempo e marca os
+   contadores como indisponíveis; pso_perf_status() diz o motivo.
+
+   Os contadores são da thread que criou o coletor: crie-o na thread que
+   roda o solver. Com pool (settings->threads > 1) o tempo de
+   PSO_PHASE_EVAL é o da fase inteira, mas os contadores só incluem a
+   parte avaliada pela própria thread.
+
+     pso_perf_t *perf = pso_perf_new();
+     settings->perf = perf;
+     pso_solve(...);
+     pso_perf_print(stdout, perf);
+     pso_perf_free(perf);
+*/
+
+#ifndef PSO_PERF_H_
+#define PSO_PERF_H_
+
+#include <stdio.h>      // FILE
+#include <stdint.h>     // uint64_t
+
+// Fases do passo
+#define PSO_PHASE_NONE -1   // fora do solver (não conta)
+#define PSO_PHASE_UPDATE 0
+#define PSO_PHASE_INFORM 1
+#define PSO_PHASE_EVAL 2
+#define PSO_PHASE_BOOK 3
+#define PSO_PHASES 4
+
+// Contadores
+#define PSO_PERF_CYCLES 0
+#define PSO_PERF_INSTRUCTIONS 1
+#define PSO_PERF_CACHE_MISSES 2
+#define PSO_PERF_BRANCH_MISSES 3
+#define PSO_PERF_COUNTERS 4
+
+// Estrutura opaca (ver pso_perf.c)
+typedef struct pso_perf pso_perf_t;
+
+typedef struct {
+    long calls[PSO_PHASES];    // vezes que a fase rodou
+    double ns[PSO_PHASES];     // tempo de relógio
+    uint64_t count[PSO_PHASES][PSO_PERF_COUNTERS];
+    int available[PSO_PERF_COUNTERS]; // 0 = contador indisponível
+} pso_perf_stats_t;
+
+// Cria o coletor e abre os contadores da thread atual. Nunca falha por
+// falta de contadores (só por falta de memória: NULL).
+pso_perf_t *pso_perf_new(void);
+
+// Fecha os contadores e libera o coletor
+void pso_perf_free(pso_perf_t *perf);
+
+// Termina a fase em andamento (se houver) e começa "phase"
+// (PSO_PHASE_NONE = para de contar)
+void pso_perf_phase(pso_perf_t *perf, int phase);
+
+// Zera os totais (os contadores continuam abertos)
+void pso_perf_reset(pso_perf_t *perf);
+
+// Copia os totais
+void pso_perf_stats(const pso_perf_t *perf, pso_perf_stats_t *stats);
+
+// NULL se todos os contadores abriram; senão o motivo
+// (ex.: "cycles: No such file or directory")
+const char *pso_perf_status(const pso_perf_t *perf);
+
+// Tabela por fase: tempo, IPC, falhas de cache e de desvio por mil
+// instruções ("-" onde o contador não está disponível)
+void pso_perf_print(FILE *f, const pso_perf_t *perf);
+
+// Nome curto da fase ("update", "inform", "eval", "book")
+const char *pso_perf_phase_name(int phase);
+
+#endif // PSO_PERF_H_
@@ -0,0 +1,191 @@
+/* Funções objetivo como plugins (bibliotecas compartilhadas .so)
+*/
+
+#include <stdio.h>      // snprintf()
+#include <stdlib.h>     // malloc(), free()
+#include <pthread.h>
+#include <dlfcn.h>      // dlopen(), dlsym(), dlclose()
+
+#include "pso_plugin.h"
+
+
+// Estado de uma thread para um plugin (lista encadeada para o unload)
+typedef struct tls_slot {
+    struct pso_plugin *plugin;
+    void *tls;
+    struct tls_slot *prev, *next;
+} tls_slot_t;
+
+struct pso_plugin {
+    void *handle;                 // dlopen
+    const pso_plugin_api_t *api;
+    void *ctx;                    // retorno de init
+
+    // estado por thread (somente se api->thread_init != NULL)
+    pthread_key_t key;
+    pthread_mutex_t slots_lock;
+    tls_slot_t *slots;
+};
+
+
+static void set_err(char *err, int errlen, const char *msg, const char *detail) {
+    if (err != NULL && errlen > 0)
+        snprintf(err, errlen, "%s%s%s", msg, detail ? ": " : "", detail ? detail : "");
+}
+
+// Destrutor da chave: thread terminando
+static void slot_destroy(void *p) {
+    tls_slot_t *s = (tls_slot_t *)p;
+    pso_plugin_t *pl = s->plugin;
+
+    pthread_mutex_lock(&pl->slots_lock);
+    if (s->prev) s->prev->next = s->next;
+    else pl->slots = s->next;
+    if (s->next) s->next->prev = s->prev;
+    pthread_mutex_unlock(&pl->slots_lock);
+
+    if (pl->api->thread_teardown)
+        pl->api->thread_teardown(pl->ctx, s->tls);
+    free(s);
+}
+
+// Estado da thread atual (criado na primeira chamada)
+static void *thread_state(pso_plugin_t *pl) {
+    if (pl->api->thread_init == NULL) return NULL;
+
+    tls_slot_t *s = (tls_slot_t *)pthread_getspecific(pl->key);
+    if (s != NULL) return s->tls;
+
+    s = (tls_slot_t *)malloc(sizeof(tls_slot_t));
+    if (s == NULL) return NULL;
+    s->plugin = pl;
+    s->tls = pl->api->thread_init(pl->ctx);
+    s->prev = NULL;
+
+    pthread_mutex_lock(&pl->slots_lock);
+    s->next = pl->slots;
+    if (pl->slots) pl->slots->prev = s;
+    pl->slots = s;
+    pthread_mutex_unlock(&pl->slots_lock);
+
+    pthread_setspecific(pl->key, s);
+    return s->tls;
+}
+
+
+pso_plugin_t *pso_plugin_load(const char *path, const char *args,
+                              char *err, int errlen)
+{
+    void *handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (handle == NULL) {
+        set_err(err, errlen, "dlopen falhou", dlerror());
+        return NULL;
+    }
+
+    pso_plugin_entry_t entry;
+    // (conversão via union: ISO C não define void* -> ponteiro de função)
+    union { void *p; pso_plugin_entry_t f; } sym;
+    sym.p = dlsym(handle, PSO_PLUGIN_ENTRY);
+    entry = sym.f;
+    if (entry == NULL) {
+        set_err(err, errlen, "simbolo " PSO_PLUGIN_ENTRY " ausente", path);
+        dlclose(handle);
+        return NULL;
+    }
+
+    const pso_plugin_api_t *api = entry();
+    if (api == NULL || api->abi_version != PSO_PLUGIN_ABI_VERSION) {
+        set_err(err, errlen, "versao de ABI incompativel", path);
+        dlclose(handle);
+        return NULL;
+    }
+    if (api->eval == NULL && api->eval_batch == NULL) {
+        set_err(err, errlen, "plugin sem eval nem eval_batch", path);
+        dlclose(handle);
+        return NULL;
+    }
+
+    pso_plugin_t *pl = (pso_plugin_t *)malloc(sizeof(pso_plugin_t));
+    if (pl == NULL) {
+        set_err(err, errlen, "sem memoria", NULL);
+        dlclose(handle);
+        return NULL;
+    }
+    pl->handle = handle;
+    pl->api = api;
+    pl->ctx = NULL;
+    pl->slots = NULL;
+
+    if (api->init != NULL) {
+        pl->ctx = api->init(args);
+        if (pl->ctx == NULL) {
+            set_err(err, errlen, "init do plugin falhou", args);
+            dlclose(handle);
+            free(pl);
+            return NULL;
+        }
+    }
+
+    pthread_mutex_init(&pl->slots_lock, NULL);
+    if (api->thread_init != NULL)
+        pthread_key_create(&pl->key, slot_destroy);
+    return pl;
+}
+
+void pso_plugin_unload(pso_plugin_t *pl) {
+    if (pl->api->thread_init != NULL) {
+        // a partir daqui o destrutor da chave não roda mais
+        pthread_key_delete(pl->key);
+        tls_slot_t *s = pl->slots;
+        while (s != NULL) {
+            tls_slot_t *next = s->next;
+            if (pl->api->thread_teardown)
+                pl->api->thread_teardown(pl->ctx, s->tls);
+            free(s);
+            s = next;
+        }
+    }
+    if (pl->api->teardown != NULL)
+        pl->api->teardown(pl->ctx);
+
+    pthread_mutex_destroy(&pl->slots_lock);
+    dlclose(pl->handle);
+    free(pl);
+}
+
+const pso_plugin_api_t *pso_plugin_api(const pso_plugin_t *plugin) {
+    return plugin->api;
+}
+
+double pso_plugin_eval(double *x, int dim, void *params) {
+    pso_plugin_t *pl = (pso_plugin_t *)params;
+    void *tls = thread_state(pl);
+    double fit;
+
+    if (pl->api->eval != NULL)
+        return pl->api->eval(pl->ctx, tls, x, dim);
+    pl->api->eval_batch(pl->ctx, tls, &x, dim, 1, &fit);
+    return fit;
+}
+
+void pso_plugin_batch(double **x, int dim, int n, double *fit, void *params) {
+    pso_plugin_t *pl = (pso_plugin_t *)params;
+    void *tls = thread_state(pl);
+
+    if (pl->api->eval_batch != NULL) {
+        pl->api->eval_batch(pl->ctx, tls, x, dim, n, fit);
+        return;
+    }
+    for (int i=0; i<n; i++)
+        fit[i] = pl->api->eval(pl->ctx, tls, x[i], dim);
+}
+
+double pso_plugin_eval_delta(pso_plugin_t *pl, const double *x,
+                             const double *x_prev, double f_prev, int dim)
+{
+    void *tls = thread_state(pl);
+
+    if (pl->api->eval_delta != NULL)
+        return pl->api->eval_delta(pl->ctx, tls, x, x_prev, f_prev, dim);
+    return pso_plugin_eval((double *)x, dim, pl);
+}
@@ -0,0 +1,102 @@
+/* Funções objetivo como plugins (bibliotecas compartilhadas .so)
+
+   Um plugin é uma biblioteca compilada à parte que exporta a função
+   pso_plugin_entry(), retornando a descrição abaixo (pso_plugin_api_t).
+   O host (servidor, CLI ou qualquer programa) carrega o plugin com
+   pso_plugin_load() e usa os adaptadores pso_plugin_eval / pso_plugin_batch
+   como função objetivo, sem recompilar nada.
+
+   Estado por thread: se o plugin define thread_init, cada thread que
+   avalia recebe seu próprio "tls" (buffers de trabalho etc.), criado na
+   primeira avaliação daquela thread e reaproveitado nas seguintes; é
+   destruído (thread_teardown) quando a thread termina ou no unload.
+
+   Exemplo mínimo de plugin:
+
+     #include "pso_plugin.h"
+     static double eval(void *ctx, void *tls, const double *x, int dim) {...}
+     static const pso_plugin_api_t api = {
+         PSO_PLUGIN_ABI_VERSION, "minha_funcao", -5.0, 5.0,
+         NULL, NULL, NULL, NULL, eval, NULL, NULL
+     };
+     const pso_plugin_api_t *pso_plugin_entry(void) { return &api; }
+
+   gcc -shared -fPIC minha_funcao.c -o minha_funcao.so
+*/
+
+#ifndef PSO_PLUGIN_H_
+#define PSO_PLUGIN_H_
+
+#include "pso.h"
+
+
+//                    ABI DO PLUGIN
+
+// Versão da ABI: o loader recusa plugins com versão diferente
+#define PSO_PLUGIN_ABI_VERSION 1
+
+// Nome do símbolo exportado pelo plugin
+#define PSO_PLUGIN_ENTRY "pso_plugin_entry"
+
+typedef struct {
+    int abi_version;          // PSO_PLUGIN_ABI_VERSION
+    const char *name;         // nome curto da função
+    double lo, hi;            // domínio sugerido (mesmo em todas as dimensões)
+
+    // Inicialização global (opcional): recebe a string de argumentos do
+    // usuário (pode ser NULL) e retorna o contexto passado às demais
+    // funções. Retornar NULL com args inválidos faz o load falhar.
+    void *(*init)(const char *args);
+    void (*teardown)(void *ctx);
+
+    // Estado por thread (opcional)
+    void *(*thread_init)(void *ctx);
+    void (*thread_teardown)(void *ctx, void *tls);
+
+    // Avaliação de uma posição (obrigatória se eval_batch for NULL)
+    double (*eval)(void *ctx, void *tls, const double *x, int dim);
+
+    // Avaliação em lote (opcional): fit[i] = f(x[i]), i < n
+    void (*eval_batch)(void *ctx, void *tls, double **x, int dim, int n,
+                       double *fit);
+
+    // Avaliação incremental (opcional): f(x) sabendo que f(x_prev) = f_prev.
+    // Útil para quem move poucas coordenadas por vez (busca local).
+    double (*eval_delta)(void *ctx, void *tls, const double *x,
+                         const double *x_prev, double f_prev, int dim);
+} pso_plugin_api_t;
+
+// Assinatura de pso_plugin_entry
+typedef const pso_plugin_api_t *(*pso_plugin_entry_t)(void);
+
+
+//                    LOADER (LADO DO HOST)
+
+// Estrutura opaca (ver pso_plugin.c)
+typedef struct pso_plugin pso_plugin_t;
+
+// Carrega o plugin em path e chama init(args).
+// Em caso de falha retorna NULL e escreve o motivo em err (se != NULL).
+pso_plugin_t *pso_plugin_load(const char *path, const char *args,
+                              char *err, int errlen);
+
+// Chama thread_teardown (todas as threads), teardown e descarrega.
+// Nenhuma thread pode estar avaliando.
+void pso_plugin_unload(pso_plugin_t *plugin);
+
+// Descrição exportada pelo plugin (nome, domínio, entradas disponíveis)
+const pso_plugin_api_t *pso_plugin_api(const pso_plugin_t *plugin);
+
+// Função objetivo para pso_solve (params = plugin). Usa eval ou, se o
+// plugin só tiver lote, eval_batch com n = 1.
+double pso_plugin_eval(double *x, int dim, void *plugin);
+
+// Função objetivo em lote para pso_solve_batch (params = plugin). Usa
+// eval_batch ou, se o plugin não tiver lote, eval em cada posição.
+void pso_plugin_batch(double **x, int dim, int n, double *fit, void *plugin);
+
+// Avaliação incremental; sem eval_delta no plugin, avalia x inteiro
+double pso_plugin_eval_delta(pso_plugin_t *plugin, const double *x,
+                             const double *x_prev, double f_prev, int dim);
+
+#endif // PSO_PLUGIN_H_
@@ -0,0 +1,108 @@
+/* Plugin de exemplo: Rastrigin deslocado
+
+   f(x) = 10*dim + soma (z_i^2 - 10*cos(2*pi*z_i)),  z = x - shift
+
+   args: "shift=X" (padrão 0). Mostra as quatro partes da ABI:
+   init/teardown (contexto global), estado por thread (buffer z reusado),
+   lote e avaliação incremental.
+
+   gcc -shared -fPIC -O2 pso_plugin_example.c -o rastrigin.so -lm
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "pso_plugin.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+typedef struct {
+    double shift;
+} ctx_t;
+
+// buffer de trabalho da thread (cresce só quando dim aumenta)
+typedef struct {
+    double *z;
+    int cap;
+} tls_t;
+
+static void *init(const char *args) {
+    ctx_t *c = (ctx_t *)malloc(sizeof(ctx_t));
+    if (c == NULL) return NULL;
+    c->shift = 0.0;
+    if (args != NULL && strncmp(args, "shift=", 6) == 0)
+        c->shift = atof(args + 6);
+    return c;
+}
+
+static void teardown(void *ctx) {
+    free(ctx);
+}
+
+static void *thread_init(void *ctx) {
+    (void)ctx;
+    return calloc(1, sizeof(tls_t));
+}
+
+static void thread_teardown(void *ctx, void *p) {
+    (void)ctx;
+    tls_t *t = (tls_t *)p;
+    free(t->z);
+    free(t);
+}
+
+static double *scratch(tls_t *t, int dim) {
+    if (t->cap < dim) {
+        free(t->z);
+        t->z = (double *)malloc(dim * sizeof(double));
+        t->cap = dim;
+    }
+    return t->z;
+}
+
+static double term(double z) {
+    return z*z - 10.0*cos(2.0*M_PI*z);
+}
+
+static double eval(void *ctx, void *p, const double *x, int dim) {
+    const ctx_t *c = (const ctx_t *)ctx;
+    double *z = scratch((tls_t *)p, dim);
+    double s = 10.0*dim;
+
+    for (int i=0; i<dim; i++) z[i] = x[i] - c->shift;
+    for (int i=0; i<dim; i++) s += term(z[i]);
+    return s;
+}
+
+static void eval_batch(void *ctx, void *p, double **x, int dim, int n,
+                       double *fit)
+{
+    for (int k=0; k<n; k++)
+        fit[k] = eval(ctx, p, x[k], dim);
+}
+
+// só as coordenadas que mudaram entram no cálculo
+static double eval_delta(void *ctx, void *p, const double *x,
+                         const double *x_prev, double f_prev, int dim)
+{
+    const ctx_t *c = (const ctx_t *)ctx;
+    (void)p;
+    for (int i=0; i<dim; i++)
+        if (x[i] != x_prev[i])
+            f_prev += term(x[i] - c->shift) - term(x_prev[i] - c->shift);
+    return f_prev;
+}
+
+static const pso_plugin_api_t api = {
+    PSO_PLUGIN_ABI_VERSION, "rastrigin_shift", -5.12, 5.12,
+    init, teardown,
+    thread_init, thread_teardown,
+    eval, eval_batch, eval_delta
+};
+
+const pso_plugin_api_t *pso_plugin_entry(void) {
+    return &api;
+}
@@ -0,0 +1,437 @@
+/* Pool de threads com roubo de tarefas (work-stealing)
+*/
+
+#define _GNU_SOURCE   // pthread_setaffinity_np(), CPU_SET()
+
+#include <stdio.h>      // snprintf()
+#include <stdlib.h>     // malloc(), free()
+#include <stdint.h>     // uint32_t
+#include <pthread.h>
+#include <sched.h>      // sched_yield()
+#include <stdatomic.h>
+
+#include "pso_pool.h"
+#include "pso_trace.h"
+
+
+// Tarefa enfileirada
+typedef struct {
+    pso_task_fun_t fun;
+    void *arg;
+    pso_task_group_t *group;
+} task_t;
+
+// Fila dupla de uma thread: a dona empilha/desempilha no fim (LIFO,
+// bom para cache); ladrões retiram do início (tarefas mais antigas)
+typedef struct {
+    pthread_mutex_t lock;
+    task_t *buf;
+    int cap;
+    int head, tail; // tarefas em [head, tail)
+} deque_t;
+
+struct pso_pool {
+    int nthreads;
+    pthread_t *threads;   // trabalhadoras 1..nthreads-1
+    deque_t *q;           // q[0] = fila das threads externas
+    deque_t *own;         // tarefas presas a uma thread (pso_pool_spawn_to)
+    atomic_int *owned;    // tarefas em own[k]
+
+    atomic_int stop;
+    atomic_int queued;    // tarefas em todas as filas
+
+    // trabalhadoras sem tarefa dormem aqui
+    pthread_mutex_t idle_lock;
+    pthread_cond_t idle_cond;
+    int sleepers;
+
+    _Atomic unsigned char *state;  // PSO_POOL_* de cada thread
+
+    // afinidade original da thread que criou o pool (cpus[0] a fixou;
+    // pso_pool_free a devolve)
+    int pinned;
+    pthread_t creator;
+#ifdef __linux__
+    cpu_set_t creator_mask;
+#endif
+};
+
+// argumento de partida de cada trabalhadora
+typedef struct {
+    pso_pool_t *pool;
+    int slot;
+    int cpu;
+} worker_arg_t;
+
+// Identidade da thread atual (pool e fila própria)
+static _Thread_local pso_pool_t *tls_pool = NULL;
+static _Thread_local int tls_slot = 0;
+static _Thread_local uint32_t tls_rng = 0;
+
+
+// ============================
+//      FILA DUPLA (DEQUE)
+// ============================
+
+static int deque_init(deque_t *q) {
+    q->cap = 64;
+    q->head = q->tail = 0;
+    q->buf = (task_t *)malloc(q->cap * sizeof(task_t));
+    if (q->buf == NULL) return -1;
+    pthread_mutex_init(&q->lock, NULL);
+    return 0;
+}
+
+static void deque_free(deque_t *q) {
+    pthread_mutex_destroy(&q->lock);
+    free(q->buf);
+}
+
+// Retorna -1 (sem enfileirar) se a fila está cheia e não dá para crescer
+static int deque_push(deque_t *q, const task_t *t) {
+    pthread_mutex_lock(&q->lock);
+    if (q->tail - q->head == q->cap) {
+        // cheia: dobra a capacidade mantendo a ordem
+        task_t *nb = (task_t *)malloc(2 * q->cap * sizeof(task_t));
+        if (nb == NULL) {
+            pthread_mutex_unlock(&q->lock);
+            return -1;
+        }
+        for (int k=q->head; k<q->tail; k++)
+            nb[k - q->head] = q->buf[k % q->cap];
+        free(q->buf);
+        q->buf = nb;
+        q->tail -= q->head;
+        q->head = 0;
+        q->cap *= 2;
+    }
+    q->buf[q->tail % q->cap] = *t;
+    q->tail++;
+    pthread_mutex_unlock(&q->lock);
+    return 0;
+}
+
+// retira do fim (dona) ou do início (ladrão); retorna 1 se pegou
+static int deque_take(deque_t *q, task_t *t, int from_front) {
+    int ok = 0;
+    pthread_mutex_lock(&q->lock);
+    if (q->tail > q->head) {
+        if (from_front) {
+            *t = q->buf[q->head % q->cap];
+            q->head++;
+        } else {
+            q->tail--;
+            *t = q->buf[q->tail % q->cap];
+        }
+        ok = 1;
+        if (q->head == q->tail) q->head = q->tail = 0;
+    }
+    pthread_mutex_unlock(&q->lock);
+    return ok;
+}
+
+
+// ============================
+//   BUSCA / EXECUÇÃO DE TAREFAS
+// ============================
+
+// tarefas presas à thread primeiro (ninguém mais as executa), depois a
+// própria fila; por fim rouba de uma vítima aleatória em diante
+static int find_task(pso_pool_t *pool, int slot, task_t *t) {
+    if (atomic_load_explicit(&pool->owned[slot], memory_order_acquire) > 0 &&
+        deque_take(&pool->own[slot], t, 1)) {
+        atomic_fetch_sub_explicit(&pool->owned[slot], 1, memory_order_relaxed);
+        return 1;
+    }
+    if (atomic_load_explicit(&pool->queued, memory_order_acquire) == 0)
+        return 0;
+
+    if (deque_take(&pool->q[slot], t, 0)) goto got;
+
+    tls_rng ^= tls_rng << 13; tls_rng ^= tls_rng >> 17; tls_rng ^= tls_rng << 5;
+    int start = (int)(tls_rng % (uint32_t)pool->nthreads);
+    for (int k=0; k<pool->nthreads; k++) {
+        int v = (start + k) % pool->nthreads;
+        if (v != slot && deque_take(&pool->q[v], t, 1)) goto got;
+    }
+    return 0;
+
+got:
+    atomic_fetch_sub_explicit(&pool->queued, 1, memory_order_relaxed);
+    return 1;
+}
+
+static void set_state(pso_pool_t *pool, int slot, unsigned char st) {
+    atomic_store_explicit(&pool->state[slot], st, memory_order_relaxed);
+}
+
+static void run_task(const task_t *t) {
+    t->fun(t->arg);
+    atomic_fetch_sub_explicit(&t->group->pending, 1, memory_order_release);
+}
+
+// fixa a thread atual em uma CPU (somente Linux; ignorado em outros SOs)
+static void pin_self(int cpu) {
+#ifdef __linux__
+    if (cpu < 0) return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)cpu;
+#endif
+}
+
+// fixa quem cria o pool em cpu, guardando a afinidade que ele tinha
+static void pin_creator(pso_pool_t *pool, int cpu) {
+    pool->pinned = 0;
+#ifdef __linux__
+    if (cpu < 0) return;
+    pool->creator = pthread_self();
+    if (pthread_getaffinity_np(pool->creator, sizeof(pool->creator_mask),
+                               &pool->creator_mask) != 0)
+        return; // sem como desfazer: não fixa
+    pin_self(cpu);
+    pool->pinned = 1;
+#else
+    (void)cpu;
+#endif
+}
+
+// devolve a afinidade original (só se quem libera é quem criou: a de
+// outra thread não é nossa para mexer)
+static void unpin_creator(pso_pool_t *pool) {
+#ifdef __linux__
+    if (pool->pinned && pthread_equal(pool->creator, pthread_self()))
+        pthread_setaffinity_np(pool->creator, sizeof(pool->creator_mask),
+                               &pool->creator_mask);
+#endif
+    pool->pinned = 0;
+}
+
+static void *worker_main(void *p) {
+    worker_arg_t *wa = (worker_arg_t *)p;
+    pso_pool_t *pool = wa->pool;
+    char name[32];
+    task_t t;
+
+    tls_pool = pool;
+    tls_slot = wa->slot;
+    tls_rng = 0x9E3779B9u * (uint32_t)(wa->slot + 1);
+    pin_self(wa->cpu);
+    snprintf(name, sizeof(name), "pool %d", wa->slot);
+    pso_trace_thread_name(name);
+    free(wa);
+
+    while (!atomic_load(&pool->stop)) {
+        if (find_task(pool, tls_slot, &t)) {
+            set_state(pool, tls_slot, PSO_POOL_RUN);
+            run_task(&t);
+            set_state(pool, tls_slot, PSO_POOL_IDLE);
+            continue;
+        }
+        // sem trabalho: dorme até alguém criar tarefa
+        pthread_mutex_lock(&pool->idle_lock);
+        while (atomic_load(&pool->queued) == 0 && atomic_load(&pool->owned[tls_slot]) == 0 &&
+               !atomic_load(&pool->stop)) {
+            pool->sleepers++;
+            set_state(pool, tls_slot, PSO_POOL_SLEEP);
+            pthread_cond_wait(&pool->idle_cond, &pool->idle_lock);
+            set_state(pool, tls_slot, PSO_POOL_IDLE);
+            pool->sleepers--;
+        }
+        pthread_mutex_unlock(&pool->idle_lock);
+    }
+    return NULL;
+}
+
+
+// ============================
+//         API PÚBLICA
+// ============================
+
+// Para e junta as nworkers primeiras trabalhadoras e libera o pool com
+// nq filas inicializadas (pso_pool_free, ou falha no meio de pso_pool_new)
+static void pool_destroy(pso_pool_t *pool, int nq, int nworkers) {
+    pthread_mutex_lock(&pool->idle_lock);
+    atomic_store(&pool->stop, 1);
+    pthread_cond_broadcast(&pool->idle_cond);
+    pthread_mutex_unlock(&pool->idle_lock);
+
+    for (int k=1; k<=nworkers; k++)
+        pthread_join(pool->threads[k], NULL);
+    unpin_creator(pool);
+    for (int k=0; k<nq; k++) {
+        deque_free(&pool->q[k]);
+        deque_free(&pool->own[k]);
+    }
+
+    pthread_mutex_destroy(&pool->idle_lock);
+    pthread_cond_destroy(&pool->idle_cond);
+    free(pool->threads);
+    free(pool->q);
+    free(pool->own);
+    free(pool->owned);
+    free((void *)pool->state);
+    free(pool);
+}
+
+pso_pool_t *pso_pool_new(int nthreads, const int *cpus) {
+    int nq, k;
+
+    if (nthreads < 1) nthreads = 1;
+
+    pso_pool_t *pool = (pso_pool_t *)malloc(sizeof(pso_pool_t));
+    if (pool == NULL) return NULL;
+
+    pool->nthreads = nthreads;
+    pool->threads = (pthread_t *)malloc(nthreads * sizeof(pthread_t));
+    pool->q = (deque_t *)malloc(nthreads * sizeof(deque_t));
+    pool->own = (deque_t *)malloc(nthreads * sizeof(deque_t));
+    pool->owned = (atomic_int *)malloc(nthreads * sizeof(atomic_int));
+    pool->state = (_Atomic unsigned char *)malloc(nthreads * sizeof(*pool->state));
+    if (pool->threads == NULL || pool->q == NULL || pool->own == NULL ||
+        pool->owned == NULL || pool->state == NULL) {
+        free(pool->threads); free(pool->q); free(pool->own); free(pool->owned);
+        free((void *)pool->state); free(pool);
+        return NULL;
+    }
+
+    atomic_init(&pool->stop, 0);
+    atomic_init(&pool->queued, 0);
+    pthread_mutex_init(&pool->idle_lock, NULL);
+    pthread_cond_init(&pool->idle_cond, NULL);
+    pool->sleepers = 0;
+    pool->pinned = 0;
+
+    for (nq=0; nq<nthreads; nq++) {
+        if (deque_init(&pool->q[nq]) != 0) break;
+        if (deque_init(&pool->own[nq]) != 0) {
+            deque_free(&pool->q[nq]);
+            break;
+        }
+        atomic_init(&pool->owned[nq], 0);
+        atomic_init(&pool->state[nq], PSO_POOL_IDLE);
+    }
+    if (nq < nthreads) {
+        pool_destroy(pool, nq, 0);
+        return NULL;
+    }
+
+    if (cpus != NULL) pin_creator(pool, cpus[0]);
+
+    // uma trabalhadora que falta deixaria tarefas de pso_pool_spawn_to
+    // sem dona (pso_pool_sync nunca voltaria): tudo ou nada
+    for (k=1; k<nthreads; k++) {
+        worker_arg_t *wa = (worker_arg_t *)malloc(sizeof(worker_arg_t));
+        if (wa == NULL) break;
+        wa->pool = pool;
+        wa->slot = k;
+        wa->cpu = cpus ? cpus[k] : -1;
+        if (pthread_create(&pool->threads[k], NULL, worker_main, wa) != 0) {
+            free(wa);
+            break;
+        }
+    }
+    if (k < nthreads) {
+        pool_destroy(pool, nthreads, k - 1);
+        return NULL;
+    }
+    return pool;
+}
+
+void pso_pool_free(pso_pool_t *pool) {
+    pool_destroy(pool, pool->nthreads, pool->nthreads - 1);
+}
+
+int pso_pool_threads(const pso_pool_t *pool) {
+    return pool->nthreads;
+}
+
+int pso_pool_states(const pso_pool_t *pool, unsigned char *states, int n) {
+    if (n > pool->nthreads) n = pool->nthreads;
+    for (int k=0; k<n; k++)
+        states[k] = atomic_load_explicit(&pool->state[k], memory_order_relaxed);
+    return n;
+}
+
+pso_pool_t *pso_pool_self(void) {
+    return tls_pool;
+}
+
+void pso_task_group_init(pso_task_group_t *group) {
+    atomic_init(&group->pending, 0);
+}
+
+void pso_pool_spawn(pso_pool_t *pool, pso_task_group_t *group,
+                    pso_task_fun_t fun, void *arg)
+{
+    task_t t = { fun, arg, group };
+    // threads externas usam a fila 0
+    int slot = (tls_pool == pool) ? tls_slot : 0;
+
+    atomic_fetch_add_explicit(&group->pending, 1, memory_order_relaxed);
+    if (deque_push(&pool->q[slot], &t) != 0) {
+        // sem memória para a fila: roda aqui mesmo
+        run_task(&t);
+        return;
+    }
+    atomic_fetch_add_explicit(&pool->queued, 1, memory_order_release);
+
+    pthread_mutex_lock(&pool->idle_lock);
+    if (pool->sleepers > 0)
+        pthread_cond_signal(&pool->idle_cond);
+    pthread_mutex_unlock(&pool->idle_lock);
+}
+
+void pso_pool_spawn_to(pso_pool_t *pool, pso_task_group_t *group, int slot,
+                       pso_task_fun_t fun, void *arg)
+{
+    task_t t = { fun, arg, group };
+
+    atomic_fetch_add_explicit(&group->pending, 1, memory_order_relaxed);
+    if (deque_push(&pool->own[slot], &t) != 0) {
+        // sem memória para a fila: roda aqui mesmo (fora da dona)
+        run_task(&t);
+        return;
+    }
+    atomic_fetch_add_explicit(&pool->owned[slot], 1, memory_order_release);
+
+    // a dona pode ser qualquer uma das que dormem: acorda todas
+    pthread_mutex_lock(&pool->idle_lock);
+    if (pool->sleepers > 0)
+        pthread_cond_broadcast(&pool->idle_cond);
+    pthread_mutex_unlock(&pool->idle_lock);
+}
+
+void pso_pool_sync(pso_pool_t *pool, pso_task_group_t *group) {
+    pso_pool_t *saved_pool = tls_pool;
+    int saved_slot = tls_slot;
+    int spins = 0;
+    task_t t;
+
+    // thread externa: enquanto ajuda, age como dona da fila 0 (assim
+    // tarefas que ela executa também enxergam o pool via pso_pool_self)
+    if (tls_pool != pool) {
+        tls_pool = pool;
+        tls_slot = 0;
+    }
+    if (tls_rng == 0) tls_rng = 0x6D2B79F5u;
+
+    while (atomic_load_explicit(&group->pending, memory_order_acquire) > 0) {
+        if (find_task(pool, tls_slot, &t)) {
+            set_state(pool, tls_slot, PSO_POOL_RUN);
+            run_task(&t);
+            set_state(pool, tls_slot, PSO_POOL_IDLE);
+            spins = 0;
+        } else if (++spins > 64) {
+            // tarefas do grupo estão rodando em outras threads
+            sched_yield();
+            spins = 0;
+        }
+    }
+
+    tls_pool = saved_pool;
+    tls_slot = saved_slot;
+}
@@ -0,0 +1,78 @@
+/* Pool de threads com roubo de tarefas (work-stealing)
+
+   O mesmo pool é usado pelo solver (avaliação das partículas em paralelo)
+   e pela própria função objetivo (paralelismo aninhado via spawn/sync),
+   evitando ter dois conjuntos de threads disputando os mesmos núcleos.
+*/
+
+#ifndef PSO_POOL_H_
+#define PSO_POOL_H_
+
+#include <stdatomic.h>
+
+// Estrutura opaca (ver pso_pool.c)
+typedef struct pso_pool pso_pool_t;
+
+// Tarefa: função + argumento
+typedef void (*pso_task_fun_t)(void *arg);
+
+// Grupo de tarefas: pso_pool_sync() espera todas as tarefas do grupo.
+// Pode ficar na pilha de quem chama (inicializar com pso_task_group_init).
+typedef struct {
+    atomic_int pending;
+} pso_task_group_t;
+
+
+// Cria um pool com nthreads threads no total: nthreads-1 trabalhadoras
+// mais a thread que chama pso_pool_sync(), que também executa tarefas
+// enquanto espera.
+// cpus: NULL ou vetor com nthreads ids de CPU (afinidade). cpus[0] fixa a
+// thread que chama pso_pool_new enquanto o pool existe (pso_pool_free,
+// chamado por ela, devolve a afinidade anterior) e cpus[k] a k-ésima
+// trabalhadora. Id < 0 = thread não fixada.
+// Retorna NULL em caso de falha.
+pso_pool_t *pso_pool_new(int nthreads, const int *cpus);
+
+// Encerra as trabalhadoras e libera o pool (não pode haver tarefas pendentes)
+void pso_pool_free(pso_pool_t *pool);
+
+// Número total de threads do pool
+int pso_pool_threads(const pso_pool_t *pool);
+
+// Pool da thread atual, se ela for trabalhadora de algum pool (ou NULL).
+// Uma função objetivo usa isso para paralelizar o próprio cálculo nas
+// mesmas threads do solver.
+pso_pool_t *pso_pool_self(void);
+
+// Estado de cada thread (pso_pool_states)
+#define PSO_POOL_IDLE  0   // procurando tarefa ou esperando o grupo
+#define PSO_POOL_RUN   1   // executando uma tarefa
+#define PSO_POOL_SLEEP 2   // dormindo (nenhuma tarefa nas filas)
+
+// Copia o estado atual de até n threads para states (states[0] = thread
+// externa que ajuda em pso_pool_sync). Retorna quantas foram copiadas.
+// Cada thread publica o próprio estado com uma escrita de um byte.
+int pso_pool_states(const pso_pool_t *pool, unsigned char *states, int n);
+
+// Inicializa um grupo vazio
+void pso_task_group_init(pso_task_group_t *group);
+
+// Cria uma tarefa no grupo (vai para a fila da thread atual; as outras
+// threads podem roubá-la). Se a fila não puder crescer (sem memória), a
+// tarefa roda na hora, na thread que chama; o mesmo vale para
+// pso_pool_spawn_to.
+void pso_pool_spawn(pso_pool_t *pool, pso_task_group_t *group,
+                    pso_task_fun_t fun, void *arg);
+
+// Cria uma tarefa que só a thread slot executa (0 = a que chama
+// pso_pool_sync; 1..nthreads-1 = trabalhadoras). Ninguém a rouba: serve
+// para manter um bloco de dados sempre na mesma thread (e no mesmo nó
+// NUMA, se as threads estão fixadas, ver pso_numa.h).
+void pso_pool_spawn_to(pso_pool_t *pool, pso_task_group_t *group, int slot,
+                       pso_task_fun_t fun, void *arg);
+
+// Espera todas as tarefas do grupo, executando tarefas (do grupo ou não)
+// enquanto espera. Pode ser chamada de dentro de uma tarefa.
+void pso_pool_sync(pso_pool_t *pool, pso_task_group_t *group);
+
+#endif // PSO_POOL_H_
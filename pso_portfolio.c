@@ -0,0 +1,223 @@
+/* Portfólio de configurações (corrida entre estratégias)
+*/
+
+#include <stdlib.h>     // malloc(), free()
+#include <string.h>
+#include <float.h>      // DBL_MAX
+
+#include "pso_portfolio.h"
+#include "pso_shared.h"
+#include "pso_pool.h"
+#include "pso_trace.h"
+
+// Peso da rodada mais recente na média móvel do progresso
+#define PSO_PORTFOLIO_ALPHA 0.3
+
+// Fração de cada rodada dividida igualmente entre os braços ativos
+// (exploração: um braço parado ainda é observado e pode voltar)
+#define PSO_PORTFOLIO_FLOOR 0.2
+
+static const pso_portfolio_arm_t default_arms[PSO_PORTFOLIO_DEFAULT_ARMS] = {
+    { PSO_NHOOD_GLOBAL, PSO_W_LIN_DEC },
+    { PSO_NHOOD_RING,   PSO_W_LIN_DEC },
+    { PSO_NHOOD_RANDOM, PSO_W_LIN_DEC },
+    { PSO_NHOOD_GLOBAL, PSO_W_APSO },
+    { PSO_NHOOD_RING,   PSO_W_APSO },
+    { PSO_NHOOD_RANDOM, PSO_W_APSO },
+};
+
+typedef struct {
+    pso_obj_fun_t fun;
+    pso_obj_batch_fun_t fun_batch;
+    void *params;
+} objective_t;
+
+typedef struct {
+    const objective_t *obj;
+    pso_settings_t settings;   // cópia das configurações base
+    pso_result_t result;
+    pso_state_t *state;
+    int steps;                 // fatia da rodada atual (-1 = não roda)
+    double best0;              // pbest do enxame no início da fatia
+    long evals0;               // avaliações no início da fatia
+    double rate;               // progresso por avaliação (média móvel)
+    int rounds;                // rodadas já medidas
+} arm_t;
+
+// Tarefa: uma fatia de um braço (a primeira cria o estado e avalia o
+// enxame inicial)
+static void arm_slice(void *p) {
+    arm_t *a = (arm_t *)p;
+
+    if (a->state == NULL) {
+        if (a->obj->fun_batch != NULL)
+            a->state = pso_state_new_batch(a->obj->fun_batch, a->obj->params,
+                                           &a->result, &a->settings);
+        else
+            a->state = pso_state_new(a->obj->fun, a->obj->params,
+                                     &a->result, &a->settings);
+        return;
+    }
+    pso_state_step(a->state, a->steps);
+}
+
+// Roda a fatia de todos os braços com steps >= 0 e espera
+static void run_round(pso_pool_t *pool, arm_t *arms, int n) {
+    pso_task_group_t group;
+    uint64_t t0 = pso_trace_begin();
+    int k, active = 0;
+
+    for (k=0; k<n; k++) active += arms[k].steps >= 0;
+    if (pool == NULL) {
+        for (k=0; k<n; k++) if (arms[k].steps >= 0) arm_slice(&arms[k]);
+    } else {
+        pso_task_group_init(&group);
+        for (k=0; k<n; k++)
+            if (arms[k].steps >= 0) pso_pool_spawn(pool, &group, arm_slice, &arms[k]);
+        pso_pool_sync(pool, &group);
+    }
+    pso_trace_end("round", t0, active);
+}
+
+static int portfolio_run(const objective_t *obj, const pso_settings_t *settings,
+                         const pso_portfolio_arm_t *arms, int narms,
+                         int threads, long max_evals,
+                         pso_result_t *solution, pso_portfolio_stats_t *stats)
+{
+    const double goal = settings->goal;
+    pso_shared_best_t *shared;
+    pso_pool_t *pool = NULL;
+    arm_t *a;
+    long total = 0;
+    int k, ok = 1;
+
+    if (arms == NULL || narms <= 0) {
+        arms = default_arms;
+        narms = PSO_PORTFOLIO_DEFAULT_ARMS;
+    }
+    if ((shared = pso_shared_best_new(settings->dim)) == NULL) return -1;
+    if (threads > 1 && (pool = pso_pool_new(threads, NULL)) == NULL) {
+        pso_shared_best_free(shared);
+        return -1;
+    }
+
+    a = (arm_t *)calloc(narms, sizeof(arm_t));
+    for (k=0; k<narms; k++) {
+        a[k].obj = obj;
+        a[k].settings = *settings;
+        a[k].settings.nhood_strategy = arms[k].nhood_strategy;
+        a[k].settings.w_strategy = arms[k].w_strategy;
+        a[k].settings.seed = settings->seed ? settings->seed + k : 0;
+        a[k].settings.print_every = 0;
+        a[k].settings.threads = 1;
+        a[k].settings.cpu_affinity = NULL;
+        a[k].settings.pool = pool;
+        a[k].settings.shared_best = shared;
+        a[k].settings.perf = NULL; // braços rodam em threads do pool
+        a[k].settings.metrics = NULL; // um escritor por página
+        a[k].result.gbest = (double *)malloc(settings->dim * sizeof(double));
+    }
+
+    // rodada 0: enxames iniciais
+    run_round(pool, a, narms);
+    for (k=0; k<narms; k++) if (a[k].state == NULL) ok = 0;
+
+    while (ok) {
+        double sum = 0.0;
+        int active = 0;
+
+        total = 0;
+        for (k=0; k<narms; k++) total += a[k].result.evals;
+        if (pso_shared_best_error(shared) <= goal) break;
+        if (max_evals > 0 && total >= max_evals) break;
+
+        for (k=0; k<narms; k++) {
+            a[k].steps = -1;
+            if (pso_state_done(a[k].state)) continue;
+            active++;
+            sum += a[k].rate * a[k].rate;
+        }
+        if (active == 0) break;
+
+        // divisão da rodada: piso igual + o resto pelo quadrado do
+        // progresso recente (favorece o líder mais que proporcionalmente:
+        // com o gbest compartilhado, os que só seguem também progridem)
+        for (k=0; k<narms; k++) {
+            if (pso_state_done(a[k].state)) continue;
+            double share = PSO_PORTFOLIO_FLOOR / active + (1.0 - PSO_PORTFOLIO_FLOOR) *
+                           (sum > 0 ? a[k].rate * a[k].rate / sum : 1.0 / active);
+            a[k].steps = (int)(share * active * PSO_PORTFOLIO_SLICE + 0.5);
+            if (max_evals > 0) {
+                long left = (long)(share * (max_evals - total)) / a[k].settings.size;
+                if (a[k].steps > left) a[k].steps = (int)left;
+            }
+            if (a[k].steps < 1) a[k].steps = 1;
+            a[k].best0 = pso_state_best(a[k].state);
+            a[k].evals0 = a[k].result.evals;
+        }
+
+        run_round(pool, a, narms);
+
+        // progresso = fração do caminho até o goal fechada por avaliação
+        // (independe da escala da função)
+        for (k=0; k<narms; k++) {
+            if (a[k].steps < 0) continue;
+            long used = a[k].result.evals - a[k].evals0;
+            double gap = a[k].best0 - goal, r = 0.0;
+            if (gap > 0 && used > 0)
+                r = (a[k].best0 - pso_state_best(a[k].state)) / gap / used;
+            if (r < 0) r = 0.0;
+            a[k].rate = a[k].rounds++ == 0 ? r
+                      : PSO_PORTFOLIO_ALPHA * r + (1.0 - PSO_PORTFOLIO_ALPHA) * a[k].rate;
+        }
+    }
+
+    memset(solution->evals_level, 0, sizeof(solution->evals_level));
+    solution->cost = 0.0;
+    solution->evals = solution->evals_aborted = 0;
+    for (k=0; k<narms; k++) {
+        solution->evals += a[k].result.evals;
+        solution->evals_aborted += a[k].result.evals_aborted;
+    }
+    solution->error = pso_shared_best_snapshot(shared, solution->gbest);
+
+    for (k=0; k<narms; k++) {
+        if (stats != NULL) {
+            stats[k].nhood_strategy = arms[k].nhood_strategy;
+            stats[k].w_strategy = arms[k].w_strategy;
+            stats[k].evals = a[k].result.evals;
+            stats[k].steps = a[k].state ? pso_state_steps_done(a[k].state) : 0;
+            stats[k].share = solution->evals > 0 ? (double)a[k].result.evals / solution->evals : 0.0;
+            stats[k].best = a[k].state ? pso_state_best(a[k].state) : DBL_MAX;
+            stats[k].goal = stats[k].best <= goal;
+        }
+        if (a[k].state != NULL) pso_state_free(a[k].state);
+        free(a[k].result.gbest);
+    }
+    free(a);
+    if (pool != NULL) pso_pool_free(pool);
+    pso_shared_best_free(shared);
+    return ok ? narms : -1;
+}
+
+int pso_portfolio_solve(pso_obj_fun_t obj_fun, void *obj_fun_params,
+                        const pso_settings_t *settings,
+                        const pso_portfolio_arm_t *arms, int narms,
+                        int threads, long max_evals,
+                        pso_result_t *solution, pso_portfolio_stats_t *stats)
+{
+    objective_t obj = { obj_fun, NULL, obj_fun_params };
+    return portfolio_run(&obj, settings, arms, narms, threads, max_evals,
+                         solution, stats);
+}
+
+int pso_portfolio_solve_batch(pso_obj_batch_fun_t obj_fun, void *obj_fun_params,
+                              const pso_settings_t *settings,
+                              const pso_portfolio_arm_t *arms, int narms,
+                              int threads, long max_evals,
+                              pso_result_t *solution, pso_portfolio_stats_t *stats)
+{
+    objective_t obj = { NULL, obj_fun, obj_fun_params };
+    return portfolio_run(&obj, settings, arms, narms, threads, max_evals,
+                         solution, stats);
+}
@@ -0,0 +1,78 @@
+/* Portfólio de configurações (corrida entre estratégias)
+
+   Para um problema novo não se sabe qual vizinhança (global, anel,
+   aleatória) e qual estratégia de inércia vão funcionar melhor. O
+   portfólio roda várias configurações ("braços") ao mesmo tempo, sobre um
+   único pool de threads, e dá mais núcleos às que estão progredindo:
+
+   - cada braço é um pso_state_t (API incremental) com uma cópia das
+     configurações base, trocando só nhood_strategy e w_strategy;
+   - o tempo é dividido em rodadas; em cada rodada todos os braços ativos
+     rodam uma fatia de passos em paralelo, e a fatia de cada um cresce
+     com o seu progresso recente (fração do caminho até o goal fechada
+     por avaliação, média móvel), com um piso para que nenhum braço
+     deixe de ser observado;
+   - as fatias e as avaliações de dentro delas são tarefas do mesmo pool
+     (roubo de tarefas): um braço com fatia maior fica com as threads que
+     os outros liberam, e é assim que os núcleos mudam de dono;
+   - todos os braços compartilham o melhor resultado (pso_shared.h): o
+     que um encontra vira o gbest dos outros.
+
+   Termina quando algum braço atinge o goal (tempo até o alvo), quando
+   todos esgotam settings->steps ou quando max_evals é atingido.
+
+     pso_portfolio_solve(minha_funcao, NULL, settings, NULL, 0,
+                         4, 0, &result, NULL);   // braços padrão, 4 threads
+*/
+
+#ifndef PSO_PORTFOLIO_H_
+#define PSO_PORTFOLIO_H_
+
+#include "pso.h"
+
+// Configuração de um braço (o resto vem das configurações base)
+typedef struct {
+    int nhood_strategy;    // PSO_NHOOD_*
+    int w_strategy;        // PSO_W_*
+} pso_portfolio_arm_t;
+
+// Braços padrão: as três vizinhanças com PSO_W_LIN_DEC e com PSO_W_APSO
+#define PSO_PORTFOLIO_DEFAULT_ARMS 6
+
+// Passos de cada braço por rodada quando a divisão é igual
+#define PSO_PORTFOLIO_SLICE 10
+
+typedef struct {
+    int nhood_strategy;
+    int w_strategy;
+    long evals;        // avaliações feitas pelo braço
+    int steps;         // passos executados
+    double share;      // fração das avaliações do portfólio gastas nele
+    double best;       // melhor pbest do próprio enxame
+    int goal;          // 1 se foi ele que atingiu o goal
+} pso_portfolio_stats_t;
+
+
+// settings: configurações base (goal, steps, size, limites...). Cada
+//           braço usa settings->seed + k (0 = relógio) e settings->threads
+//           é ignorado (as threads do pool são "threads").
+// arms/narms: braços; NULL (ou narms = 0) = braços padrão
+// threads: threads do pool compartilhado (0 ou 1 = serial)
+// max_evals: limite de avaliações somadas de todos os braços (0 = sem)
+// solution: melhor resultado; evals = soma de todos os braços
+// stats: NULL ou vetor com um item por braço
+// Retorna o número de braços, ou -1 em caso de falha.
+int pso_portfolio_solve(pso_obj_fun_t obj_fun, void *obj_fun_params,
+                        const pso_settings_t *settings,
+                        const pso_portfolio_arm_t *arms, int narms,
+                        int threads, long max_evals,
+                        pso_result_t *solution, pso_portfolio_stats_t *stats);
+
+// Igual, com função objetivo em lote (ver pso_solve_batch)
+int pso_portfolio_solve_batch(pso_obj_batch_fun_t obj_fun, void *obj_fun_params,
+                              const pso_settings_t *settings,
+                              const pso_portfolio_arm_t *arms, int narms,
+                              int threads, long max_evals,
+                              pso_result_t *solution, pso_portfolio_stats_t *stats);
+
+#endif // PSO_PORTFOLIO_H_
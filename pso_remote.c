@@ -0,0 +1,395 @@
+/* Avaliação remota: workers em outras máquinas (ou no 127.0.0.1)
+*/
+
+#include <stdio.h>      // snprintf()
+#include <stdlib.h>     // malloc(), free()
+#include <string.h>
+#include <time.h>       // clock_gettime()
+#include <pthread.h>
+#include <poll.h>
+#include <netdb.h>      // getaddrinfo()
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/time.h>   // struct timeval
+
+#include "pso_remote.h"
+#include "pso_wire.h"
+
+// intervalo mínimo entre tentativas de reconectar um worker
+#define RETRY_MS 1000
+
+
+// Conexão com um worker
+typedef struct {
+    char host[256];
+    char port[16];
+    int fd;                 // -1 = desconectado
+    int inflight;           // lotes enviados sem resposta
+    int ping_pending;
+    double last_recv;       // ns (monotônico) da última mensagem recebida
+    double retry_at;        // ns: próxima tentativa de reconexão
+} worker_t;
+
+// Lote de um passo: posições [lo, lo+count)
+typedef struct {
+    int lo, count;
+    int worker;             // -1 = na fila
+    int done;
+} task_t;
+
+struct pso_remote {
+    pthread_mutex_t lock;   // uma chamada de pso_remote_batch por vez
+    worker_t *w;
+    int nworkers;
+    char *objective;
+    int dim;
+
+    int chunk, window, heartbeat_ms, timeout_ms;
+
+    uint32_t next_id;       // ids de lote nunca se repetem
+
+    // buffers reaproveitados
+    unsigned char *buf;
+    size_t buf_cap;
+    task_t *tasks;
+    int *queue;
+    int tasks_cap;
+
+    pso_remote_stats_t stats;
+};
+
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static unsigned char *reserve(pso_remote_t *r, size_t len) {
+    if (len > r->buf_cap) {
+        free(r->buf);
+        r->buf = (unsigned char *)malloc(len);
+        r->buf_cap = r->buf ? len : 0;
+    }
+    return r->buf;
+}
+
+// Lê uma mensagem inteira (cabeçalho + corpo em r->buf)
+static int read_msg(pso_remote_t *r, int fd, pso_wire_hdr_t *h) {
+    unsigned char hdr[PSO_WIRE_HDR];
+    size_t len;
+
+    if (pso_wire_read_all(fd, hdr, sizeof(hdr)) != 0) return -1;
+    if (pso_wire_get_hdr(hdr, h) != 0) return -1;
+    if (h->type == PSO_MSG_RESULT) {
+        if (h->n > PSO_WIRE_MAX_DOUBLES) return -1;
+        len = 8 * (size_t)h->n;
+    } else if (h->type == PSO_MSG_ERROR) {
+        if (h->n > PSO_WIRE_MAX_TEXT) return -1;
+        len = h->n;
+    } else {
+        len = 0;
+    }
+    if (len > 0 && (reserve(r, len) == NULL || pso_wire_read_all(fd, r->buf, len) != 0))
+        return -1;
+    return 0;
+}
+
+// Conecta e faz o HELLO. Retorna 0 se o worker aceitou.
+static int worker_connect(pso_remote_t *r, worker_t *w, char *err, int errlen) {
+    struct addrinfo hints, *res = NULL, *ai;
+    int fd = -1;
+
+    // falhou há pouco: não insiste a cada passo
+    if (now_ns() < w->retry_at) return -1;
+    w->retry_at = now_ns() + RETRY_MS * 1e6;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(w->host, w->port, &hints, &res) != 0) {
+        snprintf(err, errlen, "%.100s:%.15s: endereco invalido", w->host, w->port);
+        return -1;
+    }
+
+    // timeouts de envio/recebimento (também limitam o connect)
+    struct timeval tv = { r->timeout_ms / 1000, (r->timeout_ms % 1000) * 1000 };
+    int one = 1;
+    for (ai = res; ai != NULL; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0) continue;
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) break;
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(res);
+    if (fd < 0) {
+        snprintf(err, errlen, "%.100s:%.15s: conexao recusada", w->host, w->port);
+        return -1;
+    }
+
+    unsigned char hdr[PSO_WIRE_HDR];
+    pso_wire_hdr_t h;
+    size_t len = strlen(r->objective);
+    pso_wire_put_hdr(hdr, PSO_MSG_HELLO, 0, (uint32_t)len, (uint32_t)r->dim);
+    if (pso_wire_write_all(fd, hdr, sizeof(hdr)) != 0 ||
+        pso_wire_write_all(fd, r->objective, len) != 0 ||
+        read_msg(r, fd, &h) != 0) {
+        snprintf(err, errlen, "%.100s:%.15s: sem resposta ao HELLO", w->host, w->port);
+        close(fd);
+        return -1;
+    }
+    if (h.type != PSO_MSG_HELLO_OK) {
+        snprintf(err, errlen, "%.100s:%.15s: %.*s", w->host, w->port,
+                 h.type == PSO_MSG_ERROR ? (int)h.n : 0, (const char *)r->buf);
+        close(fd);
+        return -1;
+    }
+
+    w->fd = fd;
+    w->inflight = 0;
+    w->ping_pending = 0;
+    w->last_recv = now_ns();
+    r->stats.alive++;
+    return 0;
+}
+
+// Worker morto: fecha e devolve os lotes dele para a fila
+static void worker_kill(pso_remote_t *r, int k, int ntasks, int *nqueue) {
+    worker_t *w = &r->w[k];
+    close(w->fd);
+    w->fd = -1;
+    w->inflight = 0;
+    r->stats.failures++;
+    r->stats.alive--;
+    for (int t=0; t<ntasks; t++) {
+        if (r->tasks[t].worker == k && !r->tasks[t].done) {
+            r->tasks[t].worker = -1;
+            r->queue[(*nqueue)++] = t;
+            r->stats.redispatched++;
+        }
+    }
+}
+
+static int send_task(pso_remote_t *r, worker_t *w, uint32_t id,
+                     double **x, const task_t *t)
+{
+    size_t len = PSO_WIRE_HDR + 8 * (size_t)t->count * r->dim;
+    unsigned char *p = reserve(r, len);
+    if (p == NULL) return -1;
+
+    pso_wire_put_hdr(p, PSO_MSG_EVAL, id, (uint32_t)t->count, (uint32_t)r->dim);
+    p += PSO_WIRE_HDR;
+    for (int i=0; i<t->count; i++)
+        for (int d=0; d<r->dim; d++, p += 8)
+            pso_wire_put_f64(p, x[t->lo + i][d]);
+    return pso_wire_write_all(w->fd, r->buf, len);
+}
+
+
+// ============================
+//         API PÚBLICA
+// ============================
+
+pso_remote_t *pso_remote_new(const char *workers, const char *objective,
+                             int dim, char *err, int errlen)
+{
+    char last_err[256] = "nenhum worker informado";
+    pso_remote_t *r = (pso_remote_t *)calloc(1, sizeof(pso_remote_t));
+    if (r == NULL) return NULL;
+
+    r->objective = strdup(objective);
+    r->dim = dim;
+    r->chunk = 0;
+    r->window = 2;
+    r->heartbeat_ms = 200;
+    r->timeout_ms = 2000;
+    pthread_mutex_init(&r->lock, NULL);
+
+    // "host:porta,host:porta,..."
+    char *list = strdup(workers), *save = NULL;
+    for (char *tok = strtok_r(list, ",", &save); tok; tok = strtok_r(NULL, ",", &save)) {
+        char *colon = strrchr(tok, ':');
+        if (colon == NULL) continue;
+        r->w = (worker_t *)realloc(r->w, (r->nworkers + 1) * sizeof(worker_t));
+        worker_t *w = &r->w[r->nworkers++];
+        *colon = '\0';
+        snprintf(w->host, sizeof(w->host), "%s", tok);
+        snprintf(w->port, sizeof(w->port), "%s", colon + 1);
+        w->fd = -1;
+        w->retry_at = 0;
+        worker_connect(r, w, last_err, sizeof(last_err));
+    }
+    free(list);
+
+    if (r->stats.alive == 0) {
+        if (err != NULL && errlen > 0) snprintf(err, errlen, "%s", last_err);
+        pso_remote_free(r);
+        return NULL;
+    }
+    return r;
+}
+
+void pso_remote_config(pso_remote_t *r, int chunk, int window,
+                       int heartbeat_ms, int timeout_ms)
+{
+    pthread_mutex_lock(&r->lock);
+    if (chunk > 0) r->chunk = chunk;
+    if (window > 0) r->window = window;
+    if (heartbeat_ms > 0) r->heartbeat_ms = heartbeat_ms;
+    if (timeout_ms > 0) r->timeout_ms = timeout_ms;
+    pthread_mutex_unlock(&r->lock);
+}
+
+void pso_remote_free(pso_remote_t *r) {
+    for (int k=0; k<r->nworkers; k++)
+        if (r->w[k].fd >= 0) close(r->w[k].fd);
+    pthread_mutex_destroy(&r->lock);
+    free(r->w);
+    free(r->objective);
+    free(r->buf);
+    free(r->tasks);
+    free(r->queue);
+    free(r);
+}
+
+void pso_remote_stats(pso_remote_t *r, pso_remote_stats_t *stats) {
+    pthread_mutex_lock(&r->lock);
+    *stats = r->stats;
+    pthread_mutex_unlock(&r->lock);
+}
+
+void pso_remote_batch(double **x, int dim, int n, double *fit, void *params) {
+    pso_remote_t *r = (pso_remote_t *)params;
+    struct pollfd *pfd;
+    int *pidx;
+    char err[256];
+    int k, t;
+    (void)dim;
+
+    if (n <= 0) return;
+    pthread_mutex_lock(&r->lock);
+
+    // tenta reconectar quem caiu
+    for (k=0; k<r->nworkers; k++)
+        if (r->w[k].fd < 0) worker_connect(r, &r->w[k], err, sizeof(err));
+
+    // divide o passo em lotes: "window" lotes por worker vivo
+    int chunk = r->chunk;
+    if (chunk <= 0) {
+        int slots = (r->stats.alive > 0 ? r->stats.alive : 1) * r->window;
+        chunk = (n + slots - 1) / slots;
+    }
+    int ntasks = (n + chunk - 1) / chunk;
+    if (ntasks > r->tasks_cap) {
+        free(r->tasks); free(r->queue);
+        r->tasks = (task_t *)malloc(ntasks * sizeof(task_t));
+        r->queue = (int *)malloc(ntasks * sizeof(int));
+        r->tasks_cap = ntasks;
+    }
+    int nqueue = 0, done = 0;
+    for (t=ntasks-1; t>=0; t--) {  // fila é uma pilha: lote 0 sai primeiro
+        r->tasks[t].lo = t * chunk;
+        r->tasks[t].count = (t + 1) * chunk < n ? chunk : n - t * chunk;
+        r->tasks[t].worker = -1;
+        r->tasks[t].done = 0;
+        r->queue[nqueue++] = t;
+    }
+    uint32_t base = r->next_id;
+    r->next_id += (uint32_t)ntasks;
+
+    pfd = (struct pollfd *)malloc(r->nworkers * sizeof(struct pollfd));
+    pidx = (int *)malloc(r->nworkers * sizeof(int));
+
+    while (done < ntasks) {
+        // envia lotes da fila para quem tem espaço na janela
+        for (k=0; k<r->nworkers && nqueue > 0; k++) {
+            worker_t *w = &r->w[k];
+            while (w->fd >= 0 && w->inflight < r->window && nqueue > 0) {
+                t = r->queue[--nqueue];
+                if (w->inflight == 0) w->last_recv = now_ns();
+                r->tasks[t].worker = k;
+                if (send_task(r, w, base + (uint32_t)t, x, &r->tasks[t]) != 0) {
+                    worker_kill(r, k, ntasks, &nqueue);
+                    break;
+                }
+                w->inflight++;
+                r->stats.batches++;
+            }
+        }
+
+        // nenhum worker vivo: o que falta fica sem avaliação
+        if (r->stats.alive == 0) {
+            for (t=0; t<ntasks; t++) {
+                if (r->tasks[t].done) continue;
+                for (int i=0; i<r->tasks[t].count; i++)
+                    fit[r->tasks[t].lo + i] = HUGE_VAL;
+                r->stats.unevaluated += r->tasks[t].count;
+            }
+            break;
+        }
+
+        // espera respostas (no máximo um intervalo de heartbeat)
+        int np = 0;
+        for (k=0; k<r->nworkers; k++) {
+            if (r->w[k].fd < 0 || r->w[k].inflight == 0) continue;
+            pfd[np].fd = r->w[k].fd;
+            pfd[np].events = POLLIN;
+            pfd[np].revents = 0;
+            pidx[np++] = k;
+        }
+        poll(pfd, np, r->heartbeat_ms);
+        double now = now_ns();
+
+        for (int p=0; p<np; p++) {
+            k = pidx[p];
+            worker_t *w = &r->w[k];
+            if (pfd[p].revents == 0) {
+                // silêncio: PING e, se persistir, worker morto
+                double quiet_ms = (now - w->last_recv) / 1e6;
+                if (quiet_ms > r->timeout_ms) {
+                    worker_kill(r, k, ntasks, &nqueue);
+                } else if (quiet_ms > r->heartbeat_ms && !w->ping_pending) {
+                    unsigned char hdr[PSO_WIRE_HDR];
+                    pso_wire_put_hdr(hdr, PSO_MSG_PING, 0, 0, 0);
+                    if (pso_wire_write_all(w->fd, hdr, sizeof(hdr)) != 0)
+                        worker_kill(r, k, ntasks, &nqueue);
+                    else
+                        w->ping_pending = 1;
+                }
+                continue;
+            }
+
+            pso_wire_hdr_t h;
+            if (read_msg(r, w->fd, &h) != 0 || h.type == PSO_MSG_ERROR) {
+                worker_kill(r, k, ntasks, &nqueue);
+                continue;
+            }
+            w->last_recv = now;
+            if (h.type == PSO_MSG_PONG) {
+                w->ping_pending = 0;
+                continue;
+            }
+            if (h.type != PSO_MSG_RESULT) continue;
+
+            t = (int)(h.id - base);
+            if (t < 0 || t >= ntasks) continue;
+            task_t *task = &r->tasks[t];
+            w->inflight--;
+            if (task->done || task->worker != k || (int)h.n != task->count)
+                continue;
+            for (int i=0; i<task->count; i++)
+                fit[task->lo + i] = pso_wire_get_f64(r->buf + 8 * i);
+            task->done = 1;
+            done++;
+            r->stats.positions += task->count;
+        }
+    }
+
+    free(pfd);
+    free(pidx);
+    pthread_mutex_unlock(&r->lock);
+}
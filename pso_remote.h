@@ -0,0 +1,63 @@
+/* Avaliação remota: workers em outras máquinas (ou no 127.0.0.1)
+
+   O solver continua igual; só a avaliação do passo vai para a rede:
+
+     pso_remote_t *r = pso_remote_new("10.0.0.1:7700,10.0.0.2:7700",
+                                      "fun:rastrigin", dim, err, sizeof(err));
+     pso_solve_batch(pso_remote_batch, r, &result, settings);
+
+   A cada passo as posições são divididas em lotes e distribuídas entre os
+   workers (pso_worker), com vários lotes em voo por worker (pipeline).
+   Um worker que fecha a conexão, responde erro ou fica em silêncio além do
+   timeout (mesmo depois de um PING) é dado como morto e seus lotes são
+   reenviados aos outros; no próximo passo tenta-se reconectar.
+   Protocolo em pso_wire.h.
+*/
+
+#ifndef PSO_REMOTE_H_
+#define PSO_REMOTE_H_
+
+#include "pso.h"
+
+// Estrutura opaca (ver pso_remote.c)
+typedef struct pso_remote pso_remote_t;
+
+// Contadores acumulados
+typedef struct {
+    long batches;        // lotes enviados (incluindo reenvios)
+    long positions;      // posições avaliadas
+    long redispatched;   // lotes reenviados após falha de worker
+    long failures;       // workers dados como mortos
+    long unevaluated;    // posições sem worker vivo (fitness = HUGE_VAL)
+    int alive;           // workers conectados agora
+} pso_remote_stats_t;
+
+
+// Conecta aos workers ("host:porta" separados por vírgula) e escolhe o
+// objetivo em todos ("fun:NOME" ou "plugin:ARQ.so[:ARGS]", resolvido no
+// worker; plugin: só se ele foi iniciado com --allow-plugin). Basta um worker aceitar para dar certo; os outros são
+// tentados de novo a cada passo.
+// Retorna NULL (e o motivo em err) se nenhum worker aceitar.
+pso_remote_t *pso_remote_new(const char *workers, const char *objective,
+                             int dim, char *err, int errlen);
+
+// Ajustes (valores <= 0 mantêm o atual):
+// chunk        posições por lote (padrão: automático, window lotes por worker)
+// window       lotes em voo por worker (padrão 2)
+// heartbeat_ms silêncio que dispara um PING (padrão 200)
+// timeout_ms   silêncio que declara o worker morto (padrão 2000)
+void pso_remote_config(pso_remote_t *remote, int chunk, int window,
+                       int heartbeat_ms, int timeout_ms);
+
+// Fecha as conexões e libera
+void pso_remote_free(pso_remote_t *remote);
+
+// Função objetivo em lote para pso_solve_batch (params = remote).
+// Se todos os workers caírem, as posições restantes recebem HUGE_VAL
+// (nunca viram pbest) e são contadas em stats.unevaluated.
+void pso_remote_batch(double **x, int dim, int n, double *fit, void *remote);
+
+// Copia os contadores atuais
+void pso_remote_stats(pso_remote_t *remote, pso_remote_stats_t *stats);
+
+#endif // PSO_REMOTE_H_
@@ -0,0 +1,85 @@
+/* Gerador de números aleatórios baseado em contador (Philox4x32-10)
+
+   Cada sorteio é uma função pura de (semente, passo, partícula, dimensão,
+   fluxo): não há estado sequencial como no rand(). Assim qualquer thread
+   gera exatamente os mesmos números para qualquer partícula, e o
+   resultado não depende da ordem de execução nem do número de threads.
+   Referência: Salmon et al., "Parallel random numbers: as easy as
+   1, 2, 3" (SC'11).
+*/
+
+#ifndef PSO_RNG_H_
+#define PSO_RNG_H_
+
+#include <stdint.h>
+
+
+// Fluxos independentes (4º word do contador)
+#define PSO_RNG_INIT   0   // posição/velocidade iniciais
+#define PSO_RNG_UPDATE 1   // rho1/rho2 da atualização de velocidade
+#define PSO_RNG_TOPO   2   // sorteio da vizinhança RANDOM
+#define PSO_RNG_DATA   3   // sorteio de mini-lotes (pso_dataset.h)
+#define PSO_RNG_APSO   4   // aceleração e perturbação elitista (APSO)
+
+// Chave do gerador (derivada da semente)
+typedef struct {
+    uint32_t key[2];
+} pso_rng_t;
+
+
+// Inicializa a chave a partir de uma semente de 64 bits
+static inline pso_rng_t pso_rng_new(uint64_t seed) {
+    pso_rng_t r;
+    r.key[0] = (uint32_t)seed;
+    r.key[1] = (uint32_t)(seed >> 32);
+    return r;
+}
+
+// Philox4x32 com 10 rodadas: out = bijeção(ctr) sob a chave key
+static inline void pso_philox4x32(const uint32_t ctr[4], const uint32_t key[2],
+                                  uint32_t out[4]) {
+    uint32_t c0 = ctr[0], c1 = ctr[1], c2 = ctr[2], c3 = ctr[3];
+    uint32_t k0 = key[0], k1 = key[1];
+
+    for (int r=0; r<10; r++) {
+        uint64_t p0 = (uint64_t)0xD2511F53u * c0;
+        uint64_t p1 = (uint64_t)0xCD9E8D57u * c2;
+        uint32_t n0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+        uint32_t n2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+        c1 = (uint32_t)p1;
+        c3 = (uint32_t)p0;
+        c0 = n0;
+        c2 = n2;
+        k0 += 0x9E3779B9u;
+        k1 += 0xBB67AE85u;
+    }
+    out[0] = c0; out[1] = c1; out[2] = c2; out[3] = c3;
+}
+
+// Converte dois words de 32 bits em um double no intervalo (0, 1)
+// (53 bits de mantissa; nunca retorna 0 nem 1)
+static inline double pso_rng_u53(uint32_t hi, uint32_t lo) {
+    uint64_t m = ((uint64_t)hi << 21) ^ (lo >> 11);
+    return ((double)(m & ((1ULL << 53) - 1)) + 0.5) * (1.0 / 9007199254740992.0);
+}
+
+// Dois uniformes em (0, 1) para (passo, partícula, dimensão, fluxo)
+static inline void pso_rng_draw2(const pso_rng_t *rng, int step, int particle,
+                                 int d, int stream, double *u1, double *u2) {
+    const uint32_t ctr[4] = { (uint32_t)step, (uint32_t)particle,
+                              (uint32_t)d, (uint32_t)stream };
+    uint32_t out[4];
+    pso_philox4x32(ctr, rng->key, out);
+    *u1 = pso_rng_u53(out[0], out[1]);
+    *u2 = pso_rng_u53(out[2], out[3]);
+}
+
+// Gera de uma vez os pares (u1[d], u2[d]) de todas as n dimensões de uma
+// partícula; cada iteração é independente (o compilador pode vetorizar)
+static inline void pso_rng_block(const pso_rng_t *rng, int step, int particle,
+                                 int stream, int n, double *u1, double *u2) {
+    for (int d=0; d<n; d++)
+        pso_rng_draw2(rng, step, particle, d, stream, &u1[d], &u2[d]);
+}
+
+#endif // PSO_RNG_H_
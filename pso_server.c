@@ -0,0 +1,693 @@
+/* Servidor de otimização (socket Unix)
+
+   Recebe pedidos de otimização ("jobs") por um socket de domínio Unix,
+   agenda todos em um conjunto fixo de threads com prioridade e prazo e
+   devolve progresso e resultado pela mesma conexão.
+
+   Cada job é um pso_state_t (API incremental): as threads executam um
+   pedaço de poucos passos ("fatia") e devolvem o job à fila, de modo que
+   jobs longos não monopolizam as threads.
+
+   uso:
+     pso_server [-s socket] [-t threads] [-q passos_por_fatia]
+     pso_server -c [socket]       cliente: envia stdin, imprime respostas
+
+   Protocolo (uma linha por mensagem, campos chave=valor):
+
+     cliente -> servidor
+       job id=ID (fun=NOME | plugin=ARQ.so [plugin_args=S]) dim=N
+           [lo=X] [hi=X] [size=N] [steps=N] [goal=X]
+           [c1=X] [c2=X] [w=const|lindec|apso] [w_max=X] [w_min=X]
+           [nhood=global|ring|random] [nhood_size=N] [clamp=0|1] [seed=N]
+           [priority=N] [deadline_ms=N] [budget=N] [progress=N]
+       cancel id=ID
+
+     servidor -> cliente
+       accepted ID
+       progress ID step=N error=X evals=N
+       result ID status=S error=X evals=N steps=N gbest=x1,x2,...
+       error ID mensagem
+
+   fun: função embutida (pso_funcs.h); plugin: objetivo carregado de uma
+   biblioteca compartilhada (pso_plugin.h), mantida carregada para os
+   jobs seguintes com o mesmo arquivo e argumentos.
+   priority: maior = mais urgente (padrão 0). Entre jobs de mesma
+   prioridade roda primeiro o de prazo mais próximo; sem prazo, revezam.
+   deadline_ms: prazo relativo à chegada; estourado, o job termina com o
+   melhor resultado até ali (status=deadline).
+   budget: máximo de avaliações da função objetivo (status=budget).
+   progress: envia uma linha de progresso a cada N passos (0 = não envia).
+   status: done (steps), goal, budget, deadline ou cancelled.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "pso.h"
+#include "pso_funcs.h"
+#include "pso_plugin.h"
+
+#define DEFAULT_SOCKET "/tmp/pso.sock"
+#define LINE_MAX_LEN   4096
+#define ID_MAX_LEN     64
+
+
+// ============================
+//     CONEXÕES E JOBS
+// ============================
+
+// Conexão de um cliente: compartilhada pela thread leitora e pelos jobs
+// criados por ela; o socket é fechado quando a última referência sai
+typedef struct {
+    int fd;
+    pthread_mutex_t write_lock;  // uma linha inteira por vez
+    int refs;                    // protegido por sched.lock
+    atomic_int dead;             // escrita falhou (cliente foi embora)
+} conn_t;
+
+typedef struct job {
+    char id[ID_MAX_LEN];
+    conn_t *conn;
+
+    pso_settings_t *settings;
+    pso_result_t result;
+    pso_obj_fun_t fun;           // função embutida ou
+    pso_plugin_t *plugin;        // plugin (avaliado em lote)
+    pso_state_t *state;          // criado na primeira fatia
+
+    int priority;
+    double deadline;             // relógio monotônico em ns (0 = sem prazo)
+    long budget;                 // máximo de avaliações (0 = sem limite)
+    int progress;                // progresso a cada N passos (0 = não envia)
+    int next_progress;
+
+    long seq;                    // ordem de chegada na fila (revezamento)
+    atomic_int cancelled;
+    struct job *next_all;        // lista de todos os jobs vivos
+} job_t;
+
+// Fila de prioridade (heap binário) + threads de trabalho
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t ready;
+    job_t **heap;
+    int n, cap;                  // cap >= jobs vivos (heap_reserve)
+    int njobs;                   // jobs vivos (em all)
+    long seq;
+    job_t *all;                  // jobs vivos (para cancelamento)
+    int slice;                   // passos por fatia
+} sched;
+
+// Plugins já carregados (nunca descarregados enquanto o servidor roda)
+typedef struct loaded_plugin {
+    char *path, *args;
+    pso_plugin_t *plugin;
+    struct loaded_plugin *next;
+} loaded_plugin_t;
+
+static pthread_mutex_t plugins_lock = PTHREAD_MUTEX_INITIALIZER;
+static loaded_plugin_t *plugins = NULL;
+
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Envia uma linha ao cliente (printf-like). Falha marca a conexão morta
+// (os jobs dela são cancelados na próxima fatia).
+static void conn_printf(conn_t *c, const char *fmt, ...) {
+    char stack_buf[LINE_MAX_LEN];
+    char *buf = stack_buf;
+    va_list ap;
+
+    if (atomic_load(&c->dead)) return;
+
+    va_start(ap, fmt);
+    int len = vsnprintf(stack_buf, sizeof(stack_buf), fmt, ap);
+    va_end(ap);
+    if (len < 0) return;
+    if (len >= (int)sizeof(stack_buf)) {
+        // linha longa (gbest com muitas dimensões)
+        buf = (char *)malloc(len + 1);
+        if (buf == NULL) return;
+        va_start(ap, fmt);
+        vsnprintf(buf, len + 1, fmt, ap);
+        va_end(ap);
+    }
+
+    pthread_mutex_lock(&c->write_lock);
+    for (int off=0; off<len; ) {
+        ssize_t k = send(c->fd, buf + off, len - off, MSG_NOSIGNAL);
+        if (k < 0 && errno == EINTR) continue;
+        if (k <= 0) { atomic_store(&c->dead, 1); break; }
+        off += (int)k;
+    }
+    pthread_mutex_unlock(&c->write_lock);
+
+    if (buf != stack_buf) free(buf);
+}
+
+// Solta uma referência (chamar com sched.lock)
+static void conn_release_locked(conn_t *c) {
+    if (--c->refs > 0) return;
+    close(c->fd);
+    pthread_mutex_destroy(&c->write_lock);
+    free(c);
+}
+
+
+// ============================
+//      FILA DE PRIORIDADE
+// ============================
+
+// 1 se a deve rodar antes de b
+static int job_before(const job_t *a, const job_t *b) {
+    if (a->priority != b->priority) return a->priority > b->priority;
+    if (a->deadline != b->deadline) {
+        if (a->deadline == 0) return 0;
+        if (b->deadline == 0) return 1;
+        return a->deadline < b->deadline;
+    }
+    return a->seq < b->seq;
+}
+
+// Garante lugar no heap para mais um job vivo. Como todo job vivo cabe,
+// heap_push (inclusive a volta de uma fatia) nunca precisa crescer.
+// Retorna -1 sem memória.
+static int heap_reserve(void) {
+    if (sched.njobs < sched.cap) return 0;
+    int cap = sched.cap ? 2 * sched.cap : 64;
+    job_t **heap = (job_t **)realloc(sched.heap, cap * sizeof(job_t *));
+    if (heap == NULL) return -1;
+    sched.heap = heap;
+    sched.cap = cap;
+    return 0;
+}
+
+static void heap_push(job_t *j) {
+    j->seq = sched.seq++;
+    int k = sched.n++;
+    while (k > 0) {
+        int p = (k - 1) / 2;
+        if (!job_before(j, sched.heap[p])) break;
+        sched.heap[k] = sched.heap[p];
+        k = p;
+    }
+    sched.heap[k] = j;
+}
+
+static job_t *heap_pop(void) {
+    job_t *top = sched.heap[0];
+    job_t *last = sched.heap[--sched.n];
+    int k = 0;
+    for (;;) {
+        int c = 2 * k + 1;
+        if (c >= sched.n) break;
+        if (c + 1 < sched.n && job_before(sched.heap[c + 1], sched.heap[c])) c++;
+        if (!job_before(sched.heap[c], last)) break;
+        sched.heap[k] = sched.heap[c];
+        k = c;
+    }
+    if (sched.n > 0) sched.heap[k] = last;
+    return top;
+}
+
+
+// ============================
+//      EXECUÇÃO DOS JOBS
+// ============================
+
+static void job_send_result(job_t *j, const char *status) {
+    int dim = j->settings->dim;
+    // "%.17g," por coordenada
+    char *gb = (char *)malloc(dim * 26 + 1);
+    int len = 0;
+
+    if (gb == NULL) return;
+    gb[0] = '\0';
+    for (int d=0; d<dim; d++)
+        len += sprintf(gb + len, d ? ",%.17g" : "%.17g", j->result.gbest[d]);
+
+    conn_printf(j->conn, "result %s status=%s error=%.17g evals=%ld steps=%d gbest=%s\n",
+                j->id, status, j->result.error, j->result.evals,
+                j->state ? pso_state_steps_done(j->state) : 0, gb);
+    free(gb);
+}
+
+static void job_free(job_t *j) {
+    pthread_mutex_lock(&sched.lock);
+    for (job_t **p = &sched.all; *p != NULL; p = &(*p)->next_all) {
+        if (*p == j) { *p = j->next_all; break; }
+    }
+    sched.njobs--;
+    conn_release_locked(j->conn);
+    pthread_mutex_unlock(&sched.lock);
+
+    if (j->state) pso_state_free(j->state);
+    free(j->result.gbest);
+    pso_settings_free(j->settings);
+    free(j);
+}
+
+// Roda uma fatia do job. Retorna o status final ou NULL se deve voltar
+// para a fila.
+static const char *job_run_slice(job_t *j) {
+    pso_settings_t *s = j->settings;
+
+    if (atomic_load(&j->cancelled) || atomic_load(&j->conn->dead))
+        return "cancelled";
+    if (j->deadline != 0 && now_ns() >= j->deadline)
+        return "deadline";
+
+    if (j->state == NULL) {
+        // primeira fatia: avaliação do enxame inicial
+        if (j->plugin != NULL)
+            j->state = pso_state_new_batch(pso_plugin_batch, j->plugin, &j->result, s);
+        else
+            j->state = pso_state_new(j->fun, NULL, &j->result, s);
+        if (j->state == NULL) return "error";
+        if (pso_state_done(j->state))
+            return j->result.error <= s->goal ? "goal" : "done";
+        return NULL;
+    }
+
+    // limita a fatia para não passar do orçamento de avaliações
+    int steps = sched.slice;
+    if (j->budget > 0) {
+        long left = (j->budget - j->result.evals) / s->size;
+        if (left <= 0) return "budget";
+        if (left < steps) steps = (int)left;
+    }
+
+    int finished = pso_state_step(j->state, steps);
+    int done_steps = pso_state_steps_done(j->state);
+
+    if (j->progress > 0 && done_steps >= j->next_progress) {
+        conn_printf(j->conn, "progress %s step=%d error=%.17g evals=%ld\n",
+                    j->id, done_steps, j->result.error, j->result.evals);
+        while (j->next_progress <= done_steps) j->next_progress += j->progress;
+    }
+
+    if (finished)
+        return j->result.error <= s->goal ? "goal" : "done";
+    if (j->budget > 0 && j->result.evals + s->size > j->budget)
+        return "budget";
+    return NULL;
+}
+
+static void *worker_main(void *p) {
+    (void)p;
+    for (;;) {
+        pthread_mutex_lock(&sched.lock);
+        while (sched.n == 0)
+            pthread_cond_wait(&sched.ready, &sched.lock);
+        job_t *j = heap_pop();
+        pthread_mutex_unlock(&sched.lock);
+
+        const char *status = job_run_slice(j);
+        if (status == NULL) {
+            // revezamento: volta para o fim dos jobs de mesma prioridade
+            pthread_mutex_lock(&sched.lock);
+            heap_push(j);
+            pthread_mutex_unlock(&sched.lock);
+            continue;
+        }
+        job_send_result(j, status);
+        job_free(j);
+    }
+    return NULL;
+}
+
+
+// ============================
+//     LEITURA DOS PEDIDOS
+// ============================
+
+// Plugin (path, args) da cache, carregando se necessário
+static pso_plugin_t *plugin_get(const char *path, const char *args,
+                                char *err, int errlen)
+{
+    loaded_plugin_t *lp;
+    const char *a = args ? args : "";
+
+    pthread_mutex_lock(&plugins_lock);
+    for (lp = plugins; lp != NULL; lp = lp->next) {
+        if (strcmp(lp->path, path) == 0 && strcmp(lp->args, a) == 0)
+            break;
+    }
+    if (lp == NULL) {
+        pso_plugin_t *pl = pso_plugin_load(path, args, err, errlen);
+        if (pl != NULL) {
+            lp = (loaded_plugin_t *)malloc(sizeof(loaded_plugin_t));
+            if (lp == NULL || (lp->path = strdup(path)) == NULL) {
+                free(lp);
+                lp = NULL;
+            } else if ((lp->args = strdup(a)) == NULL) {
+                free(lp->path);
+                free(lp);
+                lp = NULL;
+            }
+            if (lp == NULL) {
+                pso_plugin_unload(pl);
+                snprintf(err, errlen, "sem memoria para o plugin");
+            } else {
+                lp->plugin = pl;
+                lp->next = plugins;
+                plugins = lp;
+            }
+        }
+    }
+    pthread_mutex_unlock(&plugins_lock);
+    return lp ? lp->plugin : NULL;
+}
+
+// Preenche o job com os campos "chave=valor" da linha.
+// Retorna NULL se ok ou a mensagem de erro (err: espaço para mensagens
+// montadas na hora).
+static const char *job_parse(job_t *j, char *line, char *err, int errlen) {
+    char *save = NULL, *tok;
+    const pso_func_info_t *info = NULL;
+    char plugin_path[LINE_MAX_LEN] = "", plugin_args[LINE_MAX_LEN] = "";
+    int dim = 0;
+    int have_lo = 0, have_hi = 0;
+    double lo = 0, hi = 0;
+
+    // 1ª passada: campos necessários para criar o settings
+    char *copy = strdup(line);
+    for (tok = strtok_r(copy, " \t", &save); tok; tok = strtok_r(NULL, " \t", &save)) {
+        char *eq = strchr(tok, '=');
+        if (eq == NULL) continue;
+        *eq = '\0';
+        const char *val = eq + 1;
+        if (strcmp(tok, "id") == 0) {
+            snprintf(j->id, sizeof(j->id), "%s", val);
+        } else if (strcmp(tok, "fun") == 0) {
+            info = pso_funcs_find(val);
+        } else if (strcmp(tok, "plugin") == 0) {
+            snprintf(plugin_path, sizeof(plugin_path), "%s", val);
+        } else if (strcmp(tok, "plugin_args") == 0) {
+            snprintf(plugin_args, sizeof(plugin_args), "%s", val);
+        } else if (strcmp(tok, "dim") == 0) {
+            dim = atoi(val);
+        } else if (strcmp(tok, "lo") == 0) {
+            lo = atof(val); have_lo = 1;
+        } else if (strcmp(tok, "hi") == 0) {
+            hi = atof(val); have_hi = 1;
+        }
+    }
+    free(copy);
+
+    if (dim < 1) return "dim invalida";
+    if (plugin_path[0] != '\0') {
+        j->plugin = plugin_get(plugin_path, plugin_args[0] ? plugin_args : NULL,
+                               err, errlen);
+        if (j->plugin == NULL) return err;
+        if (!have_lo) lo = pso_plugin_api(j->plugin)->lo;
+        if (!have_hi) hi = pso_plugin_api(j->plugin)->hi;
+    } else {
+        if (info == NULL) return "fun ausente ou desconhecida";
+        j->fun = info->fun;
+        if (!have_lo) lo = info->lo;
+        if (!have_hi) hi = info->hi;
+    }
+    if (!(lo < hi)) return "lo >= hi";
+
+    j->settings = pso_settings_new(dim, lo, hi);
+    if (j->settings == NULL) return "sem memoria";
+    j->settings->print_every = 0;
+
+    // 2ª passada: o resto dos campos
+    pso_settings_t *s = j->settings;
+    save = NULL;
+    for (tok = strtok_r(line, " \t", &save); tok; tok = strtok_r(NULL, " \t", &save)) {
+        char *eq = strchr(tok, '=');
+        if (eq == NULL) continue;
+        *eq = '\0';
+        const char *val = eq + 1;
+
+        if      (strcmp(tok, "size") == 0)        s->size = atoi(val);
+        else if (strcmp(tok, "steps") == 0)       s->steps = atoi(val);
+        else if (strcmp(tok, "goal") == 0)        s->goal = atof(val);
+        else if (strcmp(tok, "c1") == 0)          s->c1 = atof(val);
+        else if (strcmp(tok, "c2") == 0)          s->c2 = atof(val);
+        else if (strcmp(tok, "w_max") == 0)       s->w_max = atof(val);
+        else if (strcmp(tok, "w_min") == 0)       s->w_min = atof(val);
+        else if (strcmp(tok, "nhood_size") == 0)  s->nhood_size = atoi(val);
+        else if (strcmp(tok, "clamp") == 0)       s->clamp_pos = atoi(val) != 0;
+        else if (strcmp(tok, "seed") == 0)        s->seed = (unsigned int)strtoul(val, NULL, 10);
+        else if (strcmp(tok, "priority") == 0)    j->priority = atoi(val);
+        else if (strcmp(tok, "budget") == 0)      j->budget = atol(val);
+        else if (strcmp(tok, "progress") == 0)    j->progress = atoi(val);
+        else if (strcmp(tok, "deadline_ms") == 0) j->deadline = now_ns() + atof(val) * 1e6;
+        else if (strcmp(tok, "w") == 0) {
+            if      (strcmp(val, "const") == 0)  s->w_strategy = PSO_W_CONST;
+            else if (strcmp(val, "lindec") == 0) s->w_strategy = PSO_W_LIN_DEC;
+            else if (strcmp(val, "apso") == 0)   s->w_strategy = PSO_W_APSO;
+            else return "w invalido";
+        } else if (strcmp(tok, "nhood") == 0) {
+            if      (strcmp(val, "global") == 0) s->nhood_strategy = PSO_NHOOD_GLOBAL;
+            else if (strcmp(val, "ring") == 0)   s->nhood_strategy = PSO_NHOOD_RING;
+            else if (strcmp(val, "random") == 0) s->nhood_strategy = PSO_NHOOD_RANDOM;
+            else return "nhood invalido";
+        }
+    }
+
+    if (s->size < 1 || s->size > PSO_MAX_SIZE) return "size invalido";
+    // o anel precisa de vizinhos distintos (init_comm_ring)
+    if (s->size < 2 && s->nhood_strategy == PSO_NHOOD_RING)
+        return "size=1 exige nhood=global ou random";
+    if (s->steps < 0) return "steps invalido";
+    if (s->nhood_size > s->size) s->nhood_size = s->size;
+    j->next_progress = j->progress;
+    return NULL;
+}
+
+static void submit_job(conn_t *c, char *line) {
+    job_t *j = (job_t *)calloc(1, sizeof(job_t));
+    if (j == NULL) return;
+    snprintf(j->id, sizeof(j->id), "-");
+
+    char msg[256];
+    const char *err = job_parse(j, line, msg, sizeof(msg));
+    if (err != NULL) {
+        conn_printf(c, "error %s %s\n", j->id, err);
+        if (j->settings) pso_settings_free(j->settings);
+        free(j);
+        return;
+    }
+    j->conn = c;
+    // (resultado vazio caso o job seja cancelado antes da 1ª fatia)
+    j->result.gbest = (double *)calloc(j->settings->dim, sizeof(double));
+    j->result.error = HUGE_VAL;
+    atomic_init(&j->cancelled, 0);
+
+    // lugar no heap antes de aceitar (sem memória: recusa o job)
+    pthread_mutex_lock(&sched.lock);
+    int room = j->result.gbest != NULL && heap_reserve() == 0;
+    if (room) {
+        c->refs++;
+        j->next_all = sched.all;
+        sched.all = j;
+        sched.njobs++;
+    }
+    pthread_mutex_unlock(&sched.lock);
+    if (!room) {
+        conn_printf(c, "error %s sem memoria\n", j->id);
+        free(j->result.gbest);
+        pso_settings_free(j->settings);
+        free(j);
+        return;
+    }
+
+    conn_printf(c, "accepted %s\n", j->id);
+
+    pthread_mutex_lock(&sched.lock);
+    heap_push(j);
+    pthread_cond_signal(&sched.ready);
+    pthread_mutex_unlock(&sched.lock);
+}
+
+static void cancel_job(conn_t *c, char *line) {
+    char id[ID_MAX_LEN];
+    const char *p = strstr(line, "id=");
+    int found = 0;
+    if (p == NULL) {
+        conn_printf(c, "error - cancel sem id\n");
+        return;
+    }
+    snprintf(id, sizeof(id), "%.*s", (int)strcspn(p + 3, " \t"), p + 3);
+    pthread_mutex_lock(&sched.lock);
+    for (job_t *j = sched.all; j != NULL; j = j->next_all) {
+        if (j->conn == c && strcmp(j->id, id) == 0) {
+            atomic_store(&j->cancelled, 1);
+            found = 1;
+        }
+    }
+    pthread_mutex_unlock(&sched.lock);
+    if (!found) conn_printf(c, "error %s job desconhecido\n", id);
+}
+
+// Thread de leitura de uma conexão
+static void *conn_main(void *p) {
+    conn_t *c = (conn_t *)p;
+    char buf[LINE_MAX_LEN];
+    int len = 0;
+
+    for (;;) {
+        ssize_t k = read(c->fd, buf + len, sizeof(buf) - 1 - len);
+        if (k < 0 && errno == EINTR) continue;
+        if (k <= 0) break;
+        len += (int)k;
+
+        // processa as linhas completas
+        char *start = buf, *nl;
+        while ((nl = memchr(start, '\n', buf + len - start)) != NULL) {
+            *nl = '\0';
+            if (nl > start && nl[-1] == '\r') nl[-1] = '\0';
+            if (strncmp(start, "job ", 4) == 0)
+                submit_job(c, start + 4);
+            else if (strncmp(start, "cancel ", 7) == 0)
+                cancel_job(c, start + 7);
+            else if (*start != '\0')
+                conn_printf(c, "error - comando desconhecido\n");
+            start = nl + 1;
+        }
+        len -= (int)(start - buf);
+        memmove(buf, start, len);
+        if (len == (int)sizeof(buf) - 1) {
+            conn_printf(c, "error - linha longa demais\n");
+            len = 0;
+        }
+    }
+
+    // fim da leitura: os jobs continuam e a conexão fecha com o último
+    shutdown(c->fd, SHUT_RD);
+    pthread_mutex_lock(&sched.lock);
+    conn_release_locked(c);
+    pthread_mutex_unlock(&sched.lock);
+    return NULL;
+}
+
+
+// ============================
+//   SERVIDOR / CLIENTE (MAIN)
+// ============================
+
+static int unix_addr(struct sockaddr_un *addr, const char *path) {
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr->sun_path)) return -1;
+    strcpy(addr->sun_path, path);
+    return 0;
+}
+
+static int run_server(const char *path, int nthreads) {
+    struct sockaddr_un addr;
+    int lfd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (lfd < 0 || unix_addr(&addr, path) != 0) {
+        fprintf(stderr, "socket invalido: %s\n", path);
+        return 1;
+    }
+    unlink(path);
+    if (bind(lfd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(lfd, 64) != 0) {
+        perror("bind/listen");
+        return 1;
+    }
+
+    pthread_mutex_init(&sched.lock, NULL);
+    pthread_cond_init(&sched.ready, NULL);
+    for (int t=0; t<nthreads; t++) {
+        pthread_t th;
+        pthread_create(&th, NULL, worker_main, NULL);
+        pthread_detach(th);
+    }
+    fprintf(stderr, "pso_server: %s, %d threads, %d passos por fatia\n",
+            path, nthreads, sched.slice);
+
+    for (;;) {
+        int fd = accept(lfd, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            perror("accept");
+            break;
+        }
+        conn_t *c = (conn_t *)malloc(sizeof(conn_t));
+        c->fd = fd;
+        c->refs = 1; // a thread leitora
+        atomic_init(&c->dead, 0);
+        pthread_mutex_init(&c->write_lock, NULL);
+
+        pthread_t th;
+        pthread_create(&th, NULL, conn_main, c);
+        pthread_detach(th);
+    }
+    close(lfd);
+    return 1;
+}
+
+// Cliente simples: envia stdin e imprime tudo que chegar até o servidor
+// fechar a conexão (depois que todos os jobs enviados terminarem)
+static int run_client(const char *path) {
+    struct sockaddr_un addr;
+    char buf[LINE_MAX_LEN];
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    ssize_t k;
+
+    if (fd < 0 || unix_addr(&addr, path) != 0 ||
+        connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        perror("connect");
+        return 1;
+    }
+    while ((k = read(STDIN_FILENO, buf, sizeof(buf))) > 0) {
+        if (write(fd, buf, k) != k) { perror("write"); return 1; }
+    }
+    shutdown(fd, SHUT_WR);
+    while ((k = read(fd, buf, sizeof(buf))) > 0)
+        fwrite(buf, 1, k, stdout);
+    close(fd);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    const char *path = DEFAULT_SOCKET;
+    int nthreads = 4;
+    int client = 0;
+
+    sched.slice = 10;
+    for (int k=1; k<argc; k++) {
+        if (strcmp(argv[k], "-c") == 0) {
+            client = 1;
+            if (k + 1 < argc && argv[k+1][0] != '-') path = argv[++k];
+        } else if (strcmp(argv[k], "-s") == 0 && k + 1 < argc) {
+            path = argv[++k];
+        } else if (strcmp(argv[k], "-t") == 0 && k + 1 < argc) {
+            nthreads = atoi(argv[++k]);
+        } else if (strcmp(argv[k], "-q") == 0 && k + 1 < argc) {
+            sched.slice = atoi(argv[++k]);
+        } else {
+            fprintf(stderr,
+                    "uso: %s [-s socket] [-t threads] [-q passos_por_fatia]\n"
+                    "     %s -c [socket]\n", argv[0], argv[0]);
+            return 1;
+        }
+    }
+    if (nthreads < 1) nthreads = 1;
+    if (sched.slice < 1) sched.slice = 1;
+
+    signal(SIGPIPE, SIG_IGN);
+    return client ? run_client(path) : run_server(path, nthreads);
+}
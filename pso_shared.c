@@ -0,0 +1,149 @@
+/* Melhor solução compartilhada entre solvers concorrentes (lock-free)
+*/
+
+#include <stdlib.h>     // malloc(), free()
+#include <stdint.h>     // uint64_t, uint32_t
+#include <string.h>     // memcpy()
+#include <float.h>      // DBL_MAX
+#include <stdatomic.h>  // _Atomic, atomic_*()
+#include <sched.h>      // sched_yield()
+
+#include "pso_shared.h"
+
+
+struct pso_shared_best {
+    // Melhor erro reivindicado (bits do double), disputado por CAS
+    _Atomic uint64_t error;
+
+    // Seqlock do vetor publicado: ímpar = escrita em andamento
+    _Atomic uint32_t seq;
+
+    int dim;
+
+    // Erro do vetor publicado (pode ficar um instante atrás de "error"
+    // enquanto o vencedor ainda está copiando o vetor)
+    _Atomic uint64_t pos_error;
+
+    // Vetor publicado (bits de cada coordenada; acessos atômicos relaxados
+    // evitam corrida de dados formal na cópia sob seqlock)
+    _Atomic uint64_t *pos;
+};
+
+
+// Conversões double <-> bits
+static inline uint64_t dbl_bits(double x) {
+    uint64_t u;
+    memcpy(&u, &x, sizeof(u));
+    return u;
+}
+
+static inline double bits_dbl(uint64_t u) {
+    double x;
+    memcpy(&x, &u, sizeof(x));
+    return x;
+}
+
+// Espera ativa curta; cede a CPU se a espera se prolongar
+// (ex.: escritor preemptado com mais threads que núcleos)
+static inline void spin_wait(int *spins) {
+    if (++(*spins) < 64) {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+    } else {
+        *spins = 0;
+        sched_yield();
+    }
+}
+
+
+pso_shared_best_t *pso_shared_best_new(int dim) {
+    pso_shared_best_t *best = (pso_shared_best_t *)malloc(sizeof(pso_shared_best_t));
+    if (best == NULL) return NULL;
+
+    best->pos = (_Atomic uint64_t *)malloc(dim * sizeof(_Atomic uint64_t));
+    if (best->pos == NULL) { free(best); return NULL; }
+
+    best->dim = dim;
+    atomic_init(&best->error, dbl_bits(DBL_MAX));
+    atomic_init(&best->pos_error, dbl_bits(DBL_MAX));
+    atomic_init(&best->seq, 0);
+    for (int d=0; d<dim; d++)
+        atomic_init(&best->pos[d], dbl_bits(0.0));
+
+    return best;
+}
+
+void pso_shared_best_free(pso_shared_best_t *best) {
+    free(best->pos);
+    free(best);
+}
+
+double pso_shared_best_error(pso_shared_best_t *best) {
+    return bits_dbl(atomic_load_explicit(&best->error, memory_order_acquire));
+}
+
+int pso_shared_best_offer(pso_shared_best_t *best, double error,
+                          const double *pos)
+{
+    const uint64_t want = dbl_bits(error);
+    uint64_t cur = atomic_load_explicit(&best->error, memory_order_acquire);
+    uint32_t s;
+    int spins = 0;
+
+    // 1) disputa o erro por CAS (o caso comum sai aqui sem escrever nada)
+    do {
+        if (!(error < bits_dbl(cur)))
+            return 0;
+    } while (!atomic_compare_exchange_weak_explicit(&best->error, &cur, want,
+                                                    memory_order_acq_rel,
+                                                    memory_order_acquire));
+
+    // 2) vencedor: publica o vetor sob o seqlock (escritores se revezam)
+    for (;;) {
+        s = atomic_load_explicit(&best->seq, memory_order_relaxed);
+        if (!(s & 1) &&
+            atomic_compare_exchange_weak_explicit(&best->seq, &s, s + 1,
+                                                  memory_order_acquire,
+                                                  memory_order_relaxed))
+            break;
+        spin_wait(&spins);
+    }
+    atomic_thread_fence(memory_order_release);
+
+    // se outro solver reivindicou um erro ainda menor enquanto
+    // esperávamos, o vetor dele é que deve ficar: não sobrescreve
+    if (atomic_load_explicit(&best->error, memory_order_relaxed) == want) {
+        for (int d=0; d<best->dim; d++)
+            atomic_store_explicit(&best->pos[d], dbl_bits(pos[d]),
+                                  memory_order_relaxed);
+        atomic_store_explicit(&best->pos_error, want, memory_order_relaxed);
+    }
+
+    atomic_store_explicit(&best->seq, s + 2, memory_order_release);
+    return 1;
+}
+
+double pso_shared_best_snapshot(pso_shared_best_t *best, double *pos) {
+    uint32_t s1, s2;
+    uint64_t e;
+    int spins = 0;
+
+    for (;;) {
+        s1 = atomic_load_explicit(&best->seq, memory_order_acquire);
+        if (s1 & 1) {
+            spin_wait(&spins);
+            continue;
+        }
+
+        for (int d=0; d<best->dim; d++)
+            pos[d] = bits_dbl(atomic_load_explicit(&best->pos[d],
+                                                   memory_order_relaxed));
+        e = atomic_load_explicit(&best->pos_error, memory_order_relaxed);
+
+        atomic_thread_fence(memory_order_acquire);
+        s2 = atomic_load_explicit(&best->seq, memory_order_relaxed);
+        if (s1 == s2)
+            return bits_dbl(e);
+    }
+}
@@ -0,0 +1,39 @@
+/* Melhor solução compartilhada entre solvers concorrentes (lock-free)
+
+   Vários pso_solve rodando em threads diferentes podem publicar e ler um
+   mesmo "melhor até agora":
+   - o erro é disputado com compare-and-swap atômico (quem tem o menor
+     vence, sem trava);
+   - o vetor posição é protegido por um seqlock: leitores nunca bloqueiam
+     escritores e apenas repetem a cópia se ela foi feita durante uma
+     escrita.
+*/
+
+#ifndef PSO_SHARED_H_
+#define PSO_SHARED_H_
+
+#include "pso.h"
+
+// Estrutura opaca (ver pso_shared.c)
+typedef struct pso_shared_best pso_shared_best_t;
+
+// Cria a célula para vetores de dim elementos (erro inicial = DBL_MAX)
+pso_shared_best_t *pso_shared_best_new(int dim);
+
+// Libera a célula (nenhuma thread pode estar usando)
+void pso_shared_best_free(pso_shared_best_t *best);
+
+// Leitura rápida do melhor erro (uma carga atômica, sem seqlock)
+double pso_shared_best_error(pso_shared_best_t *best);
+
+// Oferece (error, pos). Publica somente se error for menor que o atual.
+// Retorna 1 se publicou, 0 caso contrário.
+// O caso comum (não melhora) custa uma única carga atômica.
+int pso_shared_best_offer(pso_shared_best_t *best, double error,
+                          const double *pos);
+
+// Copia de forma consistente o vetor publicado para pos (dim elementos)
+// e retorna o erro correspondente a ele.
+double pso_shared_best_snapshot(pso_shared_best_t *best, double *pos);
+
+#endif // PSO_SHARED_H_
@@ -0,0 +1,208 @@
+/* PSO de baixa latência para problemas pequenos
+   (todo o estado na pilha, sem malloc e sem stdio).
+*/
+
+#include <stdint.h>   // uint64_t, uint32_t, uintptr_t
+#include <time.h>     // time(), clock()
+#include <math.h>     // fmod()
+#include <float.h>    // DBL_MAX
+#include <string.h>   // memcpy(), memset()
+
+#include "pso_small.h"
+
+
+// Gerador xorshift64* (estado em registrador, sem estado global)
+
+// gera um double no intervalo [0, 1)
+static inline double small_uniform(uint64_t *s) {
+    uint64_t x = *s;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *s = x;
+    return (double)((x * 0x2545F4914F6CDD1DULL) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// gera um inteiro no intervalo [0, n)
+static inline int small_uniform_int(uint64_t *s, int n) {
+    return (int)(small_uniform(s) * n);
+}
+
+// semente: settings->seed ou, se 0, relógio + endereço da pilha
+static uint64_t small_seed(unsigned int seed) {
+    uint64_t z = seed;
+    if (z == 0) {
+        z = (uint64_t)time(NULL) ^ ((uint64_t)clock() << 32)
+            ^ (uint64_t)(uintptr_t)&z;
+    }
+    // splitmix64: espalha a semente por todos os bits
+    z += 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    return z ? z : 0x9E3779B97F4A7C15ULL;
+}
+
+
+// Vizinhança como máscara de bits: bit i de inf[j] = "i informa j"
+// (mesma semântica da matriz comm de pso.c, cabe em 32 bits)
+
+static void small_comm_ring(uint32_t *inf, int size) {
+    for (int j=0; j<size; j++) {
+        int l = (j + size - 1) % size;
+        int r = (j + 1) % size;
+        inf[j] = (1u << j) | (1u << l) | (1u << r);
+    }
+}
+
+static void small_comm_random(uint32_t *inf, int size, int nhood_size,
+                              uint64_t *rng) {
+    for (int j=0; j<size; j++)
+        inf[j] = 1u << j;
+    for (int i=0; i<size; i++)
+        for (int k=0; k<nhood_size; k++)
+            inf[small_uniform_int(rng, size)] |= 1u << i;
+}
+
+
+//          ALGORITMO PRINCIPAL (PROBLEMAS PEQUENOS)
+
+int pso_solve_small(pso_obj_fun_t obj_fun, void *obj_fun_params,
+                    pso_result_t *solution, const pso_settings_t *settings)
+{
+    const int dim = settings->dim;
+    const int size = settings->size;
+
+    if (dim < 1 || dim > PSO_SMALL_MAX_DIM ||
+        size < 1 || size > PSO_SMALL_MAX_SIZE)
+        return -1;
+
+    // Estado do enxame (pilha)
+    double pos[PSO_SMALL_MAX_SIZE][PSO_SMALL_MAX_DIM];
+    double vel[PSO_SMALL_MAX_SIZE][PSO_SMALL_MAX_DIM];
+    double pos_b[PSO_SMALL_MAX_SIZE][PSO_SMALL_MAX_DIM];
+    double pos_nb[PSO_SMALL_MAX_SIZE][PSO_SMALL_MAX_DIM];
+    double fit_b[PSO_SMALL_MAX_SIZE];
+    uint32_t inf[PSO_SMALL_MAX_SIZE];
+
+    const double *lo = settings->range_lo;
+    const double *hi = settings->range_hi;
+    const int topo = settings->nhood_strategy;
+    const int lin_dec = (settings->w_strategy == PSO_W_LIN_DEC);
+    const int dec_stage = 3 * settings->steps / 4;
+
+    uint64_t rng = small_seed(settings->seed);
+    double w = PSO_INERTIA;
+    double fit;
+    int improved = 0;
+    int g = 0;
+    int i, d, step;
+
+    if (topo == PSO_NHOOD_RING)
+        small_comm_ring(inf, size);
+    else if (topo == PSO_NHOOD_RANDOM)
+        small_comm_random(inf, size, settings->nhood_size, &rng);
+
+    solution->error = DBL_MAX;
+    solution->evals = 0;
+    solution->evals_aborted = 0;
+    memset(solution->evals_level, 0, sizeof(solution->evals_level));
+    solution->cost = 0.0;
+
+
+    // Inicialização do enxame
+
+    for (i=0; i<size; i++) {
+        for (d=0; d<dim; d++) {
+            double a = lo[d] + (hi[d] - lo[d]) * small_uniform(&rng);
+            double b = lo[d] + (hi[d] - lo[d]) * small_uniform(&rng);
+            pos[i][d] = a;
+            pos_b[i][d] = a;
+            vel[i][d] = (a-b) / 2.0;
+        }
+        fit_b[i] = obj_fun(pos[i], dim, obj_fun_params);
+        if (fit_b[i] < solution->error) {
+            solution->error = fit_b[i];
+            g = i;
+        }
+    }
+    solution->evals = size;
+
+
+    // Loop principal
+
+    for (step=0; step<settings->steps; step++) {
+        if (lin_dec) {
+            w = (step <= dec_stage && dec_stage > 0)
+                ? settings->w_min + (settings->w_max - settings->w_min) *
+                  (dec_stage - step) / dec_stage
+                : settings->w_min;
+        }
+
+        if (solution->error <= settings->goal)
+            break;
+
+        // melhor informante de cada partícula (GLOBAL usa pos_b[g] direto)
+        if (topo == PSO_NHOOD_RING || topo == PSO_NHOOD_RANDOM) {
+            if (topo == PSO_NHOOD_RANDOM && !improved)
+                small_comm_random(inf, size, settings->nhood_size, &rng);
+            for (int j=0; j<size; j++) {
+                int b_n = j;
+                for (uint32_t m = inf[j]; m; m &= m - 1) {
+                    int k = __builtin_ctz(m);
+                    if (fit_b[k] < fit_b[b_n]) b_n = k;
+                }
+                memcpy(pos_nb[j], pos_b[b_n], sizeof(double) * dim);
+            }
+        } else {
+            for (int j=0; j<size; j++)
+                memcpy(pos_nb[j], pos_b[g], sizeof(double) * dim);
+        }
+        improved = 0;
+
+        for (i=0; i<size; i++) {
+            for (d=0; d<dim; d++) {
+                double rho1 = settings->c1 * small_uniform(&rng);
+                double rho2 = settings->c2 * small_uniform(&rng);
+                vel[i][d] = w * vel[i][d]
+                    + rho1 * (pos_b[i][d] - pos[i][d])
+                    + rho2 * (pos_nb[i][d] - pos[i][d]);
+                pos[i][d] += vel[i][d];
+
+                if (settings->clamp_pos) {
+                    if (pos[i][d] < lo[d]) {
+                        pos[i][d] = lo[d];
+                        vel[i][d] = 0;
+                    } else if (pos[i][d] > hi[d]) {
+                        pos[i][d] = hi[d];
+                        vel[i][d] = 0;
+                    }
+                } else {
+                    if (pos[i][d] < lo[d]) {
+                        pos[i][d] = hi[d] - fmod(lo[d] - pos[i][d], hi[d] - lo[d]);
+                        vel[i][d] = 0;
+                    } else if (pos[i][d] > hi[d]) {
+                        pos[i][d] = lo[d] + fmod(pos[i][d] - hi[d], hi[d] - lo[d]);
+                        vel[i][d] = 0;
+                    }
+                }
+            }
+
+            fit = obj_fun(pos[i], dim, obj_fun_params);
+
+            if (fit < fit_b[i]) {
+                fit_b[i] = fit;
+                memcpy(pos_b[i], pos[i], sizeof(double) * dim);
+                if (fit < solution->error) {
+                    improved = 1;
+                    solution->error = fit;
+                    g = i;
+                }
+            }
+        }
+        solution->evals += size;
+    }
+
+    memcpy(solution->gbest, pos_b[g], sizeof(double) * dim);
+    return 0;
+}
@@ -0,0 +1,25 @@
+/* PSO de baixa latência para problemas pequenos
+   (todo o estado na pilha, sem malloc e sem stdio).
+*/
+
+#ifndef PSO_SMALL_H_
+#define PSO_SMALL_H_
+
+#include "pso.h"
+
+// Limites do caminho rápido: o estado inteiro fica em arrays fixos
+// na pilha (~10 KB com os valores abaixo)
+#define PSO_SMALL_MAX_DIM  8
+#define PSO_SMALL_MAX_SIZE 32
+
+// Executa o PSO como pso_solve(), mas:
+// - sem alocação no heap e sem stdio (print_every é ignorado)
+// - sem srand()/rand(): gerador próprio (xorshift64*) semeado por
+//   settings->seed (0 = relógio)
+// - vizinhança/inércia resolvidas inline (sem ponteiros de função)
+// Retorna 0 em caso de sucesso ou -1 se dim > PSO_SMALL_MAX_DIM ou
+// size > PSO_SMALL_MAX_SIZE (nesse caso use pso_solve()).
+int pso_solve_small(pso_obj_fun_t obj_fun, void *obj_fun_params,
+                    pso_result_t *solution, const pso_settings_t *settings);
+
+#endif // PSO_SMALL_H_
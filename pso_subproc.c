@@ -0,0 +1,405 @@
+/* Função objetivo em programa externo (processos filhos persistentes)
+*/
+
+#define _GNU_SOURCE   // pipe2(), O_CLOEXEC
+
+#include <stdio.h>      // snprintf()
+#include <stdlib.h>     // malloc(), free(), strtod()
+#include <string.h>
+#include <time.h>       // clock_gettime()
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "pso_subproc.h"
+#include "pso_wire.h"
+
+
+// Processo filho e as avaliações em voo nele (fila circular, em ordem)
+typedef struct {
+    pid_t pid;              // -1 = morto (não foi possível recriar)
+    int in_fd;              // stdin do filho (escrita)
+    int out_fd;             // stdout do filho (leitura, não bloqueante)
+
+    char *rbuf;             // bytes recebidos ainda não processados
+    size_t rlen, rcap;
+
+    int *fifo;              // índices das posições em voo
+    int head, count;
+    double progress_at;     // ns: última resposta (ou envio com fila vazia)
+    long answered;          // respostas desde que foi criado
+} child_t;
+
+struct pso_subproc {
+    pthread_mutex_t lock;   // uma chamada de pso_subproc_batch por vez
+    char *cmd;
+    int format;
+    int dim;
+    int nchildren;
+    int inflight;
+    int timeout_ms;
+    child_t *c;
+
+    // buffers reaproveitados entre chamadas
+    char *wbuf;
+    size_t wcap;
+    int *queue, *attempts;
+    int cap;
+
+    pso_subproc_stats_t stats;
+};
+
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Escrita em pipe sem SIGPIPE se o filho morreu (o erro vira EPIPE)
+static int write_pipe(int fd, const void *buf, size_t len) {
+    sigset_t pipe_set, old;
+    int rc;
+
+    sigemptyset(&pipe_set);
+    sigaddset(&pipe_set, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &pipe_set, &old);
+    rc = pso_wire_write_all(fd, buf, len);
+    if (rc != 0 && errno == EPIPE) {
+        // descarta o SIGPIPE pendente antes de desbloquear
+        struct timespec zero = { 0, 0 };
+        sigtimedwait(&pipe_set, NULL, &zero);
+    }
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    return rc;
+}
+
+static int child_spawn(pso_subproc_t *sp, child_t *ch) {
+    int to_child[2], from_child[2];
+
+    if (pipe2(to_child, O_CLOEXEC) != 0) return -1;
+    if (pipe2(from_child, O_CLOEXEC) != 0) {
+        close(to_child[0]); close(to_child[1]);
+        return -1;
+    }
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(to_child[0]); close(to_child[1]);
+        close(from_child[0]); close(from_child[1]);
+        return -1;
+    }
+    if (pid == 0) {
+        // filho: grupo próprio (o SIGKILL alcança os netos do sh -c);
+        // pipes viram stdin/stdout (dup2 limpa o O_CLOEXEC)
+        setpgid(0, 0);
+        dup2(to_child[0], STDIN_FILENO);
+        dup2(from_child[1], STDOUT_FILENO);
+        execl("/bin/sh", "sh", "-c", sp->cmd, (char *)NULL);
+        _exit(127);
+    }
+
+    close(to_child[0]);
+    close(from_child[1]);
+    fcntl(from_child[0], F_SETFL, fcntl(from_child[0], F_GETFL) | O_NONBLOCK);
+
+    ch->pid = pid;
+    ch->in_fd = to_child[1];
+    ch->out_fd = from_child[0];
+    ch->rlen = 0;
+    ch->head = ch->count = 0;
+    ch->answered = 0;
+    ch->progress_at = now_ns();
+    return 0;
+}
+
+static void child_stop(child_t *ch) {
+    if (ch->pid <= 0) return;
+    close(ch->in_fd);
+    close(ch->out_fd);
+    kill(-ch->pid, SIGKILL);
+    kill(ch->pid, SIGKILL);      // caso ainda não tenha chamado setpgid
+    waitpid(ch->pid, NULL, 0);
+    ch->pid = -1;
+}
+
+// Mata e recria o filho. As avaliações em voo voltam para a fila; a
+// primeira (a que estava rodando) conta uma tentativa e, esgotadas as
+// tentativas, recebe HUGE_VAL. Depois de um timeout o filho é sempre
+// recriado (as tentativas limitam o custo; a primeira avaliação pode só
+// ser lenta). Um filho que sai sozinho sem ter respondido nada (comando
+// inválido) só é recriado na próxima chamada, para não entrar num ciclo
+// de fork. Retorna quantas posições foram desistidas.
+static int child_restart(pso_subproc_t *sp, child_t *ch, int *nqueue, double *fit,
+                         int timed_out)
+{
+    int given_up = 0;
+
+    for (int k=0; k<ch->count; k++) {
+        int idx = ch->fifo[(ch->head + k) % sp->inflight];
+        if (k == 0 && ++sp->attempts[idx] >= PSO_SUBPROC_ATTEMPTS) {
+            fit[idx] = HUGE_VAL;
+            sp->stats.failed++;
+            given_up++;
+            continue;
+        }
+        sp->queue[(*nqueue)++] = idx;
+    }
+    ch->count = 0;
+
+    long answered = ch->answered;
+    child_stop(ch);
+    if ((timed_out || answered > 0) && child_spawn(sp, ch) == 0)
+        sp->stats.restarts++;
+    return given_up;
+}
+
+// Codifica a posição no formato do filho (em sp->wbuf); retorna o tamanho
+static size_t encode(pso_subproc_t *sp, const double *x) {
+    size_t need = sp->format == PSO_SUBPROC_WIRE
+                ? PSO_WIRE_HDR + 8 * (size_t)sp->dim
+                : 26 * (size_t)sp->dim + 2;
+    if (need > sp->wcap) {
+        free(sp->wbuf);
+        sp->wbuf = (char *)malloc(need);
+        sp->wcap = need;
+    }
+
+    if (sp->format == PSO_SUBPROC_WIRE) {
+        unsigned char *p = (unsigned char *)sp->wbuf;
+        pso_wire_put_hdr(p, PSO_MSG_EVAL, 0, 1, (uint32_t)sp->dim);
+        for (int d=0; d<sp->dim; d++)
+            pso_wire_put_f64(p + PSO_WIRE_HDR + 8 * d, x[d]);
+        return need;
+    }
+
+    size_t len = 0;
+    for (int d=0; d<sp->dim; d++)
+        len += snprintf(sp->wbuf + len, sp->wcap - len, d ? " %.17g" : "%.17g", x[d]);
+    sp->wbuf[len++] = '\n';
+    return len;
+}
+
+// Tira do buffer de leitura a próxima resposta completa.
+// Retorna 1 (fitness em *f), 0 (incompleta) ou -1 (lixo no protocolo).
+static int decode(pso_subproc_t *sp, child_t *ch, double *f) {
+    size_t used;
+
+    if (sp->format == PSO_SUBPROC_WIRE) {
+        pso_wire_hdr_t h;
+        if (ch->rlen < PSO_WIRE_HDR) return 0;
+        if (pso_wire_get_hdr((unsigned char *)ch->rbuf, &h) != 0 ||
+            h.type != PSO_MSG_RESULT || h.n != 1)
+            return -1;
+        used = PSO_WIRE_HDR + 8;
+        if (ch->rlen < used) return 0;
+        *f = pso_wire_get_f64((unsigned char *)ch->rbuf + PSO_WIRE_HDR);
+    } else {
+        char *nl = (char *)memchr(ch->rbuf, '\n', ch->rlen);
+        char *end;
+        if (nl == NULL) return 0;
+        *nl = '\0';
+        *f = strtod(ch->rbuf, &end);
+        if (end == ch->rbuf) return -1;
+        used = (size_t)(nl - ch->rbuf) + 1;
+    }
+    ch->rlen -= used;
+    memmove(ch->rbuf, ch->rbuf + used, ch->rlen);
+    return 1;
+}
+
+// Lê o que houver no pipe. Retorna -1 se o filho fechou a saída.
+static int child_read(child_t *ch) {
+    for (;;) {
+        if (ch->rcap - ch->rlen < 4096) {
+            ch->rcap = ch->rcap ? 2 * ch->rcap : 8192;
+            ch->rbuf = (char *)realloc(ch->rbuf, ch->rcap);
+        }
+        ssize_t k = read(ch->out_fd, ch->rbuf + ch->rlen, ch->rcap - ch->rlen);
+        if (k > 0) { ch->rlen += (size_t)k; continue; }
+        if (k < 0 && errno == EINTR) continue;
+        if (k < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return 0;
+        return -1;
+    }
+}
+
+
+// ============================
+//         API PÚBLICA
+// ============================
+
+pso_subproc_t *pso_subproc_new(const char *cmd, int nchildren, int format,
+                               int dim, char *err, int errlen)
+{
+    if (nchildren < 1) nchildren = 1;
+
+    pso_subproc_t *sp = (pso_subproc_t *)calloc(1, sizeof(pso_subproc_t));
+    if (sp == NULL) return NULL;
+    sp->cmd = strdup(cmd);
+    sp->format = format;
+    sp->dim = dim;
+    sp->nchildren = nchildren;
+    sp->inflight = 4;
+    sp->timeout_ms = 10000;
+    pthread_mutex_init(&sp->lock, NULL);
+
+    sp->c = (child_t *)calloc(nchildren, sizeof(child_t));
+    for (int k=0; k<nchildren; k++) {
+        sp->c[k].fifo = (int *)malloc(sp->inflight * sizeof(int));
+        if (child_spawn(sp, &sp->c[k]) != 0) {
+            if (err != NULL && errlen > 0)
+                snprintf(err, errlen, "falha ao criar processo: %s", strerror(errno));
+            pso_subproc_free(sp);
+            return NULL;
+        }
+    }
+    return sp;
+}
+
+void pso_subproc_config(pso_subproc_t *sp, int inflight, int timeout_ms) {
+    pthread_mutex_lock(&sp->lock);
+    if (inflight > 0 && inflight != sp->inflight) {
+        // só entre chamadas: nenhuma avaliação em voo
+        for (int k=0; k<sp->nchildren; k++) {
+            free(sp->c[k].fifo);
+            sp->c[k].fifo = (int *)malloc(inflight * sizeof(int));
+        }
+        sp->inflight = inflight;
+    }
+    if (timeout_ms > 0) sp->timeout_ms = timeout_ms;
+    pthread_mutex_unlock(&sp->lock);
+}
+
+void pso_subproc_free(pso_subproc_t *sp) {
+    for (int k=0; k<sp->nchildren; k++) {
+        child_t *ch = &sp->c[k];
+        child_stop(ch);
+        free(ch->fifo);
+        free(ch->rbuf);
+    }
+    pthread_mutex_destroy(&sp->lock);
+    free(sp->c);
+    free(sp->cmd);
+    free(sp->wbuf);
+    free(sp->queue);
+    free(sp->attempts);
+    free(sp);
+}
+
+void pso_subproc_stats(pso_subproc_t *sp, pso_subproc_stats_t *stats) {
+    pthread_mutex_lock(&sp->lock);
+    *stats = sp->stats;
+    pthread_mutex_unlock(&sp->lock);
+}
+
+void pso_subproc_batch(double **x, int dim, int n, double *fit, void *params) {
+    pso_subproc_t *sp = (pso_subproc_t *)params;
+    struct pollfd *pfd;
+    int *pidx;
+    int k, nqueue = 0, remaining = n;
+    (void)dim;
+
+    if (n <= 0) return;
+    pthread_mutex_lock(&sp->lock);
+
+    if (n > sp->cap) {
+        free(sp->queue); free(sp->attempts);
+        sp->queue = (int *)malloc(n * sizeof(int));
+        sp->attempts = (int *)malloc(n * sizeof(int));
+        sp->cap = n;
+    }
+    for (int i=n-1; i>=0; i--) {     // pilha: posição 0 sai primeiro
+        sp->queue[nqueue++] = i;
+        sp->attempts[i] = 0;
+    }
+
+    // filhos que morreram entre chamadas
+    for (k=0; k<sp->nchildren; k++)
+        if (sp->c[k].pid < 0 && child_spawn(sp, &sp->c[k]) == 0)
+            sp->stats.restarts++;
+
+    pfd = (struct pollfd *)malloc(sp->nchildren * sizeof(struct pollfd));
+    pidx = (int *)malloc(sp->nchildren * sizeof(int));
+
+    while (remaining > 0) {
+        int alive = 0;
+
+        // envia enquanto houver espaço no pipeline de cada filho
+        for (k=0; k<sp->nchildren; k++) {
+            child_t *ch = &sp->c[k];
+            while (ch->pid > 0 && ch->count < sp->inflight && nqueue > 0) {
+                int idx = sp->queue[--nqueue];
+                size_t len = encode(sp, x[idx]);
+                if (ch->count == 0) ch->progress_at = now_ns();
+                ch->fifo[(ch->head + ch->count) % sp->inflight] = idx;
+                ch->count++;
+                if (write_pipe(ch->in_fd, sp->wbuf, len) != 0)
+                    remaining -= child_restart(sp, ch, &nqueue, fit, 0);
+            }
+            if (ch->pid > 0) alive++;
+        }
+
+        // nenhum filho: o que falta fica sem avaliação
+        if (alive == 0) {
+            while (nqueue > 0) {
+                fit[sp->queue[--nqueue]] = HUGE_VAL;
+                sp->stats.failed++;
+            }
+            break;
+        }
+
+        // espera respostas até o prazo mais próximo
+        double now = now_ns(), wait_ms = sp->timeout_ms;
+        int np = 0;
+        for (k=0; k<sp->nchildren; k++) {
+            child_t *ch = &sp->c[k];
+            if (ch->pid <= 0 || ch->count == 0) continue;
+            double left = sp->timeout_ms - (now - ch->progress_at) / 1e6;
+            if (left < wait_ms) wait_ms = left;
+            pfd[np].fd = ch->out_fd;
+            pfd[np].events = POLLIN;
+            pfd[np].revents = 0;
+            pidx[np++] = k;
+        }
+        if (np == 0) continue;
+        poll(pfd, np, wait_ms > 0 ? (int)wait_ms + 1 : 0);
+        now = now_ns();
+
+        for (int p=0; p<np; p++) {
+            child_t *ch = &sp->c[pidx[p]];
+            double f;
+            int rc;
+
+            if (pfd[p].revents != 0) {
+                int closed = child_read(ch) != 0;
+                while ((rc = decode(sp, ch, &f)) == 1 && ch->count > 0) {
+                    fit[ch->fifo[ch->head]] = f;
+                    ch->head = (ch->head + 1) % sp->inflight;
+                    ch->count--;
+                    ch->progress_at = now;
+                    ch->answered++;
+                    remaining--;
+                    sp->stats.evals++;
+                }
+                if (closed || rc < 0 || (rc == 1 && ch->count == 0)) {
+                    // saiu, respondeu lixo ou respondeu demais
+                    remaining -= child_restart(sp, ch, &nqueue, fit, 0);
+                    continue;
+                }
+            }
+            if (ch->count > 0 && (now - ch->progress_at) / 1e6 > sp->timeout_ms) {
+                sp->stats.timeouts++;
+                remaining -= child_restart(sp, ch, &nqueue, fit, 1);
+            }
+        }
+    }
+
+    free(pfd);
+    free(pidx);
+    pthread_mutex_unlock(&sp->lock);
+}
@@ -0,0 +1,67 @@
+/* Função objetivo em programa externo (processos filhos persistentes)
+
+   Mantém N processos filhos vivos durante toda a otimização e conversa
+   com eles por pipes (stdin/stdout), em vez de criar um processo por
+   avaliação. Cada filho recebe várias avaliações seguidas sem esperar as
+   respostas (pipeline) e responde na mesma ordem.
+
+   Formatos:
+   - PSO_SUBPROC_LINE: uma posição por linha ("x1 x2 ... xd\n", %.17g);
+     o filho responde uma linha com o fitness. Serve para qualquer
+     script (não esqueça de dar flush a cada linha).
+   - PSO_SUBPROC_WIRE: mensagens EVAL/RESULT de pso_wire.h (n = 1), sem
+     HELLO. Ex.: "pso_worker --stdio fun:rastrigin".
+
+   Uma avaliação que passa do timeout mata o filho (SIGKILL), que é
+   recriado; as avaliações pendentes dele voltam para a fila. Uma posição
+   que estoura o timeout PSO_SUBPROC_ATTEMPTS vezes recebe HUGE_VAL. Um
+   filho que sai sem ter respondido nada (comando inválido) só é recriado
+   na chamada seguinte; as posições que sobrarem recebem HUGE_VAL.
+
+     pso_subproc_t *sp = pso_subproc_new("./meu_modelo", 4,
+                                         PSO_SUBPROC_LINE, dim, err, sizeof(err));
+     pso_solve_batch(pso_subproc_batch, sp, &result, settings);
+*/
+
+#ifndef PSO_SUBPROC_H_
+#define PSO_SUBPROC_H_
+
+#include "pso.h"
+
+#define PSO_SUBPROC_LINE 0
+#define PSO_SUBPROC_WIRE 1
+
+// Tentativas (timeouts/quedas) antes de desistir de uma posição
+#define PSO_SUBPROC_ATTEMPTS 2
+
+// Estrutura opaca (ver pso_subproc.c)
+typedef struct pso_subproc pso_subproc_t;
+
+typedef struct {
+    long evals;       // avaliações respondidas
+    long timeouts;    // avaliações que estouraram o timeout
+    long restarts;    // filhos recriados (timeout ou saída inesperada)
+    long failed;      // posições desistidas (fitness = HUGE_VAL)
+} pso_subproc_stats_t;
+
+
+// Cria nchildren filhos executando cmd (via /bin/sh -c).
+// Retorna NULL (e o motivo em err) se não conseguir criar os processos.
+pso_subproc_t *pso_subproc_new(const char *cmd, int nchildren, int format,
+                               int dim, char *err, int errlen);
+
+// Ajustes (valores <= 0 mantêm o atual):
+// inflight    avaliações em voo por filho (padrão 4)
+// timeout_ms  limite de cada avaliação (padrão 10000)
+void pso_subproc_config(pso_subproc_t *sp, int inflight, int timeout_ms);
+
+// Fecha os pipes, encerra e espera os filhos
+void pso_subproc_free(pso_subproc_t *sp);
+
+// Função objetivo em lote para pso_solve_batch (params = sp)
+void pso_subproc_batch(double **x, int dim, int n, double *fit, void *sp);
+
+// Copia os contadores atuais
+void pso_subproc_stats(pso_subproc_t *sp, pso_subproc_stats_t *stats);
+
+#endif // PSO_SUBPROC_H_
@@ -0,0 +1,129 @@
+/* Monitor de uma execução do PSO (página de métricas de pso_metrics.h)
+
+   Mapeia só para leitura o segmento publicado pelo solver
+   (settings->metrics) e mostra passo, avaliações, melhor erro, inércia,
+   diversidade e o estado das threads do pool. Não interfere no solver:
+   só lê a memória compartilhada (seqlock, sem trava).
+
+   uso: pso_top [-i ms] [--once] NOME
+
+   -i ms   intervalo entre atualizações (padrão 500)
+   --once  mostra uma vez e sai (para scripts)
+
+   Sai quando o solver termina ou o processo dele desaparece.
+*/
+
+#define _GNU_SOURCE   // shm_open(), kill()
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <signal.h>     // kill()
+#include <fcntl.h>      // O_RDONLY
+#include <unistd.h>     // isatty(), close()
+#include <sys/mman.h>   // shm_open(), mmap()
+
+#include "pso_metrics.h"
+#include "pso_pool.h"
+
+
+static void sleep_ms(int ms) {
+    struct timespec ts = { ms / 1000, (ms % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+}
+
+// rate: avaliações/s desde a última tela (< 0 = ainda não há)
+static void show(const char *name, const pso_metrics_snapshot_t *m,
+                 double rate, int clear)
+{
+    static const char state_char[] = { 'I', 'R', 'S' };
+
+    if (clear) printf("\033[H\033[J");
+    printf("%s  pid %d  %s\n", name, m->pid, m->done ? "terminou" : "rodando");
+    printf("passo       %ld / %ld (%.1f%%)   tempo %.1f s\n", m->step, m->steps,
+           m->steps > 0 ? 100.0 * m->step / m->steps : 0.0, m->elapsed);
+    printf("avaliações  %ld   %.0f/s média", m->evals, m->evals_per_s);
+    if (rate >= 0) printf(", %.0f/s agora", rate);
+    printf("\n");
+    printf("melhor erro %.6e   w %.3f   diversidade %.4g\n", m->best, m->w, m->diversity);
+    printf("enxame      %d partículas, dim %d\n", m->size, m->dim);
+    if (m->nthreads > 0) {
+        int n = m->nthreads < PSO_METRICS_MAX_THREADS ? m->nthreads : PSO_METRICS_MAX_THREADS;
+        printf("threads     ");
+        for (int k=0; k<n; k++)
+            printf("%c", m->thread_state[k] <= PSO_POOL_SLEEP ? state_char[m->thread_state[k]] : '?');
+        printf("   (R = tarefa, I = procurando/esperando, S = dormindo)\n");
+    } else {
+        printf("threads     serial\n");
+    }
+    fflush(stdout);
+}
+
+int main(int argc, char **argv) {
+    const char *arg = NULL;
+    char name[256];
+    int interval = 500, once = 0;
+
+    for (int k=1; k<argc; k++) {
+        if (strcmp(argv[k], "-i") == 0 && k + 1 < argc) {
+            interval = atoi(argv[++k]);
+        } else if (strcmp(argv[k], "--once") == 0) {
+            once = 1;
+        } else if (argv[k][0] != '-' && arg == NULL) {
+            arg = argv[k];
+        } else {
+            arg = NULL;
+            break;
+        }
+    }
+    if (arg == NULL || interval <= 0) {
+        fprintf(stderr, "uso: %s [-i ms] [--once] NOME\n", argv[0]);
+        return 1;
+    }
+    snprintf(name, sizeof(name), "%s%s", arg[0] == '/' ? "" : "/", arg);
+
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+        fprintf(stderr, "%s: %s\n", name, strerror(errno));
+        return 1;
+    }
+    const pso_metrics_page_t *page = (const pso_metrics_page_t *)
+        mmap(NULL, sizeof(pso_metrics_page_t), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (page == MAP_FAILED) {
+        fprintf(stderr, "%s: %s\n", name, strerror(errno));
+        return 1;
+    }
+
+    int clear = !once && isatty(1);
+    long last_evals = -1;
+    double last_elapsed = 0.0;
+
+    for (;;) {
+        pso_metrics_snapshot_t m;
+        double rate = -1;
+
+        if (pso_metrics_snapshot(page, &m) != 0) {
+            fprintf(stderr, "%s: não é uma página de métricas (versão %d)\n",
+                    name, PSO_METRICS_VERSION);
+            return 1;
+        }
+        // ritmo recente pelo relógio do solver (elapsed da página)
+        if (last_evals >= 0 && m.evals >= last_evals && m.elapsed > last_elapsed)
+            rate = (m.evals - last_evals) / (m.elapsed - last_elapsed);
+        last_evals = m.evals;
+        last_elapsed = m.elapsed;
+
+        show(name, &m, rate, clear);
+        if (once || m.done) break;
+        if (m.pid > 0 && kill(m.pid, 0) != 0 && errno == ESRCH) {
+            printf("processo %d terminou sem concluir a execução\n", m.pid);
+            break;
+        }
+        sleep_ms(interval);
+    }
+    munmap((void *)page, sizeof(pso_metrics_page_t));
+    return 0;
+}
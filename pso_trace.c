@@ -0,0 +1,234 @@
+/* Linha do tempo das threads (traço no formato Chrome/Perfetto)
+*/
+
+#define _POSIX_C_SOURCE 200809L   // clock_gettime()
+
+#include <stdio.h>
+#include <stdlib.h>     // malloc(), free()
+#include <string.h>
+#include <time.h>       // clock_gettime()
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "pso_trace.h"
+
+#define KIND_SPAN    0  // início + duração ("X")
+#define KIND_INSTANT 1  // "i"
+#define KIND_ASYNC   2  // par "b"/"e" com id
+
+typedef struct {
+    uint64_t ts, dur;      // ns desde pso_trace_start
+    const char *name;
+    long arg;
+    int id;
+    int kind;
+} event_t;
+
+// Anel de uma thread (só ela escreve)
+typedef struct trace_buf {
+    struct trace_buf *next;
+    event_t *ev;
+    uint64_t count;        // eventos já escritos (o anel guarda os últimos)
+    int tid;
+    char name[32];
+} trace_buf_t;
+
+struct pso_trace {
+    int cap;
+    unsigned long id;      // distingue de traços anteriores (ver thread_buf)
+    uint64_t t0;           // início (relógio monotônico)
+    pthread_mutex_t lock;  // só no registro de anéis
+    trace_buf_t *bufs;
+    int nbufs;
+};
+
+static _Atomic(pso_trace_t *) active = NULL;
+static atomic_ulong next_id = 1;
+
+static _Thread_local trace_buf_t *tls_buf;
+static _Thread_local unsigned long tls_id;     // traço dono de tls_buf
+static _Thread_local char tls_name[32];
+
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// Anel da thread atual no traço t (criado no primeiro evento). O id evita
+// reaproveitar o anel de um traço já liberado que tinha o mesmo endereço.
+static trace_buf_t *thread_buf(pso_trace_t *t) {
+    trace_buf_t *b;
+
+    if (tls_id == t->id) return tls_buf;
+
+    b = (trace_buf_t *)calloc(1, sizeof(trace_buf_t));
+    if (b == NULL) return NULL;
+    b->ev = (event_t *)malloc(t->cap * sizeof(event_t));
+    if (b->ev == NULL) { free(b); return NULL; }
+
+    pthread_mutex_lock(&t->lock);
+    b->tid = t->nbufs++;
+    b->next = t->bufs;
+    t->bufs = b;
+    pthread_mutex_unlock(&t->lock);
+
+    if (tls_name[0]) memcpy(b->name, tls_name, sizeof(b->name));
+    else snprintf(b->name, sizeof(b->name), "thread %d", b->tid);
+
+    tls_buf = b;
+    tls_id = t->id;
+    return b;
+}
+
+static void record(int kind, const char *name, uint64_t t0, uint64_t t1,
+                   int id, long arg)
+{
+    pso_trace_t *t = atomic_load_explicit(&active, memory_order_acquire);
+    trace_buf_t *b;
+    event_t *e;
+
+    if (t == NULL || (b = thread_buf(t)) == NULL) return;
+    if (t0 < t->t0) t0 = t->t0; // começou antes de ligar
+    e = &b->ev[b->count % (uint64_t)t->cap];
+    e->ts = t0 - t->t0;
+    e->dur = t1 > t0 ? t1 - t0 : 0;
+    e->name = name;
+    e->arg = arg;
+    e->id = id;
+    e->kind = kind;
+    b->count++;
+}
+
+
+// ============================
+//         API PÚBLICA
+// ============================
+
+pso_trace_t *pso_trace_new(int capacity) {
+    pso_trace_t *t = (pso_trace_t *)calloc(1, sizeof(pso_trace_t));
+
+    if (t == NULL) return NULL;
+    t->cap = capacity > 0 ? capacity : 1;
+    t->id = atomic_fetch_add(&next_id, 1);
+    pthread_mutex_init(&t->lock, NULL);
+    return t;
+}
+
+void pso_trace_free(pso_trace_t *trace) {
+    trace_buf_t *b, *next;
+
+    if (trace == NULL) return;
+    for (b=trace->bufs; b!=NULL; b=next) {
+        next = b->next;
+        free(b->ev);
+        free(b);
+    }
+    pthread_mutex_destroy(&trace->lock);
+    free(trace);
+}
+
+void pso_trace_start(pso_trace_t *trace) {
+    trace->t0 = now_ns();
+    atomic_store_explicit(&active, trace, memory_order_release);
+}
+
+void pso_trace_stop(pso_trace_t *trace) {
+    pso_trace_t *expected = trace;
+    atomic_compare_exchange_strong(&active, &expected, NULL);
+}
+
+long pso_trace_dropped(const pso_trace_t *trace) {
+    long n = 0;
+    for (const trace_buf_t *b=trace->bufs; b!=NULL; b=b->next)
+        if (b->count > (uint64_t)trace->cap) n += (long)(b->count - trace->cap);
+    return n;
+}
+
+uint64_t pso_trace_begin(void) {
+    if (atomic_load_explicit(&active, memory_order_relaxed) == NULL) return 0;
+    return now_ns();
+}
+
+void pso_trace_end(const char *name, uint64_t t0, long arg) {
+    if (t0 == 0) return;
+    record(KIND_SPAN, name, t0, now_ns(), -1, arg);
+}
+
+void pso_trace_instant(const char *name, long arg) {
+    if (atomic_load_explicit(&active, memory_order_relaxed) == NULL) return;
+    uint64_t t = now_ns();
+    record(KIND_INSTANT, name, t, t, -1, arg);
+}
+
+void pso_trace_async(const char *name, uint64_t t0, int id, long arg) {
+    if (t0 == 0) return;
+    record(KIND_ASYNC, name, t0, now_ns(), id, arg);
+}
+
+void pso_trace_thread_name(const char *name) {
+    pso_trace_t *t = atomic_load_explicit(&active, memory_order_acquire);
+
+    snprintf(tls_name, sizeof(tls_name), "%s", name);
+    if (t != NULL && tls_id == t->id) memcpy(tls_buf->name, tls_name, sizeof(tls_name));
+}
+
+
+// ============================
+//          EXPORTAÇÃO
+// ============================
+
+// string JSON (só aspas e barras precisam de escape nos nomes usados)
+static void json_str(FILE *f, const char *s) {
+    fputc('"', f);
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') fputc('\\', f);
+        if ((unsigned char)*s >= 0x20) fputc(*s, f);
+    }
+    fputc('"', f);
+}
+
+static void write_event(FILE *f, const event_t *e, int tid) {
+    static const char *ph[] = { "X", "i", "b" };
+
+    fprintf(f, ",\n{\"name\":");
+    json_str(f, e->name);
+    fprintf(f, ",\"ph\":\"%s\",\"ts\":%.3f,\"pid\":1,\"tid\":%d",
+            ph[e->kind], e->ts / 1e3, tid);
+    if (e->kind == KIND_SPAN) fprintf(f, ",\"dur\":%.3f", e->dur / 1e3);
+    if (e->kind == KIND_INSTANT) fprintf(f, ",\"s\":\"t\"");
+    if (e->kind == KIND_ASYNC) fprintf(f, ",\"cat\":\"async\",\"id\":%d", e->id);
+    fprintf(f, ",\"args\":{\"arg\":%ld}}", e->arg);
+
+    if (e->kind == KIND_ASYNC) {
+        fprintf(f, ",\n{\"name\":");
+        json_str(f, e->name);
+        fprintf(f, ",\"ph\":\"e\",\"ts\":%.3f,\"pid\":1,\"tid\":%d,"
+                "\"cat\":\"async\",\"id\":%d}",
+                (e->ts + e->dur) / 1e3, tid, e->id);
+    }
+}
+
+int pso_trace_write(const pso_trace_t *trace, const char *path) {
+    FILE *f = fopen(path, "w");
+    if (f == NULL) return -1;
+
+    fprintf(f, "{\"displayTimeUnit\":\"ns\",\"otherData\":{\"dropped\":%ld},\n"
+            "\"traceEvents\":[\n"
+            "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"pso\"}}",
+            pso_trace_dropped(trace));
+
+    for (const trace_buf_t *b=trace->bufs; b!=NULL; b=b->next) {
+        uint64_t first = b->count > (uint64_t)trace->cap ? b->count - trace->cap : 0;
+
+        fprintf(f, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                "\"args\":{\"name\":", b->tid);
+        json_str(f, b->name);
+        fprintf(f, "}}");
+        for (uint64_t k=first; k<b->count; k++)
+            write_event(f, &b->ev[k % (uint64_t)trace->cap], b->tid);
+    }
+    fprintf(f, "\n]}\n");
+    return fclose(f) == 0 ? 0 : -1;
+}
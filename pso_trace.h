@@ -0,0 +1,79 @@
+/* Linha do tempo das threads (traço no formato Chrome/Perfetto)
+
+   Para ver ociosidade, espera nas barreiras e tarefas atrasadas numa
+   execução paralela ou assíncrona, o solver e os módulos de avaliação
+   registram eventos com início e duração:
+
+   - "step": um passo do solver (arg = passo);
+   - "inform": vizinhança e coeficientes (topologia, APSO);
+   - "eval": um bloco de partículas avaliado numa thread (arg = tamanho);
+   - "barrier": espera do solver pelo fim da avaliação no pool (os blocos
+     que a própria thread executa aparecem dentro dela);
+   - "resize": redução do enxame (matrizes e vizinhança refeitas);
+   - "gbest": instantâneo, o gbest melhorou (arg = passo);
+   - "round": uma rodada do portfólio (arg = braços ativos);
+   - "wait" / "async eval": espera no epoll e cada avaliação em voo de
+     pso_async (arg = posição no lote).
+
+   Cada thread escreve num anel próprio (thread-local, sem trava no
+   caminho quente; só o primeiro evento da thread registra o anel). Cheio,
+   o anel sobrescreve os eventos mais antigos: o arquivo guarda o fim da
+   execução e informa quantos foram perdidos. Desligado, cada ponto de
+   registro custa uma carga atômica.
+
+     pso_trace_t *t = pso_trace_new(1 << 16);   // eventos por thread
+     pso_trace_start(t);
+     pso_solve(...);
+     pso_trace_stop(t);
+     pso_trace_write(t, "traco.json");   // abrir em ui.perfetto.dev
+     pso_trace_free(t);                  //  ou chrome://tracing
+
+   Um traço ligado por vez. stop/write/free só depois que as execuções
+   terminaram (nenhuma thread registrando eventos).
+*/
+
+#ifndef PSO_TRACE_H_
+#define PSO_TRACE_H_
+
+#include <stdint.h>     // uint64_t
+
+// Estrutura opaca (ver pso_trace.c)
+typedef struct pso_trace pso_trace_t;
+
+// Cria um traço com anéis de capacity eventos por thread (NULL em falha)
+pso_trace_t *pso_trace_new(int capacity);
+
+// Libera o traço (precisa estar parado)
+void pso_trace_free(pso_trace_t *trace);
+
+// Liga o traço (o tempo conta a partir daqui) / desliga
+void pso_trace_start(pso_trace_t *trace);
+void pso_trace_stop(pso_trace_t *trace);
+
+// Grava em JSON (Chrome trace event format). Retorna 0 ou -1 em falha.
+int pso_trace_write(const pso_trace_t *trace, const char *path);
+
+// Eventos sobrescritos por anéis cheios
+long pso_trace_dropped(const pso_trace_t *trace);
+
+
+// Registro (name deve ser uma string constante: só o ponteiro é guardado)
+
+// Início de um evento: instante atual, ou 0 se não há traço ligado
+uint64_t pso_trace_begin(void);
+
+// Fim do evento iniciado em t0 (nada se t0 = 0)
+void pso_trace_end(const char *name, uint64_t t0, long arg);
+
+// Evento instantâneo
+void pso_trace_instant(const char *name, long arg);
+
+// Evento assíncrono (pode se sobrepor a outros da mesma thread): id
+// distingue os que estão em voo ao mesmo tempo
+void pso_trace_async(const char *name, uint64_t t0, int id, long arg);
+
+// Nome da thread atual no traço (padrão: "thread N", na ordem do
+// primeiro evento)
+void pso_trace_thread_name(const char *name);
+
+#endif // PSO_TRACE_H_
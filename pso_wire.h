@@ -0,0 +1,126 @@
+/* Protocolo binário de avaliação remota (solver <-> workers)
+
+   Toda mensagem começa com um cabeçalho fixo de 20 bytes, seguido de um
+   corpo opcional. Inteiros e doubles (IEEE-754) em little-endian.
+
+     u32 magic   PSO_WIRE_MAGIC
+     u32 type    PSO_MSG_*
+     u32 id      número do lote (respostas repetem o id do pedido)
+     u32 n       HELLO/ERROR: bytes do texto; EVAL/RESULT: nº de posições
+     u32 dim     dimensão (EVAL/HELLO), 0 nas demais
+
+   Corpos:
+     HELLO   texto "fun:NOME" ou "plugin:ARQ.so[:ARGS]" (objetivo a usar)
+     EVAL    n*dim doubles (posições, uma após a outra)
+     RESULT  n doubles (fitness, na ordem das posições)
+     ERROR   texto com o motivo
+     HELLO_OK, PING, PONG: sem corpo
+
+   O solver pode mandar vários EVAL sem esperar as respostas (pipeline);
+   o worker responde PING imediatamente mesmo no meio de uma avaliação.
+*/
+
+#ifndef PSO_WIRE_H_
+#define PSO_WIRE_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>   // send(), MSG_NOSIGNAL
+
+#define PSO_WIRE_MAGIC   0x31534F50u   // "PSO1"
+#define PSO_WIRE_HDR     20
+
+#define PSO_MSG_HELLO    1
+#define PSO_MSG_HELLO_OK 2
+#define PSO_MSG_EVAL     3
+#define PSO_MSG_RESULT   4
+#define PSO_MSG_PING     5
+#define PSO_MSG_PONG     6
+#define PSO_MSG_ERROR    7
+
+// Limites dos corpos: os tamanhos vêm do par, e um cabeçalho corrompido
+// ou malicioso não pode fazer o outro lado alocar gigabytes. Quem recebe
+// confere antes de alocar (e fecha a conexão se passar).
+#define PSO_WIRE_MAX_DOUBLES (1u << 24)  // EVAL n*dim, RESULT n (128 MB)
+#define PSO_WIRE_MAX_TEXT    4096        // HELLO/ERROR
+
+typedef struct {
+    uint32_t type, id, n, dim;
+} pso_wire_hdr_t;
+
+
+static inline void pso_wire_put_u32(unsigned char *p, uint32_t v) {
+    p[0] = (unsigned char)v;         p[1] = (unsigned char)(v >> 8);
+    p[2] = (unsigned char)(v >> 16); p[3] = (unsigned char)(v >> 24);
+}
+
+static inline uint32_t pso_wire_get_u32(const unsigned char *p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 |
+           (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static inline void pso_wire_put_f64(unsigned char *p, double x) {
+    uint64_t u;
+    memcpy(&u, &x, sizeof(u));
+    pso_wire_put_u32(p, (uint32_t)u);
+    pso_wire_put_u32(p + 4, (uint32_t)(u >> 32));
+}
+
+static inline double pso_wire_get_f64(const unsigned char *p) {
+    uint64_t u = (uint64_t)pso_wire_get_u32(p) |
+                 (uint64_t)pso_wire_get_u32(p + 4) << 32;
+    double x;
+    memcpy(&x, &u, sizeof(x));
+    return x;
+}
+
+static inline void pso_wire_put_hdr(unsigned char *p, uint32_t type,
+                                    uint32_t id, uint32_t n, uint32_t dim)
+{
+    pso_wire_put_u32(p, PSO_WIRE_MAGIC);
+    pso_wire_put_u32(p + 4, type);
+    pso_wire_put_u32(p + 8, id);
+    pso_wire_put_u32(p + 12, n);
+    pso_wire_put_u32(p + 16, dim);
+}
+
+// Retorna 0 se o magic confere
+static inline int pso_wire_get_hdr(const unsigned char *p, pso_wire_hdr_t *h) {
+    if (pso_wire_get_u32(p) != PSO_WIRE_MAGIC) return -1;
+    h->type = pso_wire_get_u32(p + 4);
+    h->id   = pso_wire_get_u32(p + 8);
+    h->n    = pso_wire_get_u32(p + 12);
+    h->dim  = pso_wire_get_u32(p + 16);
+    return 0;
+}
+
+// Lê/escreve exatamente len bytes (0 = ok, -1 = erro ou fim da conexão)
+static inline int pso_wire_read_all(int fd, void *buf, size_t len) {
+    unsigned char *p = (unsigned char *)buf;
+    while (len > 0) {
+        ssize_t k = read(fd, p, len);
+        if (k < 0 && errno == EINTR) continue;
+        if (k <= 0) return -1;
+        p += k;
+        len -= (size_t)k;
+    }
+    return 0;
+}
+
+// (em sockets usa MSG_NOSIGNAL: par desconectado vira erro, não SIGPIPE)
+static inline int pso_wire_write_all(int fd, const void *buf, size_t len) {
+    const unsigned char *p = (const unsigned char *)buf;
+    while (len > 0) {
+        ssize_t k = send(fd, p, len, MSG_NOSIGNAL);
+        if (k < 0 && errno == ENOTSOCK) k = write(fd, p, len);
+        if (k < 0 && errno == EINTR) continue;
+        if (k <= 0) return -1;
+        p += k;
+        len -= (size_t)k;
+    }
+    return 0;
+}
+
+#endif // PSO_WIRE_H_
@@ -0,0 +1,409 @@
+/* Worker de avaliação remota (protocolo de pso_wire.h)
+
+   Escuta em TCP, recebe lotes de posições de um ou mais solvers
+   (pso_remote.h), avalia e devolve o fitness. Cada conexão tem uma
+   thread leitora (responde PING na hora, mesmo no meio de um lote) e uma
+   thread de cálculo (avalia os lotes na ordem de chegada).
+
+   uso: pso_worker [-b endereço] [-p porta] [--allow-plugin DIR]
+                   [--delay-ms N] [--fail-after N]
+        pso_worker --stdio OBJETIVO
+
+   --stdio OBJETIVO  atende uma única conexão em stdin/stdout, com o
+                     objetivo já escolhido ("fun:NOME" ou "plugin:ARQ"),
+                     sem HELLO (processo filho de pso_subproc.h)
+   --allow-plugin DIR  aceita "plugin:ARQ" no HELLO só para arquivos
+                     dentro de DIR. Sem essa opção, conexões TCP só
+                     podem pedir fun:NOME: o HELLO não é autenticado e
+                     carregar um .so escolhido pelo par é executar
+                     código dele
+   --delay-ms N    espera N ms extras por lote (simula um modelo lento)
+   --fail-after N  encerra o processo após N lotes (teste de falha)
+*/
+
+#include <stdio.h>
+#include <stdlib.h>     // realpath()
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <signal.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#include "pso.h"
+#include "pso_funcs.h"
+#include "pso_plugin.h"
+#include "pso_wire.h"
+
+
+static int delay_ms = 0;
+static char *plugin_dir = NULL;   // --allow-plugin (caminho canônico)
+static long fail_after = 0;
+static long batches_done = 0;
+static pthread_mutex_t count_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Lote recebido, esperando a thread de cálculo
+typedef struct eval_msg {
+    uint32_t id, n, dim;
+    unsigned char *body;      // n*dim doubles (little-endian)
+    struct eval_msg *next;
+} eval_msg_t;
+
+typedef struct {
+    int fd;                   // leitura
+    int wfd;                  // escrita (= fd no TCP; stdout no --stdio)
+    pthread_mutex_t write_lock;
+    int ready;                // objetivo escolhido (HELLO aceito)
+    uint32_t dim;             // dimensão do HELLO (0 = qualquer, --stdio)
+
+    // objetivo escolhido no HELLO
+    pso_obj_fun_t fun;
+    pso_plugin_t *plugin;
+
+    // fila de lotes (leitora -> cálculo)
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    eval_msg_t *head, *tail;
+    int closing;
+} conn_t;
+
+
+static int send_msg(conn_t *c, uint32_t type, uint32_t id, uint32_t n,
+                    uint32_t dim, const void *body, size_t len)
+{
+    unsigned char hdr[PSO_WIRE_HDR];
+    int rc;
+
+    pso_wire_put_hdr(hdr, type, id, n, dim);
+    pthread_mutex_lock(&c->write_lock);
+    rc = pso_wire_write_all(c->wfd, hdr, sizeof(hdr));
+    if (rc == 0 && len > 0) rc = pso_wire_write_all(c->wfd, body, len);
+    pthread_mutex_unlock(&c->write_lock);
+    return rc;
+}
+
+static void send_error(conn_t *c, uint32_t id, const char *msg) {
+    send_msg(c, PSO_MSG_ERROR, id, (uint32_t)strlen(msg), 0, msg, strlen(msg));
+}
+
+// 1 se path (já canônico) está dentro de plugin_dir
+static int plugin_allowed(const char *path) {
+    size_t len = strlen(plugin_dir);
+    if (strncmp(path, plugin_dir, len) != 0) return 0;
+    return plugin_dir[len-1] == '/' || path[len] == '/';
+}
+
+// "fun:NOME" ou "plugin:ARQ.so[:ARGS]". remote = veio do HELLO: plugins
+// só de --allow-plugin
+static const char *choose_objective(conn_t *c, char *spec, int remote,
+                                    char *err, int errlen)
+{
+    if (strncmp(spec, "fun:", 4) == 0) {
+        const pso_func_info_t *info = pso_funcs_find(spec + 4);
+        if (info == NULL) return "funcao desconhecida";
+        c->fun = info->fun;
+        return NULL;
+    }
+    if (strncmp(spec, "plugin:", 7) == 0) {
+        char *path = spec + 7;
+        char *args = strchr(path, ':');
+        if (args != NULL) *args++ = '\0';
+        if (!remote) {
+            c->plugin = pso_plugin_load(path, args, err, errlen);
+            return c->plugin ? NULL : err;
+        }
+        if (plugin_dir == NULL) return "plugins desabilitados (pso_worker --allow-plugin DIR)";
+
+        // carrega o caminho resolvido (sem "..", sem links para fora)
+        char *real = realpath(path, NULL);
+        if (real == NULL || !plugin_allowed(real)) {
+            free(real);
+            return "plugin fora do diretorio permitido";
+        }
+        c->plugin = pso_plugin_load(real, args, err, errlen);
+        free(real);
+        return c->plugin ? NULL : err;
+    }
+    return "objetivo invalido (use fun:NOME ou plugin:ARQ)";
+}
+
+
+// ============================
+//      THREAD DE CÁLCULO
+// ============================
+
+static void *compute_main(void *p) {
+    conn_t *c = (conn_t *)p;
+    double *x = NULL, *fit = NULL;
+    double **xp = NULL;
+    size_t cap = 0, capn = 0;
+
+    for (;;) {
+        pthread_mutex_lock(&c->lock);
+        while (c->head == NULL && !c->closing)
+            pthread_cond_wait(&c->cond, &c->lock);
+        eval_msg_t *m = c->head;
+        if (m != NULL) {
+            c->head = m->next;
+            if (c->head == NULL) c->tail = NULL;
+        }
+        pthread_mutex_unlock(&c->lock);
+        if (m == NULL) break;
+
+        // decodifica (buffers reaproveitados entre lotes)
+        size_t total = (size_t)m->n * m->dim;
+        if (total > cap) {
+            free(x);
+            x = (double *)malloc(total * sizeof(double));
+            cap = x ? total : 0;
+        }
+        if (m->n > capn) {
+            free(fit); free(xp);
+            fit = (double *)malloc(m->n * sizeof(double));
+            xp = (double **)malloc(m->n * sizeof(double *));
+            capn = (fit && xp) ? m->n : 0;
+        }
+        if (x == NULL || fit == NULL || xp == NULL) {
+            send_error(c, m->id, "sem memoria para o lote");
+            free(m->body);
+            free(m);
+            continue;
+        }
+        for (size_t k=0; k<total; k++)
+            x[k] = pso_wire_get_f64(m->body + 8 * k);
+        for (uint32_t i=0; i<m->n; i++)
+            xp[i] = x + (size_t)i * m->dim;
+
+        if (c->plugin != NULL) {
+            pso_plugin_batch(xp, (int)m->dim, (int)m->n, fit, c->plugin);
+        } else {
+            for (uint32_t i=0; i<m->n; i++)
+                fit[i] = c->fun(xp[i], (int)m->dim, NULL);
+        }
+        if (delay_ms > 0) {
+            struct timespec ts = { delay_ms / 1000, (delay_ms % 1000) * 1000000L };
+            nanosleep(&ts, NULL);
+        }
+
+        // resposta: reaproveita o corpo do pedido (n*dim >= n doubles)
+        for (uint32_t i=0; i<m->n; i++)
+            pso_wire_put_f64(m->body + 8 * i, fit[i]);
+        send_msg(c, PSO_MSG_RESULT, m->id, m->n, 0, m->body, 8 * (size_t)m->n);
+        free(m->body);
+        free(m);
+
+        if (fail_after > 0) {
+            pthread_mutex_lock(&count_lock);
+            long done = ++batches_done;
+            pthread_mutex_unlock(&count_lock);
+            if (done >= fail_after) {
+                fprintf(stderr, "pso_worker: --fail-after %ld atingido, saindo\n", fail_after);
+                _exit(3);
+            }
+        }
+    }
+    free(x); free(fit); free(xp);
+    return NULL;
+}
+
+
+// ============================
+//      THREAD LEITORA
+// ============================
+
+static void *conn_main(void *p) {
+    conn_t *c = (conn_t *)p;
+    unsigned char hdr[PSO_WIRE_HDR];
+    pso_wire_hdr_t h;
+    pthread_t compute;
+    int ready = c->ready;
+    char err[256];
+
+    pthread_create(&compute, NULL, compute_main, c);
+
+    while (pso_wire_read_all(c->fd, hdr, sizeof(hdr)) == 0) {
+        if (pso_wire_get_hdr(hdr, &h) != 0) {
+            send_error(c, 0, "magic invalido");
+            break;
+        }
+
+        if (h.type == PSO_MSG_PING) {
+            send_msg(c, PSO_MSG_PONG, h.id, 0, 0, NULL, 0);
+
+        } else if (h.type == PSO_MSG_HELLO) {
+            if (h.n > PSO_WIRE_MAX_TEXT || h.dim == 0) {
+                send_error(c, h.id, h.dim ? "HELLO longo demais" : "HELLO sem dimensao");
+                break;
+            }
+            char *spec = (char *)malloc(h.n + 1);
+            if (spec == NULL || pso_wire_read_all(c->fd, spec, h.n) != 0) {
+                free(spec);
+                break;
+            }
+            spec[h.n] = '\0';
+            const char *msg = ready ? "HELLO repetido" : choose_objective(c, spec, 1, err, sizeof(err));
+            free(spec);
+            if (msg != NULL) {
+                send_error(c, h.id, msg);
+                break;
+            }
+            ready = 1;
+            c->dim = h.dim;
+            send_msg(c, PSO_MSG_HELLO_OK, h.id, 0, 0, NULL, 0);
+
+        } else if (h.type == PSO_MSG_EVAL) {
+            // confere o cabeçalho antes de ler o corpo: o tamanho vem do
+            // par e um lote absurdo derrubaria o processo (e as conexões
+            // dos outros solvers)
+            const char *msg = NULL;
+            if (!ready)
+                msg = "EVAL antes do HELLO";
+            else if (h.dim == 0 || (c->dim != 0 && h.dim != c->dim))
+                msg = "EVAL com dimensao diferente da do HELLO";
+            else if (h.n > PSO_WIRE_MAX_DOUBLES / h.dim)
+                msg = "lote grande demais";
+            if (msg != NULL) {
+                send_error(c, h.id, msg);
+                break;
+            }
+
+            size_t len = 8 * (size_t)h.n * h.dim;
+            eval_msg_t *m = (eval_msg_t *)malloc(sizeof(eval_msg_t));
+            if (m == NULL || (m->body = (unsigned char *)malloc(len ? len : 1)) == NULL) {
+                send_error(c, h.id, "sem memoria para o lote");
+                free(m);
+                break;
+            }
+            if (pso_wire_read_all(c->fd, m->body, len) != 0) {
+                free(m->body); free(m);
+                break;
+            }
+            m->id = h.id; m->n = h.n; m->dim = h.dim; m->next = NULL;
+
+            pthread_mutex_lock(&c->lock);
+            if (c->tail) c->tail->next = m;
+            else c->head = m;
+            c->tail = m;
+            pthread_cond_signal(&c->cond);
+            pthread_mutex_unlock(&c->lock);
+
+        } else {
+            send_error(c, h.id, "tipo de mensagem desconhecido");
+            break;
+        }
+    }
+
+    // encerra: a thread de cálculo termina os lotes já recebidos
+    pthread_mutex_lock(&c->lock);
+    c->closing = 1;
+    pthread_cond_signal(&c->cond);
+    pthread_mutex_unlock(&c->lock);
+    pthread_join(compute, NULL);
+
+    close(c->fd);
+    if (c->wfd != c->fd) close(c->wfd);
+    if (c->plugin) pso_plugin_unload(c->plugin);
+    pthread_mutex_destroy(&c->lock);
+    pthread_cond_destroy(&c->cond);
+    pthread_mutex_destroy(&c->write_lock);
+    free(c);
+    return NULL;
+}
+
+
+// ============================
+//            MAIN
+// ============================
+
+int main(int argc, char **argv) {
+    const char *bind_addr = "127.0.0.1";
+    int port = 7700;
+    char *stdio_spec = NULL;
+
+    for (int k=1; k<argc; k++) {
+        if (strcmp(argv[k], "-b") == 0 && k + 1 < argc) {
+            bind_addr = argv[++k];
+        } else if (strcmp(argv[k], "-p") == 0 && k + 1 < argc) {
+            port = atoi(argv[++k]);
+        } else if (strcmp(argv[k], "--delay-ms") == 0 && k + 1 < argc) {
+            delay_ms = atoi(argv[++k]);
+        } else if (strcmp(argv[k], "--fail-after") == 0 && k + 1 < argc) {
+            fail_after = atol(argv[++k]);
+        } else if (strcmp(argv[k], "--stdio") == 0 && k + 1 < argc) {
+            stdio_spec = argv[++k];
+        } else if (strcmp(argv[k], "--allow-plugin") == 0 && k + 1 < argc) {
+            plugin_dir = realpath(argv[++k], NULL);
+            if (plugin_dir == NULL) {
+                perror(argv[k]);
+                return 1;
+            }
+        } else {
+            fprintf(stderr,
+                    "uso: %s [-b endereco] [-p porta] [--allow-plugin DIR]\n"
+                    "        [--delay-ms N] [--fail-after N]\n"
+                    "     %s --stdio OBJETIVO\n",
+                    argv[0], argv[0]);
+            return 1;
+        }
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    if (stdio_spec != NULL) {
+        char err[256];
+        conn_t *c = (conn_t *)calloc(1, sizeof(conn_t));
+        c->fd = 0;
+        c->wfd = 1;
+        pthread_mutex_init(&c->write_lock, NULL);
+        pthread_mutex_init(&c->lock, NULL);
+        pthread_cond_init(&c->cond, NULL);
+        const char *msg = choose_objective(c, stdio_spec, 0, err, sizeof(err));
+        if (msg != NULL) {
+            fprintf(stderr, "pso_worker: %s\n", msg);
+            return 1;
+        }
+        c->ready = 1;
+        conn_main(c);
+        return 0;
+    }
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+    if (inet_pton(AF_INET, bind_addr, &addr.sin_addr) != 1) {
+        fprintf(stderr, "endereco invalido: %s\n", bind_addr);
+        return 1;
+    }
+
+    int lfd = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(lfd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (bind(lfd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(lfd, 64) != 0) {
+        perror("bind/listen");
+        return 1;
+    }
+    fprintf(stderr, "pso_worker: %s:%d\n", bind_addr, port);
+
+    for (;;) {
+        int fd = accept(lfd, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            perror("accept");
+            return 1;
+        }
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        conn_t *c = (conn_t *)calloc(1, sizeof(conn_t));
+        c->fd = fd;
+        c->wfd = fd;
+        pthread_mutex_init(&c->write_lock, NULL);
+        pthread_mutex_init(&c->lock, NULL);
+        pthread_cond_init(&c->cond, NULL);
+
+        pthread_t th;
+        pthread_create(&th, NULL, conn_main, c);
+        pthread_detach(th);
+    }
+}